@@ -2,9 +2,19 @@
 #include "../include/interrupt.h"
 #include "../include/kernel.h"
 
-/* グローバルキーボード状態 */
+/* グローバルキーボード状態 (修飾キーのみ) */
 static keyboard_state_t kb_state;
 
+/* キーイベントリング (SPSC: IRQ1ハンドラが生産、読み手が消費)
+ * write_posはハンドラのみ、read_posは読み手のみが更新するため
+ * ロックなしで安全。満杯時は新しいイベントを捨てる */
+static key_event_t key_ring[KEY_EVENT_RING_SIZE];
+static volatile u32 key_ring_write = 0;
+static volatile u32 key_ring_read = 0;
+
+/* 入力待ちプロセス用ウェイトキュー (入力到着時に先頭を起床させる) */
+static wait_queue_t keyboard_waiters;
+
 /* 米国キーボードレイアウト（スキャンコード→ASCII） */
 const char keyboard_map[] = {
     0,    27,  '1', '2', '3', '4', '5', '6', '7', '8', '9', '0', '-', '=', '\b',
@@ -31,6 +41,9 @@ void keyboard_init(void) {
     /* キーボード状態を初期化 */
     kernel_printf("keyboard_init: Clearing keyboard state...\n");
     memset(&kb_state, 0, sizeof(keyboard_state_t));
+    key_ring_read = 0;
+    key_ring_write = 0;
+    wait_queue_init(&keyboard_waiters);
     kernel_printf("keyboard_init: Keyboard state cleared\n");
 
     /* キーボード割り込み（IRQ1）を有効化 */
@@ -97,31 +110,76 @@ void keyboard_handler(interrupt_frame_t* frame) {
         }
     }
 
-    /* 有効な文字の場合はバッファに追加 */
-    if (ascii != 0 && kb_state.count < KEYBOARD_BUFFER_SIZE) {
-        kb_state.buffer[kb_state.write_pos] = ascii;
-        kb_state.write_pos = (kb_state.write_pos + 1) % KEYBOARD_BUFFER_SIZE;
-        kb_state.count++;
+    /* キーイベントをリングに追加 (満杯なら捨てる) */
+    if (key_ring_write - key_ring_read < KEY_EVENT_RING_SIZE) {
+        key_event_t* event = &key_ring[key_ring_write % KEY_EVENT_RING_SIZE];
+        event->scancode = scancode;
+        event->ascii = ascii;
+        event->shift = kb_state.shift_pressed;
+        event->ctrl = kb_state.ctrl_pressed;
+        event->alt = kb_state.alt_pressed;
+        key_ring_write++;   /* データ書き込み後にインデックスを公開 */
+
+        if (ascii != 0) {
+            kernel_printf("🎯 CHAR ADDED: '%c' (0x%02X from scancode 0x%02X)\n",
+                         ascii, ascii, scancode);
+        }
 
-        kernel_printf("🎯 CHAR ADDED: '%c' (0x%02X from scancode 0x%02X)\n",
-                     ascii, ascii, scancode);
+        /* 入力待ちでブロックしているプロセスを起床させる */
+        wait_queue_wake_one(&keyboard_waiters);
     } else {
-        kernel_printf("🔄 SCAN: 0x%02X (no char)\n", scancode);
+        kernel_printf("🔄 SCAN: 0x%02X (ring full, dropped)\n", scancode);
     }
 
     UNUSED(frame);
 }
 
-char keyboard_get_char(void) {
-    if (kb_state.count == 0) {
-        return 0;
+/* キーイベントを1つ取り出す (ノンブロッキング、無ければfalse) */
+bool keyboard_read_event(key_event_t* event) {
+    if (event == NULL || key_ring_read == key_ring_write) {
+        return false;
+    }
+
+    *event = key_ring[key_ring_read % KEY_EVENT_RING_SIZE];
+    key_ring_read++;
+    return true;
+}
+
+/* 入力が到着するまで待機して1文字返す。
+ * プロセス文脈ではウェイトキューで待機し、IRQ1ハンドラに起床させて
+ * もらう。プロセス文脈外 (起動中など) はhltで割り込みを待つ */
+char keyboard_read_blocking(void) {
+    key_event_t event;
+
+    for (;;) {
+        if (keyboard_read_event(&event)) {
+            /* 文字に対応しないイベント (修飾キー等) は読み飛ばす */
+            if (event.ascii != 0) {
+                return event.ascii;
+            }
+            continue;
+        }
+
+        process_t* proc = process_get_current();
+        if (proc != NULL) {
+            wait_queue_block(&keyboard_waiters, proc);
+            scheduler_switch_process();
+        } else {
+            asm volatile("hlt");
+        }
     }
+}
 
-    char c = kb_state.buffer[kb_state.read_pos];
-    kb_state.read_pos = (kb_state.read_pos + 1) % KEYBOARD_BUFFER_SIZE;
-    kb_state.count--;
+char keyboard_get_char(void) {
+    key_event_t event;
 
-    return c;
+    /* 文字を持つイベントが見つかるまでリングを読み進める */
+    while (keyboard_read_event(&event)) {
+        if (event.ascii != 0) {
+            return event.ascii;
+        }
+    }
+    return 0;
 }
 
 /* エイリアス関数 */
@@ -130,13 +188,19 @@ int keyboard_getchar(void) {
 }
 
 bool keyboard_has_input(void) {
-    return kb_state.count > 0;
+    return key_ring_read != key_ring_write;
+}
+
+/* 入力待ち用ウェイトキューを返す (wait_queue_block で待機に入る) */
+wait_queue_t* keyboard_get_wait_queue(void) {
+    return &keyboard_waiters;
 }
 
 void keyboard_print_status(void) {
     kernel_printf("\n--- Keyboard Status ---\n");
-    kernel_printf("Buffer count: %u/%u\n", kb_state.count, KEYBOARD_BUFFER_SIZE);
-    kernel_printf("Read pos: %u, Write pos: %u\n", kb_state.read_pos, kb_state.write_pos);
+    kernel_printf("Event ring: %u/%u pending\n",
+                  key_ring_write - key_ring_read, (u32)KEY_EVENT_RING_SIZE);
+    kernel_printf("Read pos: %u, Write pos: %u\n", key_ring_read, key_ring_write);
     kernel_printf("Shift: %s, Ctrl: %s, Alt: %s\n",
                   kb_state.shift_pressed ? "ON" : "OFF",
                   kb_state.ctrl_pressed ? "ON" : "OFF",
@@ -1,7 +1,9 @@
 #include "kernel.h"
+#include "interrupt.h"
 
 /* Serial port registers */
 #define SERIAL_DATA_PORT(base)          (base)
+#define SERIAL_INT_ENABLE_PORT(base)    (base + 1)
 #define SERIAL_FIFO_COMMAND_PORT(base)  (base + 2)
 #define SERIAL_LINE_COMMAND_PORT(base)  (base + 3)
 #define SERIAL_MODEM_COMMAND_PORT(base) (base + 4)
@@ -9,6 +11,36 @@
 
 /* Line status register bits */
 #define SERIAL_LINE_ENABLE_DLAB         0x80
+#define SERIAL_LSR_THR_EMPTY            0x20
+
+/* Interrupt enable register bits */
+#define SERIAL_IER_THR_EMPTY            0x02
+
+/* TX ring buffer, drained by the COM1 IRQ (IRQ4). Writers enqueue and
+ * continue instead of busy-waiting on the line status register for every
+ * byte; the interrupt handler refills the 16-byte UART FIFO as it drains.
+ * Until serial_enable_tx_irq() runs (early boot, before the IDT is up)
+ * output falls back to the old polled path. */
+#define SERIAL_TX_RING_SIZE             1024
+#define SERIAL_TX_FIFO_DEPTH            16
+
+static u8 tx_ring[SERIAL_TX_RING_SIZE];
+static volatile u32 tx_read = 0;    /* Consumed only by the IRQ handler */
+static volatile u32 tx_write = 0;   /* Advanced only by serial_putchar */
+static bool tx_irq_mode = false;
+
+/* Save/restore IF around the producer's critical section: the enqueue
+ * (and its full-ring fallback) must not be interleaved with the IRQ
+ * handler draining the ring */
+static inline u32 serial_irq_save(void) {
+    u32 flags;
+    asm volatile("pushf; pop %0; cli" : "=r"(flags) : : "memory");
+    return flags;
+}
+
+static inline void serial_irq_restore(u32 flags) {
+    asm volatile("push %0; popf" : : "r"(flags) : "memory", "cc");
+}
 
 void serial_init(void) {
     /* Disable all interrupts */
@@ -48,14 +80,90 @@ void serial_init(void) {
 
 static int serial_is_transmit_fifo_empty(void) {
     /* 0x20 = transmitter holding register empty */
-    return inb(SERIAL_LINE_STATUS_PORT(SERIAL_COM1_BASE)) & 0x20;
+    return inb(SERIAL_LINE_STATUS_PORT(SERIAL_COM1_BASE)) & SERIAL_LSR_THR_EMPTY;
 }
 
-void serial_putchar(char c) {
+/* Polled transmit: the pre-IRQ path and the full-ring fallback */
+static void serial_poll_putchar(char c) {
     while (serial_is_transmit_fifo_empty() == 0);
     outb(SERIAL_DATA_PORT(SERIAL_COM1_BASE), c);
 }
 
+/* Refill the UART FIFO from the ring. When the ring drains, the THR-empty
+ * interrupt is switched off so an idle port raises no interrupts at all. */
+static void serial_tx_fill_fifo(void) {
+    u32 burst = 0;
+
+    while (tx_read != tx_write && burst < SERIAL_TX_FIFO_DEPTH) {
+        outb(SERIAL_DATA_PORT(SERIAL_COM1_BASE),
+             tx_ring[tx_read % SERIAL_TX_RING_SIZE]);
+        tx_read++;
+        burst++;
+    }
+
+    if (tx_read == tx_write) {
+        u8 ier = inb(SERIAL_INT_ENABLE_PORT(SERIAL_COM1_BASE));
+        outb(SERIAL_INT_ENABLE_PORT(SERIAL_COM1_BASE),
+             ier & ~SERIAL_IER_THR_EMPTY);
+    }
+}
+
+/* COM1 interrupt handler (IRQ4): transmitter went idle, refill it */
+void serial_tx_irq_handler(interrupt_frame_t* frame) {
+    UNUSED(frame);
+
+    if (serial_is_transmit_fifo_empty()) {
+        serial_tx_fill_fifo();
+    }
+}
+
+/* Switch to interrupt-driven transmit. Called once the IDT and PIC are up;
+ * registers the IRQ4 handler the same way the keyboard driver does. */
+void serial_enable_tx_irq(void) {
+    extern void register_interrupt_handler(u8 n, interrupt_handler_t handler);
+    extern void pic_clear_mask(u8 irq);
+
+    register_interrupt_handler(36, serial_tx_irq_handler);
+    pic_clear_mask(4);
+    tx_irq_mode = true;
+
+    kernel_printf("serial_enable_tx_irq: COM1 TX now interrupt-driven\n");
+}
+
+void serial_putchar(char c) {
+    if (!tx_irq_mode) {
+        serial_poll_putchar(c);
+        return;
+    }
+
+    /* The whole enqueue runs with interrupts off: if the IRQ handler fires
+     * between the slot store and the tx_write bump it would see a stale
+     * index and either skip the byte or transmit the old slot contents.
+     * The IER read-modify-write races with the handler's disable path for
+     * the same reason. */
+    u32 flags = serial_irq_save();
+
+    /* Ring full: drain a FIFO's worth synchronously rather than dropping
+     * output or spinning with interrupts possibly disabled */
+    if (tx_write - tx_read >= SERIAL_TX_RING_SIZE) {
+        while (serial_is_transmit_fifo_empty() == 0);
+        serial_tx_fill_fifo();
+    }
+
+    tx_ring[tx_write % SERIAL_TX_RING_SIZE] = (u8)c;
+    tx_write++;
+
+    /* Kickstart: enable the THR-empty interrupt; if the transmitter is
+     * already idle the UART raises it immediately */
+    u8 ier = inb(SERIAL_INT_ENABLE_PORT(SERIAL_COM1_BASE));
+    if (!(ier & SERIAL_IER_THR_EMPTY)) {
+        outb(SERIAL_INT_ENABLE_PORT(SERIAL_COM1_BASE),
+             ier | SERIAL_IER_THR_EMPTY);
+    }
+
+    serial_irq_restore(flags);
+}
+
 void serial_write(const char* str) {
     if (!str) return;
 
@@ -1,10 +1,57 @@
 #include "../include/kernel.h"
 
 /* VGA text mode driver */
+
+/* CRTC registers (hardware scrolling via the display start address) */
+#define VGA_CRTC_INDEX      0x3D4
+#define VGA_CRTC_DATA       0x3D5
+#define VGA_CRTC_START_HI   0x0C
+#define VGA_CRTC_START_LO   0x0D
+
+/* Scroll region: 200 rows (32000 bytes) of the 32KB text-mode window.
+ * Scrolling normally just advances the CRTC start address by one row;
+ * the full-screen copy only happens when the region wraps, so the cost
+ * of sustained logging is one row write per line instead of 4KB of
+ * MMIO traffic per line. */
+#define VGA_SCROLL_ROWS     200
+#define VGA_SCROLL_CELLS    (VGA_SCROLL_ROWS * VGA_WIDTH)
+
 static u16* vga_buffer = (u16*)VGA_MEMORY;
 static u8 vga_color = 0x07; /* White text on black background */
 static u8 vga_x = 0;
 static u8 vga_y = 0;
+static u32 vga_start = 0;   /* Cell index of the visible screen's first row */
+
+/* System-RAM shadow of the scroll region. All drawing goes here first;
+ * vga_flush() copies only the dirty cell span to the MMIO buffer, so a
+ * whole string costs one batched MMIO write instead of one store per
+ * character (MMIO stores are roughly 10x the cost of RAM stores). */
+static u16 vga_shadow[VGA_SCROLL_CELLS];
+static u32 vga_dirty_min = 1;   /* First dirty cell (min > max = clean) */
+static u32 vga_dirty_max = 0;   /* Last dirty cell */
+
+/* Mark a cell range [first, last] as needing a flush */
+static void vga_mark_dirty(u32 first, u32 last) {
+    if (vga_dirty_min > vga_dirty_max) {
+        vga_dirty_min = first;
+        vga_dirty_max = last;
+    } else {
+        if (first < vga_dirty_min) vga_dirty_min = first;
+        if (last > vga_dirty_max) vga_dirty_max = last;
+    }
+}
+
+/* Copy the dirty span of the shadow buffer to VGA memory */
+void vga_flush(void) {
+    if (vga_dirty_min > vga_dirty_max) return;
+
+    for (u32 i = vga_dirty_min; i <= vga_dirty_max; i++) {
+        vga_buffer[i] = vga_shadow[i];
+    }
+
+    vga_dirty_min = 1;
+    vga_dirty_max = 0;
+}
 
 /* VGA color constants */
 enum vga_color {
@@ -41,15 +88,28 @@ void vga_init(void) {
     vga_clear();
 }
 
+/* Program the CRTC display start address (in character cells) */
+static void vga_set_start(u32 cell) {
+    outb(VGA_CRTC_INDEX, VGA_CRTC_START_HI);
+    outb(VGA_CRTC_DATA, (cell >> 8) & 0xFF);
+    outb(VGA_CRTC_INDEX, VGA_CRTC_START_LO);
+    outb(VGA_CRTC_DATA, cell & 0xFF);
+}
+
 void vga_clear(void) {
+    vga_start = 0;
+    vga_set_start(vga_start);
+
     for (u8 y = 0; y < VGA_HEIGHT; y++) {
         for (u8 x = 0; x < VGA_WIDTH; x++) {
             const u32 index = y * VGA_WIDTH + x;
-            vga_buffer[index] = vga_entry(' ', vga_color);
+            vga_shadow[index] = vga_entry(' ', vga_color);
         }
     }
+    vga_mark_dirty(0, VGA_HEIGHT * VGA_WIDTH - 1);
     vga_x = 0;
     vga_y = 0;
+    vga_flush();
 }
 
 void vga_set_color(u8 foreground, u8 background) {
@@ -57,22 +117,36 @@ void vga_set_color(u8 foreground, u8 background) {
 }
 
 static void vga_scroll(void) {
-    /* Move all lines up by one */
-    for (u8 y = 1; y < VGA_HEIGHT; y++) {
-        for (u8 x = 0; x < VGA_WIDTH; x++) {
-            vga_buffer[(y - 1) * VGA_WIDTH + x] = vga_buffer[y * VGA_WIDTH + x];
+    if (vga_start + VGA_WIDTH + VGA_HEIGHT * VGA_WIDTH > VGA_SCROLL_CELLS) {
+        /* Region exhausted: copy the visible screen (minus its top row)
+         * back to the start of the region. The copy is shadow-to-shadow
+         * (RAM); the MMIO cost is paid once in the next flush. */
+        for (u8 y = 1; y < VGA_HEIGHT; y++) {
+            for (u8 x = 0; x < VGA_WIDTH; x++) {
+                vga_shadow[(y - 1) * VGA_WIDTH + x] =
+                    vga_shadow[vga_start + y * VGA_WIDTH + x];
+            }
         }
+        vga_start = 0;
+        vga_mark_dirty(0, VGA_HEIGHT * VGA_WIDTH - 1);
+    } else {
+        /* Common case: slide the hardware window down one row */
+        vga_start += VGA_WIDTH;
     }
 
-    /* Clear the last line */
+    /* Clear the new bottom line */
+    const u32 bottom = vga_start + (VGA_HEIGHT - 1) * VGA_WIDTH;
     for (u8 x = 0; x < VGA_WIDTH; x++) {
-        vga_buffer[(VGA_HEIGHT - 1) * VGA_WIDTH + x] = vga_entry(' ', vga_color);
+        vga_shadow[bottom + x] = vga_entry(' ', vga_color);
     }
+    vga_mark_dirty(bottom, bottom + VGA_WIDTH - 1);
 
+    vga_set_start(vga_start);
     vga_y = VGA_HEIGHT - 1;
 }
 
-void vga_putchar(char c) {
+/* Draw one character into the shadow buffer (no flush) */
+static void vga_putchar_shadow(char c) {
     if (c == '\n') {
         vga_x = 0;
         vga_y++;
@@ -85,8 +159,9 @@ void vga_putchar(char c) {
             vga_x--;
         }
     } else {
-        const u32 index = vga_y * VGA_WIDTH + vga_x;
-        vga_buffer[index] = vga_entry(c, vga_color);
+        const u32 index = vga_start + vga_y * VGA_WIDTH + vga_x;
+        vga_shadow[index] = vga_entry(c, vga_color);
+        vga_mark_dirty(index, index);
         vga_x++;
     }
 
@@ -100,11 +175,25 @@ void vga_putchar(char c) {
     }
 }
 
-void vga_write(const char* str) {
-    while (*str) {
-        vga_putchar(*str);
-        str++;
+void vga_putchar(char c) {
+    vga_putchar_shadow(c);
+    vga_flush();
+}
+
+/* Bulk write: draw the whole buffer into the shadow, then flush the
+ * dirty span to VGA memory once */
+void vga_write_len(const char* buf, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        vga_putchar_shadow(buf[i]);
     }
+    vga_flush();
+}
+
+void vga_write(const char* str) {
+    const char* p = str;
+    size_t len = 0;
+    while (*p++) len++;
+    vga_write_len(str, len);
 }
 
 /* Combined VGA and serial output */
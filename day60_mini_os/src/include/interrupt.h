@@ -68,6 +68,13 @@ typedef struct {
 /* 割り込みハンドラの型定義 */
 typedef void (*interrupt_handler_t)(interrupt_frame_t* frame);
 
+/* ベクタごとの割り込み統計 (irqstatコマンドで表示) */
+typedef struct {
+    u32 count;          /* 発生回数 */
+    u64 cycles;         /* ハンドラ消費サイクル合計 (rdtsc) */
+    u32 max_cycles;     /* 1回あたりの最長処理サイクル */
+} irq_stats_t;
+
 /* PIC（Programmable Interrupt Controller）関連 */
 #define PIC1_COMMAND    0x20    /* マスターPIC コマンドポート */
 #define PIC1_DATA       0x21    /* マスターPIC データポート */
@@ -119,6 +126,12 @@ void register_interrupt_handler(u8 n, interrupt_handler_t handler);
 /* 割り込みハンドラ取得（テスト用） */
 interrupt_handler_t get_interrupt_handler(u8 n);
 
+/* 割り込み統計 */
+void irq_stats_record(u32 vector, u32 cycles);  /* 共通ハンドラ経路から呼ばれる */
+const irq_stats_t* irq_stats_get(u32 vector);
+void irq_stats_reset(void);
+void irq_stats_print(void);
+
 /* プロセス管理からの関数（前方宣言） */
 void scheduler_tick(void);
 
@@ -141,6 +154,7 @@ extern void isr16(void);  /* FPUエラー */
 
 extern void irq0(void);   /* タイマー */
 extern void irq1(void);   /* キーボード */
+extern void irq4(void);   /* シリアル (COM1) */
 
 extern void isr128(void); /* システムコール (int 0x80) */
 extern void isr_syscall(void); /* システムコール */
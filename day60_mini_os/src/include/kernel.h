@@ -41,6 +41,7 @@ typedef int64_t  s64;
 
 /* Serial I/O */
 void serial_init(void);
+void serial_enable_tx_irq(void);
 void serial_putchar(char c);
 void serial_write(const char* str);
 void serial_printf(const char* format, ...);
@@ -49,6 +50,8 @@ void serial_printf(const char* format, ...);
 void vga_init(void);
 void vga_putchar(char c);
 void vga_write(const char* str);
+void vga_write_len(const char* buf, size_t len);
+void vga_flush(void);
 void vga_clear(void);
 void vga_set_color(u8 foreground, u8 background);
 
@@ -78,6 +81,9 @@ void* memset(void* ptr, int value, size_t size);
 void* memcpy(void* dest, const void* src, size_t size);
 void int_to_string(u32 num, char* buffer);
 
+/* Microbenchmarks (bench shell command) */
+void bench_run_all(void);
+
 /* Kernel panic */
 void kernel_panic(const char* message) __attribute__((noreturn));
 
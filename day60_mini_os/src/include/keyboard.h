@@ -3,6 +3,7 @@
 
 #include "kernel.h"
 #include "interrupt.h"
+#include "process.h"
 
 /* キーボードポートとステータス */
 #define KEYBOARD_DATA_PORT    0x60
@@ -25,14 +26,20 @@
 #define KEY_SPACE      0x39
 #define KEY_CAPSLOCK   0x3A
 
-/* キーボード入力バッファ */
-#define KEYBOARD_BUFFER_SIZE 256
+/* キーイベントリング (IRQ1ハンドラが生産、読み手が消費するSPSCリング)
+ * サイズは2のべき乗であること */
+#define KEY_EVENT_RING_SIZE 128
+
+/* キーイベント (キー押下1回分) */
+typedef struct {
+    u8 scancode;            /* 生のスキャンコード */
+    char ascii;             /* 変換後の文字 (0 = 対応文字なし) */
+    bool shift;             /* イベント時点の修飾キー状態 */
+    bool ctrl;
+    bool alt;
+} key_event_t;
 
 typedef struct {
-    char buffer[KEYBOARD_BUFFER_SIZE];
-    u32 read_pos;
-    u32 write_pos;
-    u32 count;
     bool shift_pressed;
     bool ctrl_pressed;
     bool alt_pressed;
@@ -41,10 +48,13 @@ typedef struct {
 /* 関数プロトタイプ */
 void keyboard_init(void);
 void keyboard_handler(interrupt_frame_t* frame);
+bool keyboard_read_event(key_event_t* event);   /* ノンブロッキング */
+char keyboard_read_blocking(void);              /* 入力到着まで待機 */
 char keyboard_get_char(void);
 int keyboard_getchar(void);
 bool keyboard_has_input(void);
 void keyboard_print_status(void);
+wait_queue_t* keyboard_get_wait_queue(void);  /* 入力待ち用ウェイトキュー */
 
 /* キーマップ */
 extern const char keyboard_map[];
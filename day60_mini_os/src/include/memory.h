@@ -8,6 +8,9 @@
 #define PAGE_SHIFT      12
 #define PAGE_MASK       (PAGE_SIZE - 1)
 
+/* Buddy allocator: power-of-two block orders, 2^0 .. 2^10 pages (4KB-4MB) */
+#define BUDDY_MAX_ORDER 10
+
 /* Multiboot constants */
 #define MULTIBOOT_BOOTLOADER_MAGIC      0x2BADB002
 
@@ -75,6 +78,8 @@ struct memory_manager {
     struct page_frame *page_frames; /* Page frame database */
     u32 kernel_start;           /* Kernel start address */
     u32 kernel_end;             /* Kernel end address */
+    u32 buddy_head[BUDDY_MAX_ORDER + 1];  /* Per-order free lists (addr of first block, 0 = empty) */
+    u32 buddy_count[BUDDY_MAX_ORDER + 1]; /* Free blocks per order */
 };
 
 /* Page flags */
@@ -95,6 +100,10 @@ void free_page(u32 addr);
 u32 alloc_pages(u32 count);
 void free_pages(u32 addr, u32 count);
 
+/* Frame reference counting (copy-on-write sharing) */
+void frame_ref_inc(u32 addr);
+u32 frame_ref_count(u32 addr);
+
 /* Kernel memory allocator */
 void* kmalloc(size_t size);
 void kfree(void* ptr);
@@ -24,11 +24,26 @@
 #define PAGE_SIZE_4MB   0x080   /* 4MBページ（PSE使用時） */
 #define PAGE_GLOBAL     0x100   /* グローバルページ */
 
+/* 4MBページ定数（PSE） */
+#define LARGE_PAGE_SIZE     0x400000    /* 4MB */
+#define LARGE_PAGE_MASK     0xFFC00000
+#define LARGE_PAGE_OFFSET   0x003FFFFF
+
+/* CR4フラグ */
+#define CR4_PSE         0x010   /* Page Size Extension（4MBページ有効化） */
+
+/* availableビットのOS独自用途 */
+#define PAGE_AVAIL_COW  0x1     /* コピーオンライト対象（共有中・書き込みでコピー） */
+
 /* 仮想アドレス空間定義 */
 #define PAGING_KERNEL_VIRTUAL_BASE     0xC0000000  /* 3GB */
 #define USER_VIRTUAL_START      0x00400000  /* 4MB */
 #define USER_VIRTUAL_END        0xBFFFFFFF  /* ~3GB */
 
+/* プロセススタック用仮想領域（デマンドページング） */
+#define STACK_REGION_BASE       0x10000000  /* 256MB */
+#define STACK_REGION_END        0x20000000  /* 512MB */
+
 /* ページディレクトリエントリ構造体 */
 typedef struct {
     u32 present     : 1;   /* 存在フラグ */
@@ -88,11 +103,13 @@ void paging_disable(void);
 
 /* ページディレクトリ管理 */
 page_directory_t* paging_create_directory(void);
+page_directory_t* paging_clone_directory(page_directory_t* src);
 void paging_destroy_directory(page_directory_t* dir);
 void paging_switch_directory(page_directory_t* dir);
 
 /* ページマッピング */
 int paging_map_page(u32 virtual_addr, u32 physical_addr, u32 flags);
+int paging_map_large_page(u32 virtual_addr, u32 physical_addr, u32 flags);
 int paging_unmap_page(u32 virtual_addr);
 u32 paging_get_physical_addr(u32 virtual_addr);
 
@@ -104,6 +121,11 @@ void paging_map_kernel_space(void);
 int paging_map_user_page(page_directory_t* dir, u32 virtual_addr, u32 flags);
 int paging_unmap_user_page(page_directory_t* dir, u32 virtual_addr);
 
+/* プロセススタック管理（デマンドページング + ガードページ） */
+u32 paging_reserve_stack(u32 stack_size);
+void paging_release_stack(u32 stack_top, u32 stack_size);
+bool paging_is_enabled(void);
+
 /* ページフォルト処理 */
 void page_fault_handler(interrupt_frame_t* frame);
 
@@ -111,6 +133,7 @@ void page_fault_handler(interrupt_frame_t* frame);
 u32 paging_virtual_to_physical(u32 virtual_addr);
 int paging_is_page_present(u32 virtual_addr);
 void paging_print_info(void);
+void paging_cow_test(void);
 
 /* インラインヘルパー関数 */
 static inline u32 page_align_down(u32 addr) {
@@ -141,5 +164,7 @@ extern u32 read_cr0(void);
 extern u32 read_cr2(void);
 extern u32 read_cr3(void);
 extern void write_cr3(u32 value);
+extern u32 read_cr4(void);
+extern void write_cr4(u32 value);
 
 #endif /* PAGING_H */
\ No newline at end of file
@@ -2,12 +2,14 @@
 #define PROCESS_H
 
 #include "kernel.h"
+#include "timer.h"
 
 /* プロセス状態 */
 typedef enum {
     PROCESS_READY = 0,      /* 実行可能状態 */
     PROCESS_RUNNING,        /* 実行中 */
-    PROCESS_BLOCKED,        /* 待機状態 */
+    PROCESS_BLOCKED,        /* 待機状態 (ウェイトキューでイベント待ち) */
+    PROCESS_SLEEPING,       /* スリープ状態 (タイマーで起床待ち) */
     PROCESS_TERMINATED      /* 終了状態 */
 } process_state_t;
 
@@ -30,6 +32,28 @@ typedef enum {
     DAEMON_CUSTOM           /* カスタムデーモン */
 } daemon_type_t;
 
+/* ウェイトキュー (イベント待ちプロセスの双方向リスト)
+ * リンクはレディキューと共用する。プロセスはレディキューか
+ * ひとつのウェイトキューのどちらか一方にしか載らない */
+typedef struct wait_queue {
+    struct process* head;       /* 待機プロセスの先頭 */
+    struct process* tail;       /* 待機プロセスの末尾 */
+} wait_queue_t;
+
+/* メッセージキュー定数 */
+#define MSG_SIZE            64      /* 固定長メッセージサイズ (bytes) */
+#define MSG_RING_ENTRIES    16      /* 受信リングのエントリ数 */
+
+/* プロセス間メッセージキュー (受信側所有のリングバッファ)。
+ * 送信側はmsg_send()で受信者のリングへ直接コピーするため、
+ * 中間のカーネルバッファを経由しない (コピーは1回だけ) */
+typedef struct {
+    u8* ring;                   /* kmalloc確保のリング (MSG_RING_ENTRIES * MSG_SIZE) */
+    u32 read;                   /* 消費位置 (単調増加、indexは%で算出) */
+    u32 write;                  /* 格納位置 (単調増加) */
+    wait_queue_t readers;       /* 空のときmsg_recv()が待つキュー */
+} msg_queue_t;
+
 /* プロセス制御ブロック (PCB) */
 typedef struct process {
     u32 pid;                    /* プロセスID */
@@ -39,11 +63,20 @@ typedef struct process {
     cpu_context_t context;      /* CPUコンテキスト */
     u32 stack_top;              /* スタック最上位アドレス */
     u32 stack_size;             /* スタックサイズ */
+    bool stack_virtual;         /* デマンドページングされた仮想スタックか */
 
     u32 priority;               /* 優先度 (0=最高) */
     u32 time_slice;             /* タイムスライス (ms) */
     u32 remaining_time;         /* 残りタイムスライス */
 
+    /* CPU使用量統計 */
+    u32 cpu_ticks;              /* 実行中に消費したtick数 */
+    u64 cpu_tsc;                /* 実行中に消費したTSCサイクル数 */
+    u32 voluntary_switches;     /* 自発的なCPU放棄回数 */
+    u32 involuntary_switches;   /* タイムスライス切れによる切り替え回数 */
+    u32 last_scheduled;         /* 最後にスケジュールされた時刻 (ticks) */
+    u32 created_ticks;          /* プロセス作成時刻 (ticks) */
+
     /* ユーザーモード用フィールド */
     u32 user_stack_base;        /* ユーザースタックベース */
     u32 user_stack_size;        /* ユーザースタックサイズ */
@@ -58,13 +91,28 @@ typedef struct process {
     u32 daemon_last_run;        /* 最後の実行時刻 */
     bool daemon_enabled;        /* デーモン有効フラグ */
     u32 daemon_run_count;       /* 実行回数 */
+    ktimer_t daemon_timer;      /* 次回実行用タイマー (タイマーホイール登録) */
+
+    /* スリープ・待機用フィールド */
+    ktimer_t sleep_timer;       /* 起床用タイマー (process_sleep) */
+    struct wait_queue* waiting_on; /* 待機中のウェイトキュー (NULL = 待機なし) */
 
-    struct process* next;       /* プロセスリストの次のプロセス */
+    /* プロセス間通信用フィールド */
+    msg_queue_t msg_queue;      /* 受信メッセージリング */
+
+    /* レディキュー用リンク (双方向リスト、O(1)で追加・削除) */
+    struct process* next;       /* レディキューの次のプロセス */
+    struct process* prev;       /* レディキューの前のプロセス */
+
+    /* 全プロセスリスト用リンク (一覧表示・デーモン走査用) */
+    struct process* all_next;
+    struct process* all_prev;
 } process_t;
 
 /* スケジューラ制御構造体 */
 typedef struct {
-    process_t* ready_queue;     /* 実行可能プロセスキュー */
+    process_t* ready_head;      /* 実行可能プロセスキューの先頭 */
+    process_t* ready_tail;      /* 実行可能プロセスキューの末尾 */
     process_t* current_process; /* 現在実行中のプロセス */
     u32 next_pid;               /* 次に割り当てるPID */
     u32 process_count;          /* 総プロセス数 */
@@ -76,6 +124,8 @@ void process_init(void);
 process_t* process_create(const char* name, void* entry_point, u32 stack_size);
 void process_destroy(process_t* process);
 void process_set_state(process_t* process, process_state_t new_state);
+process_t* process_get_current(void);   /* 実行中プロセス (NULL = プロセス文脈外) */
+process_t* process_find_by_pid(u32 pid);
 
 /* スケジューラ関数 */
 void scheduler_init(void);
@@ -85,12 +135,26 @@ process_t* scheduler_get_next_process(void);
 void scheduler_switch_process(void);
 void scheduler_tick(void);  /* タイマー割り込みから呼び出される */
 
+/* スリープ・ウェイトキュー関数 */
+void process_sleep(u32 ticks);              /* 現在のプロセスをticks間スリープ */
+void process_wake(process_t* process);      /* スリープ/待機中のプロセスを起床 */
+void wait_queue_init(wait_queue_t* queue);
+void wait_queue_block(wait_queue_t* queue, process_t* process);
+process_t* wait_queue_wake_one(wait_queue_t* queue);
+u32 wait_queue_wake_all(wait_queue_t* queue);
+
+/* プロセス間メッセージ (IPC) */
+int msg_send(u32 pid, const void* buf);     /* MSG_SIZE分を受信者のリングへ直接コピー */
+int msg_recv(void* buf);                    /* 現在のプロセス宛を受信 (空ならブロック) */
+int msg_try_recv(process_t* process, void* buf);  /* 非ブロック受信 (デーモン用) */
+
 /* コンテキストスイッチ */
 void context_switch(cpu_context_t* old_context, cpu_context_t* new_context);
 
 /* プロセス情報表示 */
 void process_print_info(void);
 void process_list_all(void);
+void process_top(void);     /* プロセスごとのCPU使用率表示 */
 
 /* カーネルプロセス用関数 */
 process_t* kernel_process_create(const char* name, void (*entry_point)(void));
@@ -99,7 +163,6 @@ process_t* kernel_process_create(const char* name, void (*entry_point)(void));
 process_t* daemon_create(const char* name, daemon_type_t type, void (*entry_point)(void), u32 interval_ticks);
 void daemon_start(process_t* daemon);
 void daemon_stop(process_t* daemon);
-void daemon_tick(void);  /* タイマー割り込みから呼び出される */
 void daemon_list_all(void);
 process_t* daemon_find_by_name(const char* name);
 process_t* daemon_find_by_type(daemon_type_t type);
@@ -110,7 +173,7 @@ void test_process_a(void);      /* テストプロセスA */
 void test_process_b(void);      /* テストプロセスB */
 
 /* プロセス制御定数 */
-#define MAX_PROCESSES           8
+/* PCBはkmallocで動的確保するため、プロセス数の上限はメモリ量のみ */
 #define DEFAULT_STACK_SIZE      (8 * 1024)     /* 8KB */
 #define DEFAULT_TIME_QUANTUM    100             /* 100ms */
 #define IDLE_PROCESS_PID        0
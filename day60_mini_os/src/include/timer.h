@@ -0,0 +1,36 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include "kernel.h"
+
+/* タイマーホイールのスロット数 (2のべき乗であること) */
+#define TIMER_WHEEL_SLOTS   64
+
+struct ktimer;
+
+/* タイマー発火時に呼び出されるコールバック */
+typedef void (*timer_callback_t)(struct ktimer* timer, void* arg);
+
+/* カーネルタイマー
+ * 領域は呼び出し側が用意する (PCB等に埋め込む想定)。
+ * 発火時刻のスロットに双方向リストで繋がれ、登録・解除・発火は
+ * 登録タイマー数に依存しないコストで行える */
+typedef struct ktimer {
+    u32 expires;                /* 発火時刻 (system ticks の絶対値) */
+    timer_callback_t callback;  /* 発火時に呼ばれる関数 */
+    void* arg;                  /* コールバックに渡す引数 */
+    struct ktimer* next;        /* 同一スロット内の次のタイマー */
+    struct ktimer* prev;        /* 同一スロット内の前のタイマー */
+    bool pending;               /* ホイールに登録済みフラグ */
+} ktimer_t;
+
+/* タイマーシステム関数 */
+void timer_init(void);
+void timer_add(ktimer_t* timer, u32 delta_ticks, timer_callback_t callback, void* arg);
+void timer_cancel(ktimer_t* timer);
+void timer_tick(void);          /* タイマー割り込みから毎tick呼び出される */
+
+/* デバッグ・情報表示 */
+u32 timer_pending_count(void);
+
+#endif /* TIMER_H */
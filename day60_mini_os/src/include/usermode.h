@@ -77,6 +77,8 @@ typedef struct {
 void usermode_init(void);
 void gdt_setup(void);
 void tss_setup(void);
+void sysenter_setup(void);
+bool is_sysenter_available(void);
 
 /* GDT管理 */
 void gdt_set_gate(int num, u32 base, u32 limit, u8 access, u8 gran);
@@ -103,6 +105,7 @@ u32 get_current_privilege_level(void);
 extern void gdt_flush(u32 gdt_ptr);
 extern void tss_flush(void);
 extern void switch_to_user_mode_asm(u32 user_stack, u32 user_code);
+extern void sysenter_entry(void);
 extern u32 get_cs(void);
 extern u32 get_ds(void);
 
@@ -0,0 +1,223 @@
+#include "kernel.h"
+#include "memory.h"
+#include "process.h"
+
+/* マイクロベンチマーク
+ *
+ * アロケータ・スケジューラ・出力経路の改修を実機の数字で検証するための
+ * 計測コマンド。時間計測はrdtscで行い、PITティック (pit_init(2)で2Hz)
+ * を基準にTSC周波数を較正してops/secに換算する。
+ */
+
+#define BENCH_TICK_HZ       2           /* interrupt.cのpit_init(2)と一致させる */
+#define BENCH_CALIBRATE_SPIN 0x10000000 /* ティック待ちの上限スピン回数 */
+
+extern u32 get_system_ticks(void);
+
+/* 較正結果 (0 = 較正失敗、cyclesのみ表示) */
+static u64 tsc_per_sec = 0;
+
+static u64 bench_rdtsc(void) {
+    u32 lo, hi;
+    asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((u64)hi << 32) | lo;
+}
+
+/* 64bit除算 (リンクにlibgccを含まないため筆算で行う) */
+static u64 u64_div(u64 n, u64 d) {
+    if (d == 0) return 0;
+
+    u64 quotient = 0;
+    u64 remainder = 0;
+    for (int i = 63; i >= 0; i--) {
+        remainder = (remainder << 1) | ((n >> i) & 1);
+        if (remainder >= d) {
+            remainder -= d;
+            quotient |= (u64)1 << i;
+        }
+    }
+    return quotient;
+}
+
+/* 次のPITティックまで待つ (タイマーが止まっていればfalse) */
+static bool bench_wait_tick_edge(void) {
+    u32 start = get_system_ticks();
+    for (u32 spin = 0; spin < BENCH_CALIBRATE_SPIN; spin++) {
+        if (get_system_ticks() != start) return true;
+    }
+    return false;
+}
+
+/* PITティック1回分のTSCサイクル数からTSC周波数を較正する */
+static void bench_calibrate(void) {
+    kernel_printf("bench: Calibrating TSC against PIT (takes ~1 tick)...\n");
+
+    if (!bench_wait_tick_edge()) {
+        kernel_printf("bench: WARNING - Timer not running, reporting cycles only\n");
+        tsc_per_sec = 0;
+        return;
+    }
+
+    u64 start = bench_rdtsc();
+    if (!bench_wait_tick_edge()) {
+        kernel_printf("bench: WARNING - Timer stalled, reporting cycles only\n");
+        tsc_per_sec = 0;
+        return;
+    }
+    u64 tsc_per_tick = bench_rdtsc() - start;
+
+    tsc_per_sec = tsc_per_tick * BENCH_TICK_HZ;
+    kernel_printf("bench: TSC calibrated: %llu cycles/sec\n", tsc_per_sec);
+}
+
+/* 1行分の計測結果を表示する */
+static void bench_report(const char* name, u32 ops, u64 cycles) {
+    u32 cycles_per_op = (u32)u64_div(cycles, ops);
+
+    kernel_printf("  %s: %u ops, %llu cycles, %u cycles/op",
+                  name, ops, cycles, cycles_per_op);
+    if (tsc_per_sec != 0 && cycles != 0) {
+        u32 ops_per_sec = (u32)u64_div((u64)ops * tsc_per_sec, cycles);
+        kernel_printf(", %u ops/sec", ops_per_sec);
+    }
+    kernel_printf("\n");
+}
+
+/* alloc_page/free_pageの往復コスト */
+static void bench_alloc_page(void) {
+    const u32 iterations = 1000;
+
+    u64 start = bench_rdtsc();
+    for (u32 i = 0; i < iterations; i++) {
+        u32 page = alloc_page();
+        if (page == 0) {
+            kernel_printf("  alloc_page: FAILED at iteration %u\n", i);
+            return;
+        }
+        free_page(page);
+    }
+    u64 cycles = bench_rdtsc() - start;
+
+    bench_report("alloc_page/free_page", iterations, cycles);
+}
+
+/* alloc_pagesの連続確保コスト (サイズ別) */
+static void bench_alloc_pages(void) {
+    static const u32 sizes[] = { 2, 8, 64 };
+    const u32 iterations = 200;
+
+    for (u32 s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        u32 count = sizes[s];
+
+        u64 start = bench_rdtsc();
+        for (u32 i = 0; i < iterations; i++) {
+            u32 addr = alloc_pages(count);
+            if (addr == 0) {
+                kernel_printf("  alloc_pages(%u): FAILED at iteration %u\n",
+                              count, i);
+                return;
+            }
+            free_pages(addr, count);
+        }
+        u64 cycles = bench_rdtsc() - start;
+
+        char name[32];
+        char num[16];
+        strcpy(name, "alloc_pages(");
+        int_to_string(count, num);
+        strcpy(name + strlen(name), num);
+        strcpy(name + strlen(name), ")");
+        bench_report(name, iterations, cycles);
+    }
+}
+
+/* スケジューラ用ダミープロセス (実行されない) */
+static void bench_dummy_process(void) {
+    for (;;) {
+        asm volatile("hlt");
+    }
+}
+
+/* スケジューラのディスパッチレート。
+ * context_switch()はまだスタブのため、レディキューのローテーションと
+ * スケジュール時刻の記録 (scheduler_get_next_process相当のコスト) を測る */
+static void bench_scheduler(void) {
+    const u32 iterations = 10000;
+
+    process_t* proc_a = kernel_process_create("bench_a", bench_dummy_process);
+    process_t* proc_b = kernel_process_create("bench_b", bench_dummy_process);
+    if (proc_a == NULL || proc_b == NULL) {
+        kernel_printf("  scheduler: FAILED to create bench processes\n");
+        if (proc_a != NULL) process_destroy(proc_a);
+        if (proc_b != NULL) process_destroy(proc_b);
+        return;
+    }
+
+    scheduler_add_process(proc_a);
+    scheduler_add_process(proc_b);
+
+    u64 start = bench_rdtsc();
+    for (u32 i = 0; i < iterations; i++) {
+        scheduler_get_next_process();
+    }
+    u64 cycles = bench_rdtsc() - start;
+
+    process_destroy(proc_a);
+    process_destroy(proc_b);
+
+    bench_report("scheduler dispatch", iterations, cycles);
+}
+
+/* VGA出力スループット (シャドウバッファ + まとめてMMIO転送の経路) */
+static void bench_vga(void) {
+    const u32 iterations = 500;
+    char line[VGA_WIDTH];
+
+    memset(line, 'x', sizeof(line) - 1);
+    line[sizeof(line) - 1] = '\n';
+
+    u64 start = bench_rdtsc();
+    for (u32 i = 0; i < iterations; i++) {
+        vga_write_len(line, sizeof(line));
+    }
+    u64 cycles = bench_rdtsc() - start;
+
+    /* opsはバイト数で数える (1 op = 1バイト出力) */
+    bench_report("vga_write_len (bytes)", iterations * sizeof(line), cycles);
+}
+
+/* シリアル出力スループット (現状はLSRポーリングでUART排出待ち) */
+static void bench_serial(void) {
+    const u32 iterations = 100;
+    static const char message[] =
+        "bench: serial throughput test line 0123456789 abcdefghij....\n";
+
+    u64 start = bench_rdtsc();
+    for (u32 i = 0; i < iterations; i++) {
+        serial_write(message);
+    }
+    u64 cycles = bench_rdtsc() - start;
+
+    bench_report("serial_write (bytes)",
+                 iterations * (sizeof(message) - 1), cycles);
+}
+
+/* 全ベンチマークを実行する (シェルのbenchコマンドから呼び出される) */
+void bench_run_all(void) {
+    kernel_printf("\n=== Kernel Microbenchmarks ===\n");
+
+    bench_calibrate();
+
+    kernel_printf("bench: Memory allocator:\n");
+    bench_alloc_page();
+    bench_alloc_pages();
+
+    kernel_printf("bench: Scheduler:\n");
+    bench_scheduler();
+
+    kernel_printf("bench: Output paths:\n");
+    bench_vga();
+    bench_serial();
+
+    kernel_printf("=== Benchmarks completed ===\n\n");
+}
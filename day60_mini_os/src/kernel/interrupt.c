@@ -8,6 +8,15 @@ static idt_ptr_t idt_ptr;
 /* 割り込みハンドラテーブル */
 static interrupt_handler_t interrupt_handlers[IDT_ENTRIES];
 
+/* ベクタごとの割り込み統計 (IRQストーム・フォルトループの診断用) */
+static irq_stats_t irq_stats[IDT_ENTRIES];
+
+static u64 irq_rdtsc(void) {
+    u32 lo, hi;
+    asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((u64)hi << 32) | lo;
+}
+
 /* 割り込み初期化 */
 void interrupt_init(void) {
     kernel_printf("interrupt_init: Starting interrupt system initialization...\n");
@@ -25,11 +34,25 @@ void interrupt_init(void) {
     pic_init();
     kernel_printf("interrupt_init: pic_init completed\n");
 
-            /* 例外ハンドラ設定 - 段階的に実装 */
+    /* 例外ハンドラ設定 - スタブの揃っているベクタにゲートを張る。
+     * ゲートがないと例外はIDTの空エントリに落ちてトリプルフォルトになり、
+     * ページフォルト経由のデマンドページングも動かない */
     kernel_printf("interrupt_init: Setting up exception handlers...\n");
-
-    /* 一時的に例外ハンドラ設定をスキップ */
-    kernel_printf("interrupt_init: Skipping exception handlers for debugging...\n");
+    idt_set_gate(0,  (u32)isr0,  0x08, IDT_FLAG_PRESENT | IDT_FLAG_RING0 | IDT_FLAG_INTERRUPT); /* 除算エラー */
+    idt_set_gate(1,  (u32)isr1,  0x08, IDT_FLAG_PRESENT | IDT_FLAG_RING0 | IDT_FLAG_INTERRUPT); /* デバッグ */
+    idt_set_gate(2,  (u32)isr2,  0x08, IDT_FLAG_PRESENT | IDT_FLAG_RING0 | IDT_FLAG_INTERRUPT); /* NMI */
+    idt_set_gate(3,  (u32)isr3,  0x08, IDT_FLAG_PRESENT | IDT_FLAG_RING0 | IDT_FLAG_INTERRUPT); /* ブレークポイント */
+    idt_set_gate(4,  (u32)isr4,  0x08, IDT_FLAG_PRESENT | IDT_FLAG_RING0 | IDT_FLAG_INTERRUPT); /* オーバーフロー */
+    idt_set_gate(5,  (u32)isr5,  0x08, IDT_FLAG_PRESENT | IDT_FLAG_RING0 | IDT_FLAG_INTERRUPT); /* 境界範囲超過 */
+    idt_set_gate(6,  (u32)isr6,  0x08, IDT_FLAG_PRESENT | IDT_FLAG_RING0 | IDT_FLAG_INTERRUPT); /* 無効オペコード */
+    idt_set_gate(7,  (u32)isr7,  0x08, IDT_FLAG_PRESENT | IDT_FLAG_RING0 | IDT_FLAG_INTERRUPT); /* デバイス使用不可 */
+    idt_set_gate(8,  (u32)isr8,  0x08, IDT_FLAG_PRESENT | IDT_FLAG_RING0 | IDT_FLAG_INTERRUPT); /* ダブルフォルト */
+    idt_set_gate(10, (u32)isr10, 0x08, IDT_FLAG_PRESENT | IDT_FLAG_RING0 | IDT_FLAG_INTERRUPT); /* 無効TSS */
+    idt_set_gate(11, (u32)isr11, 0x08, IDT_FLAG_PRESENT | IDT_FLAG_RING0 | IDT_FLAG_INTERRUPT); /* セグメント不在 */
+    idt_set_gate(12, (u32)isr12, 0x08, IDT_FLAG_PRESENT | IDT_FLAG_RING0 | IDT_FLAG_INTERRUPT); /* スタックフォルト */
+    idt_set_gate(13, (u32)isr13, 0x08, IDT_FLAG_PRESENT | IDT_FLAG_RING0 | IDT_FLAG_INTERRUPT); /* 一般保護例外 */
+    idt_set_gate(14, (u32)isr14, 0x08, IDT_FLAG_PRESENT | IDT_FLAG_RING0 | IDT_FLAG_INTERRUPT); /* ページフォルト */
+    idt_set_gate(16, (u32)isr16, 0x08, IDT_FLAG_PRESENT | IDT_FLAG_RING0 | IDT_FLAG_INTERRUPT); /* FPUエラー */
 
     /* ハードウェア割り込みハンドラ設定 */
     kernel_printf("interrupt_init: Setting up hardware interrupt handlers...\n");
@@ -37,6 +60,8 @@ void interrupt_init(void) {
     register_interrupt_handler(32, timer_handler);  /* タイマーハンドラー登録 */
     kernel_printf("interrupt_init: Setting up IRQ1 (keyboard)...\n");
     idt_set_gate(33, (u32)irq1, 0x08, IDT_FLAG_PRESENT | IDT_FLAG_RING0 | IDT_FLAG_INTERRUPT); /* キーボード */
+    kernel_printf("interrupt_init: Setting up IRQ4 (serial COM1)...\n");
+    idt_set_gate(36, (u32)irq4, 0x08, IDT_FLAG_PRESENT | IDT_FLAG_RING0 | IDT_FLAG_INTERRUPT); /* シリアル送信 */
 
     /* システムコールハンドラ設定 */
     kernel_printf("interrupt_init: Setting up system call handler...\n");
@@ -80,35 +105,57 @@ void idt_load(void) {
     idt_flush((u32)&idt_ptr);
 }
 
-/* 汎用割り込みハンドラ（アセンブリから呼び出される） */
+static void interrupt_dispatch(interrupt_frame_t* frame);
+
+/* 汎用割り込みハンドラ（アセンブリから呼び出される）。
+ * ディスパッチ本体を包んで、ベクタごとの回数と処理時間を記録する */
 void interrupt_handler(interrupt_frame_t* frame) {
-    /* ハードウェア割り込みかどうかを判定 */
+    u64 start = irq_rdtsc();
+    interrupt_dispatch(frame);
+    u64 delta = irq_rdtsc() - start;
 
-    /* まずキーボード入力があるかチェック（優先処理） */
-    if (inb(0x64) & 0x01) {  /* キーボードバッファに入力がある */
-        /* キーボード割り込みハンドラーを呼び出し */
-        if (interrupt_handlers[33] != NULL) {
-            interrupt_handlers[33](frame);
+    irq_stats_record(frame->int_no, (u32)delta);
+}
+
+/* 割り込みディスパッチ本体。スタブがプッシュしたベクタ番号
+ * (frame->int_no) で振り分ける */
+static void interrupt_dispatch(interrupt_frame_t* frame) {
+    u32 vector = frame->int_no;
+
+    /* CPU例外 (ベクタ0-31): PICを経由しないのでEOIは不要。
+     * ページフォルト等の個別ハンドラが登録されていればそちらへ、
+     * なければ共通ダンプを出して停止する */
+    if (vector < 32) {
+        if (interrupt_handlers[vector] != NULL) {
+            interrupt_handlers[vector](frame);
         } else {
-            /* フォールバック処理 */
-            u8 scancode = inb(0x60);
-            kernel_printf("🎉 KEYBOARD: 0x%02X\n", scancode);
+            exception_handler(frame);
         }
-        /* PIC EOI送信 (IRQ1) */
-        outb(0x20, 0x20);
         return;
     }
 
-    /* タイマー割り込みの場合 */
-    if (interrupt_handlers[32] != NULL) {
-        interrupt_handlers[32](frame);
-        /* PIC EOI送信 (IRQ0) */
-        outb(0x20, 0x20);
+    /* システムコール (int 0x80): ソフトウェア割り込みなのでEOI不要 */
+    if (vector == INT_SYSCALL) {
+        if (interrupt_handlers[INT_SYSCALL] != NULL) {
+            interrupt_handlers[INT_SYSCALL](frame);
+        } else {
+            syscall_handler(frame);
+        }
         return;
     }
 
-    /* その他の割り込み */
-    /* 念のためEOI送信 */
+    /* ハードウェア割り込み (IRQ)。他のIRQ処理の前にキーボードバッファに
+     * 入力が溜まっていたら先に処理する（キーボード優先） */
+    if (vector != INT_KEYBOARD && (inb(0x64) & 0x01) &&
+        interrupt_handlers[INT_KEYBOARD] != NULL) {
+        interrupt_handlers[INT_KEYBOARD](frame);
+    }
+
+    if (interrupt_handlers[vector] != NULL) {
+        interrupt_handlers[vector](frame);
+    }
+
+    /* PIC EOI送信（マスタのみ: IRQ0-7しか使っていない） */
     outb(0x20, 0x20);
 }
 
@@ -158,7 +205,7 @@ void exception_handler(interrupt_frame_t* frame) {
 void timer_handler(interrupt_frame_t* frame) {
     static u32 tick_count = 0;
     extern void increment_system_ticks(void);
-    extern void daemon_tick(void);
+    extern void timer_tick(void);
 
     tick_count++;
     increment_system_ticks();  /* システム時刻を更新 */
@@ -168,11 +215,11 @@ void timer_handler(interrupt_frame_t* frame) {
         kernel_printf("Timer tick: %u\n", tick_count);
     }
 
-    /* デーモンタスク実行チェック */
-    daemon_tick();
+    /* タイマーホイール処理 (期限が来たタイマーのみ発火、デーモン実行を含む) */
+    timer_tick();
 
-    /* スケジューラのタイムスライス処理（一時的にコメントアウト） */
-    // scheduler_tick();
+    /* スケジューラのタイムスライス処理 (CPU時間の課金を含む) */
+    scheduler_tick();
 
     UNUSED(frame);
 }
@@ -272,4 +319,80 @@ void register_interrupt_handler(u8 n, interrupt_handler_t handler) {
 /* 割り込みハンドラ取得（テスト用） */
 interrupt_handler_t get_interrupt_handler(u8 n) {
     return interrupt_handlers[n];
+}
+
+/* ベクタごとの統計を記録する (共通ハンドラ経路から呼ばれる) */
+void irq_stats_record(u32 vector, u32 cycles) {
+    if (vector >= IDT_ENTRIES) return;
+
+    irq_stats[vector].count++;
+    irq_stats[vector].cycles += cycles;
+    if (cycles > irq_stats[vector].max_cycles) {
+        irq_stats[vector].max_cycles = cycles;
+    }
+}
+
+const irq_stats_t* irq_stats_get(u32 vector) {
+    if (vector >= IDT_ENTRIES) return NULL;
+    return &irq_stats[vector];
+}
+
+void irq_stats_reset(void) {
+    memset(irq_stats, 0, sizeof(irq_stats));
+    kernel_printf("irq_stats_reset: Counters cleared\n");
+}
+
+/* ベクタ番号を表示名に変換する */
+static const char* irq_vector_name(u32 vector) {
+    switch (vector) {
+        case INT_PAGE_FAULT:         return "page fault";
+        case INT_GENERAL_PROTECTION: return "gp fault";
+        case INT_DIVIDE_ERROR:       return "divide err";
+        case INT_TIMER:              return "timer";
+        case INT_KEYBOARD:           return "keyboard";
+        case INT_SERIAL_COM1:        return "serial";
+        case INT_SYSCALL:            return "syscall";
+        default:                     return "other";
+    }
+}
+
+/* 64bit除算 (リンクにlibgccを含まないため筆算で行う) */
+static u32 irq_stats_div(u64 n, u32 d) {
+    if (d == 0) return 0;
+
+    u64 quotient = 0;
+    u64 remainder = 0;
+    for (int i = 63; i >= 0; i--) {
+        remainder = (remainder << 1) | ((n >> i) & 1);
+        if (remainder >= d) {
+            remainder -= d;
+            quotient |= (u64)1 << i;
+        }
+    }
+    return (u32)quotient;
+}
+
+/* 発生したことのあるベクタの統計を一覧表示する (irqstatコマンド) */
+void irq_stats_print(void) {
+    kernel_printf("\n--- Interrupt Statistics ---\n");
+    kernel_printf("Vec  | Name       | Count      | Total cycles    | Avg    | Max\n");
+    kernel_printf("-----|------------|------------|-----------------|--------|--------\n");
+
+    bool any = false;
+    for (u32 vector = 0; vector < IDT_ENTRIES; vector++) {
+        if (irq_stats[vector].count == 0) continue;
+
+        any = true;
+        u32 avg = irq_stats_div(irq_stats[vector].cycles,
+                                irq_stats[vector].count);
+        kernel_printf("%u | %s | %u | %llu | %u | %u\n",
+                      vector, irq_vector_name(vector),
+                      irq_stats[vector].count, irq_stats[vector].cycles,
+                      avg, irq_stats[vector].max_cycles);
+    }
+
+    if (!any) {
+        kernel_printf("(no interrupts recorded)\n");
+    }
+    kernel_printf("----------------------------\n\n");
 }
\ No newline at end of file
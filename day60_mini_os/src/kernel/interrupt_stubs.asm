@@ -12,12 +12,14 @@ idt_flush:
     ret
 
 ; 割り込みスタブマクロ（エラーコードなし）
+; 割り込み番号はdwordでプッシュする（push byteは符号拡張されるため
+; ベクタ128が0xFFFFFF80になり、int_noでのディスパッチが壊れる）
 %macro ISR_NOERRCODE 1
 global isr%1
 isr%1:
     cli                 ; 割り込み無効化
     push byte 0         ; ダミーエラーコード
-    push byte %1        ; 割り込み番号
+    push dword %1       ; 割り込み番号
     jmp isr_common_stub
 %endmacro
 
@@ -26,7 +28,7 @@ isr%1:
 global isr%1
 isr%1:
     cli                 ; 割り込み無効化
-    push byte %1        ; 割り込み番号
+    push dword %1       ; 割り込み番号
     jmp isr_common_stub
 %endmacro
 
@@ -36,7 +38,7 @@ global irq%1
 irq%1:
     cli                 ; 割り込み無効化
     push byte 0         ; ダミーエラーコード
-    push byte %2        ; 割り込み番号
+    push dword %2       ; 割り込み番号
     jmp isr_common_stub
 %endmacro
 
@@ -60,6 +62,7 @@ ISR_NOERRCODE 16    ; FPUエラー
 ; ハードウェア割り込み定義
 IRQ 0, 32           ; タイマー（PIT）
 IRQ 1, 33           ; キーボード
+IRQ 4, 36           ; シリアル（COM1）
 
 ; システムコール
 ISR_NOERRCODE 128   ; システムコール (int 0x80)
@@ -68,7 +71,7 @@ global isr_syscall
 isr_syscall:
     cli
     push byte 0         ; ダミーエラーコード
-    push byte 0x80      ; システムコール番号
+    push dword 0x80     ; システムコール番号
     jmp isr_common_stub
 
 ; 共通割り込みスタブ（修正版）
@@ -0,0 +1,190 @@
+#include "memory.h"
+#include "kernel.h"
+
+/*
+ * Byte-granular kernel heap (kmalloc/kfree) over alloc_pages().
+ *
+ * Small objects (16..2048 bytes) come from per-size bins: each bin keeps a
+ * list of "slab" pages carved into equal objects, with the page's own
+ * first bytes holding the bin metadata and free objects linking through
+ * their first word -- no per-object header, which matters on the 32MB
+ * targets this kernel deploys to. Pages that empty out go straight back
+ * to the page allocator.
+ *
+ * Larger requests take whole pages from the buddy allocator with a
+ * 16-byte header in front of the returned pointer, so kfree() can tell
+ * the cases apart by the pointer's offset within its page (slab objects
+ * never sit at offset 16; large pointers always do).
+ */
+
+#define KMALLOC_SLAB_MAGIC  0x51ABA110
+#define KMALLOC_LARGE_MAGIC 0xB16A110C
+
+#define KMALLOC_MIN_SIZE    16
+#define KMALLOC_MAX_BIN     2048
+#define KMALLOC_NUM_BINS    8   /* 16, 32, 64, 128, 256, 512, 1024, 2048 */
+
+/* Header at the start of every slab page (one page, one bin) */
+struct kmalloc_slab {
+    u32 magic;
+    u32 bin;        /* Index into bins[] */
+    u32 in_use;     /* Allocated objects on this page */
+    u32 free_head;  /* Offset of first free object (0 = none) */
+    u32 next;       /* Next slab page of this bin with free objects (addr, 0 = end) */
+    u32 prev;       /* Previous such page (addr, 0 = list head) */
+    u32 pad[2];     /* Objects start 32-byte aligned */
+};
+
+/* Header in front of a large (whole-page) allocation */
+struct kmalloc_large {
+    u32 magic;
+    u32 pages;
+    u32 pad[2];     /* Returned pointer stays 16-byte aligned */
+};
+
+#define SLAB_OBJ_START  sizeof(struct kmalloc_slab)     /* 32 */
+#define LARGE_HDR_SIZE  sizeof(struct kmalloc_large)    /* 16 */
+
+/* Per-bin list of slab pages that still have free objects */
+static u32 bin_partial[KMALLOC_NUM_BINS];
+
+static u32 bin_size(u32 bin) {
+    return (u32)KMALLOC_MIN_SIZE << bin;
+}
+
+static u32 bin_for_size(size_t size) {
+    u32 bin = 0;
+    while (bin_size(bin) < size) bin++;
+    return bin;
+}
+
+static void slab_list_remove(struct kmalloc_slab* slab) {
+    if (slab->prev != 0) {
+        ((struct kmalloc_slab*)slab->prev)->next = slab->next;
+    } else {
+        bin_partial[slab->bin] = slab->next;
+    }
+    if (slab->next != 0) {
+        ((struct kmalloc_slab*)slab->next)->prev = slab->prev;
+    }
+    slab->next = 0;
+    slab->prev = 0;
+}
+
+static void slab_list_push(struct kmalloc_slab* slab) {
+    slab->next = bin_partial[slab->bin];
+    slab->prev = 0;
+    if (slab->next != 0) {
+        ((struct kmalloc_slab*)slab->next)->prev = (u32)slab;
+    }
+    bin_partial[slab->bin] = (u32)slab;
+}
+
+/* Carve a fresh page into objects for `bin` and put it on the list */
+static struct kmalloc_slab* slab_page_new(u32 bin) {
+    u32 addr = alloc_page();  /* Comes back zeroed */
+    if (addr == 0) return NULL;
+
+    struct kmalloc_slab* slab = (struct kmalloc_slab*)addr;
+    slab->magic = KMALLOC_SLAB_MAGIC;
+    slab->bin = bin;
+    slab->in_use = 0;
+
+    /* Thread all objects onto the page's free list (offsets) */
+    u32 size = bin_size(bin);
+    u32 prev_off = 0;
+    for (u32 off = SLAB_OBJ_START; off + size <= PAGE_SIZE; off += size) {
+        *(u32*)(addr + off) = prev_off;
+        prev_off = off;
+    }
+    slab->free_head = prev_off;
+
+    slab_list_push(slab);
+    return slab;
+}
+
+void* kmalloc(size_t size) {
+    if (size == 0) return NULL;
+
+    /* Large allocation: whole pages with a header in front */
+    if (size > KMALLOC_MAX_BIN) {
+        u32 pages = (u32)(size + LARGE_HDR_SIZE + PAGE_SIZE - 1) / PAGE_SIZE;
+        u32 base = alloc_pages(pages);
+        if (base == 0) return NULL;
+
+        struct kmalloc_large* hdr = (struct kmalloc_large*)base;
+        hdr->magic = KMALLOC_LARGE_MAGIC;
+        hdr->pages = pages;
+        return (void*)(base + LARGE_HDR_SIZE);
+    }
+
+    u32 bin = bin_for_size(size);
+    struct kmalloc_slab* slab = (struct kmalloc_slab*)bin_partial[bin];
+    if (slab == NULL) {
+        slab = slab_page_new(bin);
+        if (slab == NULL) return NULL;
+    }
+
+    u32 off = slab->free_head;
+    u32 obj = (u32)slab + off;
+    slab->free_head = *(u32*)obj;
+    slab->in_use++;
+
+    /* Page exhausted: drop it from the partial list until something frees */
+    if (slab->free_head == 0) {
+        slab_list_remove(slab);
+    }
+    return (void*)obj;
+}
+
+void kfree(void* ptr) {
+    if (ptr == NULL) return;
+    u32 addr = (u32)ptr;
+    u32 page_base = addr & ~(u32)PAGE_MASK;
+    u32 offset = addr - page_base;
+
+    /* Large allocation: pointer sits right after its header */
+    if (offset == LARGE_HDR_SIZE) {
+        struct kmalloc_large* hdr = (struct kmalloc_large*)page_base;
+        if (hdr->magic == KMALLOC_LARGE_MAGIC) {
+            hdr->magic = 0;
+            free_pages(page_base, hdr->pages);
+            return;
+        }
+    }
+
+    struct kmalloc_slab* slab = (struct kmalloc_slab*)page_base;
+    if (slab->magic != KMALLOC_SLAB_MAGIC || offset < SLAB_OBJ_START ||
+        (offset - SLAB_OBJ_START) % bin_size(slab->bin) != 0) {
+        kernel_printf("kfree: bad pointer 0x%x (ignored)\n", addr);
+        return;
+    }
+
+    bool was_full = (slab->free_head == 0);
+    *(u32*)addr = slab->free_head;
+    slab->free_head = offset;
+    slab->in_use--;
+
+    if (slab->in_use == 0) {
+        /* Whole page free again: give it back to the page allocator */
+        if (!was_full) slab_list_remove(slab);
+        slab->magic = 0;
+        free_page(page_base);
+    } else if (was_full) {
+        /* Page has space again: make it allocatable */
+        slab_list_push(slab);
+    }
+}
+
+void* kmalloc_aligned(size_t size, size_t alignment) {
+    /* Every kmalloc() result is at least 16-byte aligned (slab objects are
+     * power-of-two sized from offset 32; large pointers sit at offset 16).
+     * Callers needing page alignment should use alloc_pages() directly --
+     * nothing in this kernel wants anything in between. */
+    if (alignment > KMALLOC_MIN_SIZE) {
+        kernel_printf("kmalloc_aligned: unsupported alignment %u, use alloc_pages\n",
+                      (u32)alignment);
+        return NULL;
+    }
+    return kmalloc(size);
+}
@@ -359,6 +359,11 @@ void test_interrupt_system(void) {
     interrupt_init();
     kernel_printf("interrupt_init completed successfully\n");
 
+    /* IDT/PICが立ち上がったのでシリアル送信を割り込み駆動に切り替える */
+    kernel_printf("About to call serial_enable_tx_irq...\n");
+    serial_enable_tx_irq();
+    kernel_printf("serial_enable_tx_irq completed successfully\n");
+
     // 段階2: 割り込み無効状態でのテスト
     kernel_printf("Testing interrupt system (no timer)...\n");
 
@@ -377,17 +382,23 @@ void test_interrupt_system(void) {
 void test_paging_system(void) {
     kernel_printf("\n=== Paging System Test ===\n");
 
-    // 段階1: ページング初期化のみ（簡略化）
+    // 段階1: ページング初期化
+    // interrupt_init()の後に呼ぶこと: paging_init()がベクタ14に
+    // page_fault_handlerを登録し、デマンドページングとCoWはこの
+    // フォルト配送に依存する
     kernel_printf("About to call paging_init...\n");
+    paging_init();
+    kernel_printf("paging_init completed successfully\n");
 
-    // 一時的にページング初期化をスキップ
-    kernel_printf("Skipping paging_init for now (debugging)\n");
-
-    // paging_init();
-    // kernel_printf("paging_init completed successfully\n");
+    // 段階2: ページング有効化 (CR3ロード + CR0.PG/WPセット)。
+    // 物理メモリ全域が恒等マッピング済みなのでカーネルはそのまま動き、
+    // 以降のスタックはデマンドページング、クローンはCoWになる
+    kernel_printf("About to call paging_enable...\n");
+    paging_enable();
+    kernel_printf("paging_enable completed successfully\n");
 
-    // 段階2: ページング情報の表示（スキップ）
-    // paging_print_info();
+    // 段階3: ページング情報の表示
+    paging_print_info();
 
     kernel_printf("=== Paging System Test Complete ===\n\n");
 }
@@ -573,6 +584,12 @@ void kmain(void) {
     // Test memory allocator
     test_memory_allocator();
 
+    // Initialize kernel timer wheel (daemons arm timers in process_init)
+    kernel_printf("About to call timer_init...\n");
+    extern void timer_init(void);
+    timer_init();
+    kernel_printf("timer_init completed successfully\n");
+
     // Initialize process management and daemons
     kernel_printf("About to call process_init...\n");
     extern void process_init(void);
@@ -10,10 +10,91 @@ extern char _kernel_end[];
 
 /* Forward declarations */
 static void init_page_allocator(void);
+static void init_buddy_allocator(void);
 static void mark_kernel_pages(void);
 static bool is_page_used(u32 page_num);
 void parse_memory_map(struct multiboot_info* mboot_info);
 
+/*
+ * Buddy allocator. Free memory is kept on per-order free lists of
+ * power-of-two, naturally aligned page blocks (order 0 = 1 page up to
+ * BUDDY_MAX_ORDER = 1024 pages). Allocation pops the smallest sufficient
+ * order and splits halves back down; freeing coalesces a block with its
+ * buddy (address XOR block size) as long as the buddy is also a free block
+ * of the same order, so fragmentation heals as allocations are returned.
+ *
+ * Free blocks carry their list metadata in their own first bytes -- the
+ * same intrusive trick the single-page free list used, extended with a
+ * prev pointer (O(1) unlink when a buddy is coalesced out of the middle
+ * of its list), the block's order and a magic word so a candidate buddy
+ * address can be validated without walking any list.
+ *
+ * The bitmap stays authoritative for per-page used/free and keeps serving
+ * is_page_free() debugging checks.
+ */
+struct buddy_block {
+    u32 next;   /* Address of next free block of this order (0 = end) */
+    u32 prev;   /* Address of previous free block (0 = list head) */
+    u32 order;
+    u32 magic;
+};
+
+#define BUDDY_MAGIC 0xB0DDB10C
+
+static void buddy_push(u32 addr, u32 order) {
+    struct buddy_block* blk = (struct buddy_block*)addr;
+    blk->next = mm.buddy_head[order];
+    blk->prev = 0;
+    blk->order = order;
+    blk->magic = BUDDY_MAGIC;
+    if (mm.buddy_head[order] != 0) {
+        ((struct buddy_block*)mm.buddy_head[order])->prev = addr;
+    }
+    mm.buddy_head[order] = addr;
+    mm.buddy_count[order]++;
+}
+
+static void buddy_unlink(struct buddy_block* blk) {
+    u32 order = blk->order;
+    if (blk->prev != 0) {
+        ((struct buddy_block*)blk->prev)->next = blk->next;
+    } else {
+        mm.buddy_head[order] = blk->next;
+    }
+    if (blk->next != 0) {
+        ((struct buddy_block*)blk->next)->prev = blk->prev;
+    }
+    blk->magic = 0;  /* Never mistake stale data for a free block */
+    mm.buddy_count[order]--;
+}
+
+/* Valid free block of `order` starting exactly at `addr`? The bitmap check
+ * filters allocated memory (whose contents we must not interpret); the
+ * magic + order check filters free pages that are interior to some other
+ * block. */
+static struct buddy_block* buddy_block_at(u32 addr, u32 order) {
+    u32 page = ADDR_TO_PAGE(addr);
+    if (page >= mm.total_pages || !is_page_free(page)) return NULL;
+
+    struct buddy_block* blk = (struct buddy_block*)addr;
+    if (blk->magic != BUDDY_MAGIC || blk->order != order) return NULL;
+    return blk;
+}
+
+/* Put a free block on its list, coalescing with free buddies first */
+static void buddy_free_block(u32 addr, u32 order) {
+    while (order < BUDDY_MAX_ORDER) {
+        u32 buddy_addr = addr ^ (u32)(PAGE_SIZE << order);
+        struct buddy_block* buddy = buddy_block_at(buddy_addr, order);
+        if (buddy == NULL) break;
+
+        buddy_unlink(buddy);
+        if (buddy_addr < addr) addr = buddy_addr;
+        order++;
+    }
+    buddy_push(addr, order);
+}
+
 void memory_init(struct multiboot_info* mboot_info) {
     kernel_printf("memory_init: Starting...\n");
 
@@ -53,6 +134,10 @@ void memory_init(struct multiboot_info* mboot_info) {
     mark_kernel_pages();
     kernel_printf("memory_init: mark_kernel_pages returned\n");
 
+    kernel_printf("memory_init: About to call init_buddy_allocator...\n");
+    init_buddy_allocator();
+    kernel_printf("memory_init: init_buddy_allocator returned\n");
+
     kernel_printf("memory_init: About to call memory_print_info...\n");
     memory_print_info();
     kernel_printf("memory_init: Completed successfully\n");
@@ -115,9 +200,66 @@ static void init_page_allocator(void) {
     mm.kernel_end = (u32)((u8*)mm.page_bitmap + (mm.bitmap_size * sizeof(u32)));
     kernel_printf("init_page_allocator: Updated kernel_end to: %u\n", mm.kernel_end);
 
+    /* Page frame database right after the bitmap: per-frame reference
+     * counts so frames can be shared (copy-on-write) and freed only when
+     * the last reference is dropped */
+    mm.page_frames = (struct page_frame*)mm.kernel_end;
+    memset(mm.page_frames, 0, mm.total_pages * sizeof(struct page_frame));
+    mm.kernel_end = (u32)((u8*)mm.page_frames + (mm.total_pages * sizeof(struct page_frame)));
+    kernel_printf("init_page_allocator: Frame database at %u, kernel_end now %u\n",
+                  (u32)mm.page_frames, mm.kernel_end);
+
+    /* Buddy free lists start empty; init_buddy_allocator() enrolls all
+     * free memory once the kernel pages are marked. Address 0 works as the
+     * empty sentinel because the first 1MB is always marked used. */
+    for (u32 order = 0; order <= BUDDY_MAX_ORDER; order++) {
+        mm.buddy_head[order] = 0;
+        mm.buddy_count[order] = 0;
+    }
+
     kernel_printf("init_page_allocator: Completed\n");
 }
 
+/* Enroll every free page run into the buddy lists as maximal naturally
+ * aligned power-of-two blocks. This walks the bitmap once at boot; only
+ * each block's header page is touched, not every page of memory. */
+static void init_buddy_allocator(void) {
+    u32 blocks = 0;
+    u32 page = 0;
+
+    while (page < mm.total_pages) {
+        if (!is_page_free(page)) {
+            page++;
+            continue;
+        }
+
+        /* Largest order this start address is aligned to and that fits
+         * in entirely free pages */
+        u32 order = 0;
+        while (order < BUDDY_MAX_ORDER) {
+            u32 size = 1U << (order + 1);
+            if ((page & (size - 1)) != 0 || page + size > mm.total_pages) break;
+
+            bool run_free = true;
+            for (u32 i = 1U << order; i < size; i++) {
+                if (!is_page_free(page + i)) {
+                    run_free = false;
+                    break;
+                }
+            }
+            if (!run_free) break;
+            order++;
+        }
+
+        buddy_push(PAGE_TO_ADDR(page), order);
+        blocks++;
+        page += 1U << order;
+    }
+
+    kernel_printf("  - Buddy allocator: %u free blocks enrolled (max order %u)\n",
+                  blocks, (u32)BUDDY_MAX_ORDER);
+}
+
 static void mark_kernel_pages(void) {
     u32 kernel_start_page = ADDR_TO_PAGE(mm.kernel_start);
     u32 kernel_end_page = ADDR_TO_PAGE(mm.kernel_end);
@@ -135,61 +277,114 @@ static void mark_kernel_pages(void) {
     }
 }
 
-u32 alloc_page(void) {
-    u32 page = find_free_pages(1);
-    if (page == (u32)-1) {
-        kernel_panic("Out of memory");
-        return 0;
+/* Smallest order whose block covers `count` pages, or (u32)-1 if too big */
+static u32 buddy_order_for(u32 count) {
+    for (u32 order = 0; order <= BUDDY_MAX_ORDER; order++) {
+        if ((1U << order) >= count) return order;
     }
+    return (u32)-1;
+}
 
-    mark_page_used(page);
-    mm.used_pages++;
-    mm.used_memory += PAGE_SIZE;
-
-    u32 addr = PAGE_TO_ADDR(page);
+u32 alloc_page(void) {
+    u32 addr = alloc_pages(1);
     memset((void*)addr, 0, PAGE_SIZE);
     return addr;
 }
 
 void free_page(u32 addr) {
-    if (addr == 0 || (addr & PAGE_MASK) != 0) return;
-    u32 page = ADDR_TO_PAGE(addr);
-    if (page >= mm.total_pages || !is_page_used(page)) return;
-
-    mark_page_free(page);
-    mm.used_pages--;
-    mm.used_memory -= PAGE_SIZE;
+    free_pages(addr, 1);
 }
 
+/*
+ * Contiguous allocation, O(log n): pop the smallest non-empty order that
+ * covers the request and push the unused halves back down the lists. The
+ * old path linearly searched the bitmap for `count` consecutive free bits
+ * and took them first-fit, which both scanned O(total_pages * count) and
+ * fragmented memory until multi-page requests failed outright.
+ *
+ * Requests are rounded up to a power of two; free_pages() applies the same
+ * rounding, so alloc/free pairs always agree on the block size.
+ */
 u32 alloc_pages(u32 count) {
     if (count == 0) return 0;
-    u32 start_page = find_free_pages(count);
-    if (start_page == (u32)-1) {
+
+    u32 order = buddy_order_for(count);
+    if (order == (u32)-1) {
         kernel_panic("Out of contiguous memory");
         return 0;
     }
 
-    for (u32 i = 0; i < count; i++) {
+    /* Smallest non-empty order that covers the request */
+    u32 have = order;
+    while (have <= BUDDY_MAX_ORDER && mm.buddy_head[have] == 0) {
+        have++;
+    }
+    if (have > BUDDY_MAX_ORDER) {
+        kernel_panic("Out of contiguous memory");
+        return 0;
+    }
+
+    u32 addr = mm.buddy_head[have];
+    buddy_unlink((struct buddy_block*)addr);
+
+    /* Split surplus halves back onto the lower lists */
+    while (have > order) {
+        have--;
+        buddy_push(addr + (u32)(PAGE_SIZE << have), have);
+    }
+
+    u32 pages = 1U << order;
+    u32 start_page = ADDR_TO_PAGE(addr);
+    for (u32 i = 0; i < pages; i++) {
         mark_page_used(start_page + i);
+        mm.page_frames[start_page + i].ref_count = 1;
+        mm.page_frames[start_page + i].flags = PAGE_FLAG_USED;
     }
-    mm.used_pages += count;
-    mm.used_memory += count * PAGE_SIZE;
-    return PAGE_TO_ADDR(start_page);
+    mm.used_pages += pages;
+    mm.used_memory += pages * PAGE_SIZE;
+    return addr;
 }
 
 void free_pages(u32 addr, u32 count) {
     if (addr == 0 || (addr & PAGE_MASK) != 0 || count == 0) return;
+
+    u32 order = buddy_order_for(count);
+    if (order == (u32)-1) return;
+    u32 pages = 1U << order;
     u32 start_page = ADDR_TO_PAGE(addr);
-    if (start_page + count > mm.total_pages) return;
-
-    for (u32 i = 0; i < count; i++) {
-        u32 page = start_page + i;
-        if (is_page_used(page)) {
-            mark_page_free(page);
-            mm.used_pages--;
-            mm.used_memory -= PAGE_SIZE;
-        }
+    if (start_page + pages > mm.total_pages) return;
+    if (!is_page_used(start_page)) return;  /* Double free */
+
+    /* A shared (copy-on-write) frame just drops one reference; the frame
+     * stays allocated until its last owner frees it */
+    if (pages == 1 && mm.page_frames[start_page].ref_count > 1) {
+        mm.page_frames[start_page].ref_count--;
+        return;
     }
+
+    for (u32 i = 0; i < pages; i++) {
+        mark_page_free(start_page + i);
+        mm.page_frames[start_page + i].ref_count = 0;
+        mm.page_frames[start_page + i].flags = 0;
+    }
+    mm.used_pages -= pages;
+    mm.used_memory -= pages * PAGE_SIZE;
+
+    /* Coalesce with free buddies and relist */
+    buddy_free_block(addr, order);
+}
+
+/* Per-frame reference counting for shared (copy-on-write) frames */
+void frame_ref_inc(u32 addr) {
+    u32 page = ADDR_TO_PAGE(addr);
+    if (page >= mm.total_pages) return;
+    mm.page_frames[page].ref_count++;
+}
+
+u32 frame_ref_count(u32 addr) {
+    u32 page = ADDR_TO_PAGE(addr);
+    if (page >= mm.total_pages) return 0;
+    return mm.page_frames[page].ref_count;
 }
 
 bool is_page_free(u32 page_num) {
@@ -245,6 +440,11 @@ void memory_print_info(void) {
     kernel_printf("Used Pages:   %u\n", mm.used_pages);
     kernel_printf("Free Pages:   %u\n", free_pages);
     kernel_printf("Kernel size:  %u KB\n", (mm.kernel_end - mm.kernel_start) / 1024);
+    kernel_printf("Buddy lists:  ");
+    for (u32 order = 0; order <= BUDDY_MAX_ORDER; order++) {
+        kernel_printf("%u ", mm.buddy_count[order]);
+    }
+    kernel_printf("(blocks per order 0-%u)\n", (u32)BUDDY_MAX_ORDER);
     kernel_printf("---------------------\n");
 }
 
@@ -9,6 +9,25 @@ extern void invalidate_page(u32 virtual_addr);
 static paging_manager_t paging_manager;
 static bool paging_enabled = false;
 
+/* デマンドページング対象のスタック予約領域 (kmallocで動的確保) */
+typedef struct stack_region {
+    u32 guard_base;             /* ガードページ先頭 (マップされない) */
+    u32 stack_top;              /* スタック最上位アドレス (排他) */
+    struct stack_region* next;
+} stack_region_t;
+
+static stack_region_t* stack_region_head = NULL;
+static u32 stack_region_next_base = STACK_REGION_BASE;
+
+/* CPUがPSE（4MBページ）に対応しているか確認（CPUID.1:EDX bit 3） */
+static bool cpu_has_pse(void) {
+    u32 eax, ebx, ecx, edx;
+    asm volatile("cpuid"
+                 : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx)
+                 : "a"(1));
+    return (edx & (1 << 3)) != 0;
+}
+
 void paging_init(void) {
     kernel_printf("paging_init: Initializing virtual memory system...\n");
 
@@ -103,13 +122,94 @@ page_directory_t* paging_create_directory(void) {
     return page_dir;
 }
 
+/* ページディレクトリをコピーオンライトで複製する。
+ * ディレクトリ/テーブル構造のみコピーし、物理フレームは親子で共有する。
+ * 書き込み可能だったページは両方で読み取り専用 + COWフラグ付きになり、
+ * どちらかが書き込んだ時点でpage_fault_handler()がそのページだけコピーする。
+ * 失敗時はNULLを返す */
+page_directory_t* paging_clone_directory(page_directory_t* src) {
+    if (!src) return NULL;
+
+    kernel_printf("paging_clone_directory: Cloning directory 0x%x\n", (u32)src);
+
+    page_directory_t* dst = paging_create_directory();
+    if (!dst) return NULL;
+
+    u32 shared_pages = 0;
+
+    for (int i = 0; i < PAGE_DIR_ENTRIES; i++) {
+        if (!src->entries[i].present) continue;
+
+        /* 4MBページ (カーネル恒等マッピング) はテーブルを持たないので
+         * エントリごと共有する。カーネル領域はCoW対象にしない */
+        if (src->entries[i].page_size) {
+            dst->entries[i] = src->entries[i];
+            continue;
+        }
+
+        /* ページテーブル自体は複製する (エントリの書き換えが相互に
+         * 影響しないように) */
+        u32 dst_table_physical = alloc_page();
+        if (dst_table_physical == 0) {
+            kernel_printf("paging_clone_directory: Failed to allocate page table\n");
+            paging_destroy_directory(dst);
+            return NULL;
+        }
+
+        page_table_t* src_table =
+            (page_table_t*)(src->entries[i].page_table_addr << 12);
+        page_table_t* dst_table = (page_table_t*)dst_table_physical;
+
+        for (int j = 0; j < PAGE_TABLE_ENTRIES; j++) {
+            dst_table->entries[j] = src_table->entries[j];
+            if (!src_table->entries[j].present) continue;
+
+            /* 書き込み可能ページは両者で読み取り専用に落とし、
+             * COWフラグを立てて共有する。既にCOW共有中のページは
+             * 参照を1つ増やすだけでよい */
+            if (src_table->entries[j].writable) {
+                src_table->entries[j].writable = 0;
+                src_table->entries[j].available |= PAGE_AVAIL_COW;
+                dst_table->entries[j].writable = 0;
+                dst_table->entries[j].available |= PAGE_AVAIL_COW;
+            }
+            if (src_table->entries[j].available & PAGE_AVAIL_COW) {
+                frame_ref_inc(src_table->entries[j].page_frame_addr << 12);
+                shared_pages++;
+            }
+        }
+
+        dst->entries[i] = src->entries[i];
+        dst->entries[i].page_table_addr = dst_table_physical >> 12;
+    }
+
+    /* 親側のページを読み取り専用化したのでTLBを捨てる */
+    if (paging_enabled && paging_manager.current_page_dir == src) {
+        flush_tlb();
+    }
+
+    kernel_printf("paging_clone_directory: Cloned 0x%x -> 0x%x (%u pages shared)\n",
+                  (u32)src, (u32)dst, shared_pages);
+    return dst;
+}
+
 void paging_destroy_directory(page_directory_t* dir) {
     if (!dir) return;
 
-    /* ページテーブルの解放 */
+    /* ページテーブルの解放（4MBページエントリはテーブルを持たないのでスキップ） */
     for (int i = 0; i < PAGE_DIR_ENTRIES; i++) {
-        if (dir->entries[i].present) {
+        if (dir->entries[i].present && !dir->entries[i].page_size) {
             u32 page_table_addr = dir->entries[i].page_table_addr << 12;
+
+            /* CoW共有中のフレームへの参照を返す (最後の参照で実際に解放) */
+            page_table_t* page_table = (page_table_t*)page_table_addr;
+            for (int j = 0; j < PAGE_TABLE_ENTRIES; j++) {
+                if (page_table->entries[j].present &&
+                    (page_table->entries[j].available & PAGE_AVAIL_COW)) {
+                    free_page(page_table->entries[j].page_frame_addr << 12);
+                }
+            }
+
             free_page(page_table_addr);
         }
     }
@@ -184,6 +284,40 @@ int paging_map_page(u32 virtual_addr, u32 physical_addr, u32 flags) {
     return 0;
 }
 
+int paging_map_large_page(u32 virtual_addr, u32 physical_addr, u32 flags) {
+    /* アドレスを4MB境界に合わせる */
+    virtual_addr &= LARGE_PAGE_MASK;
+    physical_addr &= LARGE_PAGE_MASK;
+
+    u32 page_dir_index = get_page_directory_index(virtual_addr);
+    page_directory_t* page_dir = paging_manager.current_page_dir;
+
+    /* 既に4KBページテーブルが存在する場合は上書きしない */
+    if (page_dir->entries[page_dir_index].present &&
+        !page_dir->entries[page_dir_index].page_size) {
+        kernel_printf("paging_map_large_page: 4KB table already present at 0x%x\n",
+                      virtual_addr);
+        return -1;
+    }
+
+    /* ページディレクトリエントリを4MBページとして設定 */
+    /* (4MBエントリでは上位20bitフィールドに物理アドレスのbit 31:22が入り、
+       bit 21:12相当は4MB境界合わせにより0になる) */
+    page_dir->entries[page_dir_index].page_table_addr = physical_addr >> 12;
+    page_dir->entries[page_dir_index].page_size = 1;
+    page_dir->entries[page_dir_index].present = (flags & PAGE_PRESENT) ? 1 : 0;
+    page_dir->entries[page_dir_index].writable = (flags & PAGE_WRITABLE) ? 1 : 0;
+    page_dir->entries[page_dir_index].user = (flags & PAGE_USER) ? 1 : 0;
+
+    /* TLBエントリを無効化 */
+    if (paging_enabled) {
+        invalidate_page(virtual_addr);
+    }
+
+    paging_manager.total_mapped_pages += LARGE_PAGE_SIZE / PAGE_SIZE;
+    return 0;
+}
+
 int paging_unmap_page(u32 virtual_addr) {
     virtual_addr = page_align_down(virtual_addr);
 
@@ -226,6 +360,13 @@ u32 paging_get_physical_addr(u32 virtual_addr) {
         return 0; /* ページテーブルが存在しない */
     }
 
+    /* 4MBページはディレクトリエントリで直接解決する */
+    if (page_dir->entries[page_dir_index].page_size) {
+        u32 large_page_base = (page_dir->entries[page_dir_index].page_table_addr << 12)
+                              & LARGE_PAGE_MASK;
+        return large_page_base + (virtual_addr & LARGE_PAGE_OFFSET);
+    }
+
     u32 page_table_addr = page_dir->entries[page_dir_index].page_table_addr << 12;
     page_table_t* page_table = (page_table_t*)page_table_addr;
 
@@ -240,10 +381,45 @@ u32 paging_get_physical_addr(u32 virtual_addr) {
 void paging_identity_map_kernel(void) {
     kernel_printf("paging_identity_map_kernel: Setting up kernel identity mapping...\n");
 
-    /* カーネル領域（最初の4MB）を恒等マッピング */
-    /* 0x00000000 - 0x00400000 をそのままマッピング */
+    /* アロケータが管理する物理メモリ全域を恒等マッピングする。
+       カーネルはページテーブルもalloc_page()のフレームも物理アドレスの
+       ままアクセスするので、先頭4MBだけではページング有効化後に
+       アロケータが返すフレームに触れなくなる。
+       上限はSTACK_REGION_BASE: そこから先の仮想アドレスはデマンド
+       ページングのスタック窓として予約されており、恒等マッピングと
+       重ねてはいけない */
+    u32 ram_end = get_total_pages() * PAGE_SIZE;
+    if (ram_end > STACK_REGION_BASE) {
+        ram_end = STACK_REGION_BASE;
+    }
+
+    /* カーネル・VGA・アロケータ領域はすべて同一権限（カーネルRW）の静的な
+       範囲なので、PSE対応CPUでは4MBページでマッピングする。4KBテーブル
+       1024エントリ分のTLBエントリとalloc_page()呼び出しを4MBごとに
+       節約できる。 */
+    if (cpu_has_pse()) {
+        kernel_printf("paging_identity_map_kernel: PSE supported, using 4MB pages\n");
+        write_cr4(read_cr4() | CR4_PSE);
+
+        u32 large_pages = 0;
+        for (u32 addr = 0; addr < ram_end; addr += LARGE_PAGE_SIZE) {
+            int result = paging_map_large_page(addr, addr, PAGE_PRESENT | PAGE_WRITABLE);
+            if (result != 0) {
+                kernel_printf("paging_identity_map_kernel: Failed to map 4MB page at 0x%x\n",
+                              addr);
+                kernel_panic("Kernel identity mapping failed");
+            }
+            large_pages++;
+        }
+
+        kernel_printf("paging_identity_map_kernel: Mapped %u MB with %u large pages\n",
+                      ram_end / (1024 * 1024), large_pages);
+        return;
+    }
 
-    for (u32 addr = 0; addr < 0x400000; addr += PAGE_SIZE) {
+    /* PSE非対応CPUでは従来どおり4KBページでマッピング */
+    kernel_printf("paging_identity_map_kernel: PSE not supported, using 4KB pages\n");
+    for (u32 addr = 0; addr < ram_end; addr += PAGE_SIZE) {
         int result = paging_map_page(addr, addr, PAGE_PRESENT | PAGE_WRITABLE);
         if (result != 0) {
             kernel_printf("paging_identity_map_kernel: Failed to map 0x%x\n", addr);
@@ -252,13 +428,190 @@ void paging_identity_map_kernel(void) {
     }
 
     kernel_printf("paging_identity_map_kernel: Mapped %u pages for kernel\n",
-                  0x400000 / PAGE_SIZE);
+                  ram_end / PAGE_SIZE);
+}
+
+bool paging_is_enabled(void) {
+    return paging_enabled;
+}
+
+/* プロセススタック用の仮想領域を予約する (物理ページはまだ割り当てない)。
+ * レイアウトは [ガードページ1枚][スタックページ群] で、ガードページは
+ * 決してマップされないため、スタックオーバーフローは即ページフォルトになる。
+ * 戻り値はスタック最上位アドレス、領域枯渇時は0 */
+u32 paging_reserve_stack(u32 stack_size) {
+    stack_size = page_align_up(stack_size);
+
+    u32 total = PAGE_SIZE + stack_size;  /* ガードページ + スタック */
+    if (stack_region_next_base + total > STACK_REGION_END) {
+        kernel_printf("paging_reserve_stack: Stack region exhausted\n");
+        return 0;
+    }
+
+    stack_region_t* region = (stack_region_t*)kmalloc(sizeof(stack_region_t));
+    if (region == NULL) {
+        kernel_printf("paging_reserve_stack: Failed to allocate region record\n");
+        return 0;
+    }
+
+    region->guard_base = stack_region_next_base;
+    region->stack_top = stack_region_next_base + total;
+    region->next = stack_region_head;
+    stack_region_head = region;
+
+    stack_region_next_base = region->stack_top;
+
+    kernel_printf("paging_reserve_stack: Reserved 0x%x - 0x%x (guard at 0x%x)\n",
+                  region->guard_base + PAGE_SIZE, region->stack_top,
+                  region->guard_base);
+
+    return region->stack_top;
+}
+
+/* 予約済みスタック領域を解放する。フォルトで実体化されたページだけを
+ * 物理ページアロケータに返す (触られなかったページはコストゼロ) */
+void paging_release_stack(u32 stack_top, u32 stack_size) {
+    stack_size = page_align_up(stack_size);
+
+    stack_region_t** link = &stack_region_head;
+    while (*link != NULL && (*link)->stack_top != stack_top) {
+        link = &(*link)->next;
+    }
+
+    stack_region_t* region = *link;
+    if (region == NULL) {
+        kernel_printf("paging_release_stack: No region for top 0x%x\n", stack_top);
+        return;
+    }
+
+    /* 実体化済みのページのみ解放 */
+    u32 released = 0;
+    for (u32 addr = stack_top - stack_size; addr < stack_top; addr += PAGE_SIZE) {
+        u32 physical = paging_get_physical_addr(addr);
+        if (physical != 0) {
+            paging_unmap_page(addr);
+            free_page(physical);
+            released++;
+        }
+    }
+
+    *link = region->next;
+    kfree(region);
+
+    kernel_printf("paging_release_stack: Released %u resident pages (top=0x%x)\n",
+                  released, stack_top);
+}
+
+/* フォルトアドレスが予約済みスタック内なら物理ページを実体化する。
+ * 戻り値: 0=実体化成功, -1=スタック範囲外, -2=ガードページ (オーバーフロー) */
+static int demand_page_stack(u32 fault_addr) {
+    for (stack_region_t* region = stack_region_head; region != NULL;
+         region = region->next) {
+        if (fault_addr < region->guard_base || fault_addr >= region->stack_top) {
+            continue;
+        }
+
+        /* ガードページへのアクセスはスタックオーバーフロー */
+        if (fault_addr < region->guard_base + PAGE_SIZE) {
+            return -2;
+        }
+
+        /* 触られたページだけを物理メモリに実体化する */
+        u32 physical = alloc_page();
+        if (physical == 0) {
+            kernel_printf("demand_page_stack: Out of physical memory\n");
+            return -1;  /* 通常のフォルト処理 (パニック) に委ねる */
+        }
+
+        if (paging_map_page(fault_addr, physical, PAGE_PRESENT | PAGE_WRITABLE) != 0) {
+            free_page(physical);
+            return -1;
+        }
+
+        kernel_printf("demand_page_stack: Materialized stack page 0x%x\n",
+                      page_align_down(fault_addr));
+        return 0;
+    }
+
+    return -1;
+}
+
+/* COW共有ページへの書き込みフォルトを解決する。
+ * 他にも参照があればページをコピーして自分用のフレームに差し替え、
+ * 最後の参照なら読み取り専用化を解くだけでよい (コピー不要)。
+ * 戻り値: 0=解決, -1=COW対象外 */
+static int resolve_cow_fault(u32 fault_addr) {
+    u32 page_dir_index = get_page_directory_index(fault_addr);
+    u32 page_table_index = get_page_table_index(fault_addr);
+
+    page_directory_t* page_dir = paging_manager.current_page_dir;
+
+    if (!page_dir->entries[page_dir_index].present ||
+        page_dir->entries[page_dir_index].page_size) {
+        return -1;
+    }
+
+    page_table_t* page_table =
+        (page_table_t*)(page_dir->entries[page_dir_index].page_table_addr << 12);
+    page_table_entry_t* entry = &page_table->entries[page_table_index];
+
+    if (!entry->present || !(entry->available & PAGE_AVAIL_COW)) {
+        return -1;
+    }
+
+    u32 old_frame = entry->page_frame_addr << 12;
+
+    if (frame_ref_count(old_frame) > 1) {
+        /* 共有中: 触られたこのページだけをコピーする */
+        u32 new_frame = alloc_page();
+        if (new_frame == 0) {
+            kernel_printf("resolve_cow_fault: Out of physical memory\n");
+            return -1;
+        }
+        memcpy((void*)new_frame, (void*)old_frame, PAGE_SIZE);
+        free_page(old_frame);  /* 参照を1つ返す */
+        entry->page_frame_addr = new_frame >> 12;
+        kernel_printf("resolve_cow_fault: Copied page 0x%x (frame 0x%x -> 0x%x)\n",
+                      page_align_down(fault_addr), old_frame, new_frame);
+    } else {
+        /* 最後の参照: 書き込み可能に戻すだけ */
+        kernel_printf("resolve_cow_fault: Last reference, re-enabling write at 0x%x\n",
+                      page_align_down(fault_addr));
+    }
+
+    entry->writable = 1;
+    entry->available &= ~PAGE_AVAIL_COW;
+
+    if (paging_enabled) {
+        invalidate_page(fault_addr);
+    }
+    return 0;
 }
 
 void page_fault_handler(interrupt_frame_t* frame) {
     u32 fault_addr = read_cr2();
     u32 error_code = frame->err_code;
 
+    /* 存在するページへの書き込み保護違反はCOWの可能性がある */
+    if ((error_code & 0x3) == 0x3) {
+        if (resolve_cow_fault(fault_addr) == 0) {
+            return;  /* 解決済み、フォルト命令を再実行 */
+        }
+    }
+
+    /* 存在しないページへのフォルトはまずスタックのデマンドページングを試す */
+    if ((error_code & 0x1) == 0) {
+        int result = demand_page_stack(fault_addr);
+        if (result == 0) {
+            return;  /* 実体化成功、フォルト命令を再実行 */
+        }
+        if (result == -2) {
+            kernel_printf("page_fault_handler: Stack overflow (guard page hit) at 0x%x\n",
+                          fault_addr);
+            kernel_panic("Process stack overflow");
+        }
+    }
+
     kernel_printf("\n=====================================\n");
     kernel_printf("        PAGE FAULT OCCURRED\n");
     kernel_printf("=====================================\n");
@@ -316,4 +669,63 @@ void paging_print_info(void) {
         kernel_printf("CR3: 0x%x\n", read_cr3());
     }
     kernel_printf("---------------------\n");
+}
+
+/* CoWの動作確認 (cowtestコマンド)。
+ * 書き込み可能なテストページを1枚マップしてディレクトリを複製し、
+ * CR0.WP下の書き込み保護フォルト→resolve_cow_fault()で触ったページ
+ * だけがコピーされることを確認する */
+void paging_cow_test(void) {
+    if (!paging_enabled) {
+        kernel_printf("paging_cow_test: Paging is disabled, nothing to test\n");
+        return;
+    }
+
+    /* 1. 恒等マッピングの外の空き仮想アドレスにテストページをマップ */
+    u32 test_virt = STACK_REGION_END;  /* 512MB: スタック予約領域の直後 */
+    u32 test_frame = alloc_page();
+    if (test_frame == 0) {
+        kernel_printf("paging_cow_test: Failed to allocate test page\n");
+        return;
+    }
+    if (paging_map_page(test_virt, test_frame, PAGE_PRESENT | PAGE_WRITABLE) != 0) {
+        free_page(test_frame);
+        kernel_printf("paging_cow_test: Failed to map test page\n");
+        return;
+    }
+
+    volatile u32* test_ptr = (volatile u32*)test_virt;
+    *test_ptr = 0xAAAA5555;
+
+    /* 2. 複製: テストページは両ディレクトリで読み取り専用 + COWになる */
+    page_directory_t* clone = paging_clone_directory(paging_manager.current_page_dir);
+    if (!clone) {
+        paging_unmap_page(test_virt);
+        free_page(test_frame);
+        kernel_printf("paging_cow_test: Clone failed\n");
+        return;
+    }
+    kernel_printf("paging_cow_test: Frame 0x%x ref count after clone: %u\n",
+                  test_frame, frame_ref_count(test_frame));
+
+    /* 3. 書き込み: CR0.WPによりカーネルでも保護フォルトが起き、
+     *    resolve_cow_fault()がこのページだけコピーする */
+    *test_ptr = 0x5555AAAA;
+
+    /* 4. 検証: 自分は新フレームの新しい値、共有フレームは古い値のまま */
+    u32 new_frame = paging_get_physical_addr(test_virt) & PAGING_PAGE_MASK;
+    u32 shared_value = *(volatile u32*)test_frame;  /* クローン側が保持 */
+    if (new_frame != test_frame && *test_ptr == 0x5555AAAA &&
+        shared_value == 0xAAAA5555) {
+        kernel_printf("paging_cow_test: PASS (copied frame 0x%x -> 0x%x)\n",
+                      test_frame, new_frame);
+    } else {
+        kernel_printf("paging_cow_test: FAIL (frame 0x%x -> 0x%x, values 0x%x / 0x%x)\n",
+                      test_frame, new_frame, *test_ptr, shared_value);
+    }
+
+    /* 5. 後始末: クローン破棄で共有フレームの参照が返り、実体も解放される */
+    paging_destroy_directory(clone);
+    paging_unmap_page(test_virt);
+    free_page(new_frame);
 }
\ No newline at end of file
@@ -14,14 +14,16 @@ load_page_directory:
     pop ebp
     ret
 
-; ページングを有効化（CR0のPGビットを設定）
+; ページングを有効化（CR0のPGビットとWPビットを設定）
+; WPがないとCPL0の書き込みは読み取り専用ページでもフォルトせず、
+; CoW共有中のフレームを黙って書き換えてしまう
 global enable_paging
 enable_paging:
     push ebp
     mov ebp, esp
 
     mov eax, cr0
-    or eax, 0x80000000      ; PGビット（bit 31）を設定
+    or eax, 0x80010000      ; PGビット（bit 31）とWPビット（bit 16）を設定
     mov cr0, eax
 
     pop ebp
@@ -70,6 +72,24 @@ read_cr3:
     mov eax, cr3
     ret
 
+; CR4レジスタの値を読み取り
+global read_cr4
+read_cr4:
+    mov eax, cr4
+    ret
+
+; CR4レジスタに値を書き込み（PSEビット等の設定用）
+global write_cr4
+write_cr4:
+    push ebp
+    mov ebp, esp
+
+    mov eax, [esp + 8]      ; 第1引数: 新しいCR4の値
+    mov cr4, eax
+
+    pop ebp
+    ret
+
 ; CR3レジスタに値を書き込み
 global write_cr3
 write_cr3:
@@ -1,10 +1,14 @@
 #include "process.h"
 #include "memory.h"
+#include "paging.h"
+#include "timer.h"
 #include "kernel.h"
 
 /* 前方宣言 */
 static void daemon_init(void);
+static void daemon_timer_expired(ktimer_t* timer, void* arg);
 static void daemon_execute_task(process_t* daemon);
+static void wait_queue_unlink(wait_queue_t* queue, process_t* process);
 static const char* daemon_type_to_string(daemon_type_t type);
 static void daemon_system_monitor_task(void);
 static void daemon_log_cleaner_task(void);
@@ -13,9 +17,8 @@ static void daemon_heartbeat_task(void);
 /* グローバルスケジューラ */
 static scheduler_t scheduler;
 
-/* プロセステーブル */
-static process_t process_table[MAX_PROCESSES];
-static bool process_table_used[MAX_PROCESSES];
+/* 全プロセスリスト (一覧表示・デーモン走査用、双方向リスト) */
+static process_t* all_process_head = NULL;
 
 /* プロセス管理初期化 */
 void process_init(void) {
@@ -25,7 +28,8 @@ void process_init(void) {
     kernel_printf("process_init: Step 1 - Basic initialization\n");
 
     // まずは静的変数への直接アクセスをテスト
-    scheduler.ready_queue = NULL;
+    scheduler.ready_head = NULL;
+    scheduler.ready_tail = NULL;
     kernel_printf("process_init: Step 2 - Scheduler basic setup\n");
 
     scheduler.current_process = NULL;
@@ -35,10 +39,8 @@ void process_init(void) {
 
     kernel_printf("process_init: Step 3 - Scheduler initialized\n");
 
-    // プロセステーブルの初期化は後回し
-    for (int i = 0; i < MAX_PROCESSES; i++) {
-        process_table_used[i] = false;
-    }
+    /* PCBはkmallocで都度確保するため、テーブルの事前初期化は不要 */
+    all_process_head = NULL;
 
     kernel_printf("process_init: Completed successfully\n");
 
@@ -79,7 +81,8 @@ static void daemon_init(void) {
 void scheduler_init(void) {
     kernel_printf("scheduler_init: Initializing scheduler...\n");
 
-    scheduler.ready_queue = NULL;
+    scheduler.ready_head = NULL;
+    scheduler.ready_tail = NULL;
     scheduler.current_process = NULL;
     scheduler.next_pid = 1;  /* PID 0はアイドルプロセス用 */
     scheduler.process_count = 0;
@@ -88,36 +91,49 @@ void scheduler_init(void) {
     kernel_printf("scheduler_init: Scheduler initialized\n");
 }
 
-/* 空いているプロセステーブルエントリを検索 */
+/* PCBをカーネルヒープから確保し、全プロセスリストに繋ぐ */
 static process_t* allocate_process_entry(void) {
-    for (int i = 0; i < MAX_PROCESSES; i++) {
-        if (!process_table_used[i]) {
-            process_table_used[i] = true;
-            return &process_table[i];
-        }
+    process_t* process = (process_t*)kmalloc(sizeof(process_t));
+    if (process == NULL) {
+        return NULL;
     }
-    return NULL;
+    memset(process, 0, sizeof(process_t));
+
+    /* 全プロセスリストの先頭に追加 */
+    process->all_next = all_process_head;
+    process->all_prev = NULL;
+    if (all_process_head != NULL) {
+        all_process_head->all_prev = process;
+    }
+    all_process_head = process;
+
+    return process;
 }
 
-/* プロセステーブルエントリを解放 */
+/* PCBを全プロセスリストから外して解放 */
 static void free_process_entry(process_t* process) {
     if (process == NULL) return;
 
-    int index = process - process_table;
-    if (index >= 0 && index < MAX_PROCESSES) {
-        process_table_used[index] = false;
-        memset(process, 0, sizeof(process_t));
+    if (process->all_prev != NULL) {
+        process->all_prev->all_next = process->all_next;
+    } else {
+        all_process_head = process->all_next;
     }
+    if (process->all_next != NULL) {
+        process->all_next->all_prev = process->all_prev;
+    }
+
+    kfree(process);
 }
 
 /* プロセス作成 */
 process_t* process_create(const char* name, void* entry_point, u32 stack_size) {
     kernel_printf("process_create: Creating process '%s'\n", name);
 
-    /* プロセステーブルエントリ確保 */
+    /* PCB確保 */
     process_t* process = allocate_process_entry();
     if (process == NULL) {
-        kernel_printf("process_create: ERROR - No free process entries\n");
+        kernel_printf("process_create: ERROR - Cannot allocate PCB\n");
         return NULL;
     }
 
@@ -131,28 +147,50 @@ process_t* process_create(const char* name, void* entry_point, u32 stack_size) {
     /* 初期状態設定 */
     process->state = PROCESS_READY;
 
+    /* 受信メッセージリング確保 (受信側所有、送信者が直接書き込む) */
+    process->msg_queue.ring = (u8*)kmalloc(MSG_RING_ENTRIES * MSG_SIZE);
+    if (process->msg_queue.ring == NULL) {
+        kernel_printf("process_create: ERROR - Cannot allocate message ring\n");
+        free_process_entry(process);
+        return NULL;
+    }
+    process->msg_queue.read = 0;
+    process->msg_queue.write = 0;
+    wait_queue_init(&process->msg_queue.readers);
+
     /* スタック確保 */
     if (stack_size == 0) {
         stack_size = DEFAULT_STACK_SIZE;
     }
 
-    /* スタック用メモリをページアロケータから確保 */
     u32 stack_pages = (stack_size + PAGE_SIZE - 1) / PAGE_SIZE;
-    u32 stack_physical = 0;
 
-    for (u32 i = 0; i < stack_pages; i++) {
-        u32 page = alloc_page();
-        if (page == 0) {
-            kernel_printf("process_create: ERROR - Cannot allocate stack memory\n");
+    if (paging_is_enabled()) {
+        /* ページング有効時は仮想領域の予約のみ。物理ページはページフォルトで
+         * 触られたページだけが実体化され、最下位のガードページが
+         * オーバーフローを検出する */
+        u32 stack_top = paging_reserve_stack(stack_pages * PAGE_SIZE);
+        if (stack_top == 0) {
+            kernel_printf("process_create: ERROR - Cannot reserve stack region\n");
+            kfree(process->msg_queue.ring);
             free_process_entry(process);
             return NULL;
         }
-        if (i == 0) {
-            stack_physical = page;
+        process->stack_top = stack_top;
+        process->stack_virtual = true;
+    } else {
+        /* ページング無効時は従来どおり物理メモリを連続確保する */
+        u32 stack_physical = alloc_pages(stack_pages);
+        if (stack_physical == 0) {
+            kernel_printf("process_create: ERROR - Cannot allocate stack memory\n");
+            kfree(process->msg_queue.ring);
+            free_process_entry(process);
+            return NULL;
         }
+        process->stack_top = stack_physical + (stack_pages * PAGE_SIZE);
+        process->stack_virtual = false;
     }
 
-    process->stack_top = stack_physical + (stack_pages * PAGE_SIZE);
     process->stack_size = stack_pages * PAGE_SIZE;
 
     /* CPUコンテキスト初期化 */
@@ -175,6 +213,12 @@ process_t* process_create(const char* name, void* entry_point, u32 stack_size) {
     process->time_slice = scheduler.time_quantum;
     process->remaining_time = process->time_slice;
     process->next = NULL;
+    process->prev = NULL;
+
+    /* CPU使用量統計初期化 (カウンタ類はmemsetで0済み) */
+    extern u32 get_system_ticks(void);
+    process->created_ticks = get_system_ticks();
+    process->last_scheduled = 0;  /* 0 = 未スケジュール */
 
     /* デーモンフィールド初期化 */
     process->is_daemon = false;
@@ -208,14 +252,28 @@ void process_destroy(process_t* process) {
     /* スケジューラから削除 */
     scheduler_remove_process(process);
 
-    /* スタックメモリ解放 */
-    u32 stack_pages = process->stack_size / PAGE_SIZE;
-    u32 stack_base = process->stack_top - process->stack_size;
+    /* タイマーホイールに残った発火予定を取り下げる (PCB解放後の発火防止) */
+    timer_cancel(&process->daemon_timer);
+    timer_cancel(&process->sleep_timer);
+
+    /* ウェイトキューで待機中ならそこからも外す */
+    if (process->waiting_on != NULL) {
+        wait_queue_unlink(process->waiting_on, process);
+    }
 
-    for (u32 i = 0; i < stack_pages; i++) {
-        free_page(stack_base + (i * PAGE_SIZE));
+    /* スタックメモリ解放 */
+    if (process->stack_virtual) {
+        /* 実体化済みページのみ解放される */
+        paging_release_stack(process->stack_top, process->stack_size);
+    } else {
+        u32 stack_pages = process->stack_size / PAGE_SIZE;
+        u32 stack_base = process->stack_top - process->stack_size;
+        free_pages(stack_base, stack_pages);
     }
 
+    /* 受信メッセージリング解放 */
+    kfree(process->msg_queue.ring);
+
     /* プロセス数更新 */
     scheduler.process_count--;
 
@@ -223,6 +281,85 @@ void process_destroy(process_t* process) {
     free_process_entry(process);
 }
 
+/* 実行中プロセスを返す (割り込み文脈・起動中はNULL) */
+process_t* process_get_current(void) {
+    return scheduler.current_process;
+}
+
+/* PIDからプロセスを検索 (NULL = 該当なし) */
+process_t* process_find_by_pid(u32 pid) {
+    for (process_t* proc = all_process_head; proc != NULL; proc = proc->all_next) {
+        if (proc->pid == pid) {
+            return proc;
+        }
+    }
+    return NULL;
+}
+
+/* メッセージ送信: MSG_SIZE分を受信者所有のリングへ直接コピーする。
+ * 中間バッファを経由しないため、コピーはこの1回だけ。
+ * 戻り値: 0=成功, -1=宛先なし, -2=リング満杯 */
+int msg_send(u32 pid, const void* buf) {
+    if (buf == NULL) return -1;
+
+    process_t* receiver = process_find_by_pid(pid);
+    if (receiver == NULL || receiver->state == PROCESS_TERMINATED) {
+        kernel_printf("msg_send: No process with PID=%u\n", pid);
+        return -1;
+    }
+
+    msg_queue_t* queue = &receiver->msg_queue;
+
+    /* リング満杯時は落とさずエラーを返す (送信側がリトライを判断する) */
+    if (queue->write - queue->read >= MSG_RING_ENTRIES) {
+        kernel_printf("msg_send: Ring full for PID=%u\n", pid);
+        return -2;
+    }
+
+    u32 slot = queue->write % MSG_RING_ENTRIES;
+    memcpy(queue->ring + slot * MSG_SIZE, buf, MSG_SIZE);
+    queue->write++;
+
+    /* 受信待ちのプロセスを起こす */
+    wait_queue_wake_one(&queue->readers);
+    return 0;
+}
+
+/* 非ブロック受信: リングからMSG_SIZE分を取り出す。
+ * デーモンのようにスケジュール文脈を持たない受信者が使う。
+ * 戻り値: 0=受信, -1=キュー空または引数不正 */
+int msg_try_recv(process_t* process, void* buf) {
+    if (process == NULL || buf == NULL) return -1;
+
+    msg_queue_t* queue = &process->msg_queue;
+
+    if (queue->read == queue->write) {
+        return -1;  /* キュー空 */
+    }
+
+    u32 slot = queue->read % MSG_RING_ENTRIES;
+    memcpy(buf, queue->ring + slot * MSG_SIZE, MSG_SIZE);
+    queue->read++;
+    return 0;
+}
+
+/* ブロッキング受信: 現在のプロセス宛のメッセージを受信する。
+ * キューが空の間はreadersウェイトキューで待ち、msg_send()が起こす。
+ * 戻り値: 0=受信, -1=プロセス文脈外 */
+int msg_recv(void* buf) {
+    process_t* proc = process_get_current();
+    if (proc == NULL) {
+        kernel_printf("msg_recv: ERROR - No current process\n");
+        return -1;
+    }
+
+    while (msg_try_recv(proc, buf) != 0) {
+        wait_queue_block(&proc->msg_queue.readers, proc);
+        scheduler_switch_process();
+    }
+    return 0;
+}
+
 /* プロセス状態変更 */
 void process_set_state(process_t* process, process_state_t new_state) {
     if (process == NULL) return;
@@ -241,67 +378,78 @@ void scheduler_add_process(process_t* process) {
     kernel_printf("scheduler_add_process: Adding process '%s' to ready queue\n",
                   process->name);
 
-    /* レディキューに追加 (単純な連結リスト) */
+    /* レディキュー末尾に追加 (双方向リストなのでO(1)) */
     process->next = NULL;
+    process->prev = scheduler.ready_tail;
 
-    if (scheduler.ready_queue == NULL) {
-        scheduler.ready_queue = process;
+    if (scheduler.ready_tail != NULL) {
+        scheduler.ready_tail->next = process;
     } else {
-        process_t* current = scheduler.ready_queue;
-        while (current->next != NULL) {
-            current = current->next;
-        }
-        current->next = process;
+        scheduler.ready_head = process;
     }
+    scheduler.ready_tail = process;
 
     process_set_state(process, PROCESS_READY);
 }
 
 /* スケジューラ: プロセス削除 */
 void scheduler_remove_process(process_t* process) {
-    if (process == NULL || scheduler.ready_queue == NULL) return;
+    if (process == NULL) return;
+
+    /* キューに入っていないプロセスは何もしない */
+    if (process->prev == NULL && process->next == NULL &&
+        scheduler.ready_head != process) {
+        return;
+    }
 
     kernel_printf("scheduler_remove_process: Removing process '%s' from ready queue\n",
                   process->name);
 
-    /* レディキューから削除 */
-    if (scheduler.ready_queue == process) {
-        scheduler.ready_queue = process->next;
+    /* レディキューから削除 (双方向リストなのでO(1)) */
+    if (process->prev != NULL) {
+        process->prev->next = process->next;
     } else {
-        process_t* current = scheduler.ready_queue;
-        while (current->next != NULL && current->next != process) {
-            current = current->next;
-        }
-        if (current->next == process) {
-            current->next = process->next;
-        }
+        scheduler.ready_head = process->next;
+    }
+    if (process->next != NULL) {
+        process->next->prev = process->prev;
+    } else {
+        scheduler.ready_tail = process->prev;
     }
 
     process->next = NULL;
+    process->prev = NULL;
 }
 
 /* スケジューラ: 次のプロセス取得 (Round Robin) */
 process_t* scheduler_get_next_process(void) {
-    if (scheduler.ready_queue == NULL) {
+    /* レディキューにはPROCESS_READYのプロセスしか載らない。
+     * スリープ/待機中のPCBはwait_queue_block/process_sleepで
+     * キューから外れているため、ここでスキップ走査は発生しない */
+    if (scheduler.ready_head == NULL) {
         return NULL;
     }
 
-    /* Round Robin: 先頭のプロセスを取得し、後ろに移動 */
-    process_t* next_process = scheduler.ready_queue;
-    scheduler.ready_queue = next_process->next;
+    /* Round Robin: 先頭のプロセスを取り出し、末尾に繋ぎ直す。
+     * 先頭・末尾ポインタを持つのでプロセス数に関係なくO(1) */
+    process_t* next_process = scheduler.ready_head;
 
-    /* 取得したプロセスをキューの最後に移動 */
-    if (scheduler.ready_queue != NULL) {
-        process_t* current = scheduler.ready_queue;
-        while (current->next != NULL) {
-            current = current->next;
-        }
-        current->next = next_process;
-        next_process->next = NULL;
-    } else {
-        scheduler.ready_queue = next_process;
+    if (next_process->next != NULL) {
+        /* 先頭から外す */
+        scheduler.ready_head = next_process->next;
+        scheduler.ready_head->prev = NULL;
+
+        /* 末尾に追加 */
         next_process->next = NULL;
+        next_process->prev = scheduler.ready_tail;
+        scheduler.ready_tail->next = next_process;
+        scheduler.ready_tail = next_process;
     }
+    /* キューに1つしかない場合はそのまま返す */
+
+    /* スケジュール時刻を記録 (topのlast-scheduled表示用) */
+    extern u32 get_system_ticks(void);
+    next_process->last_scheduled = get_system_ticks();
 
     return next_process;
 }
@@ -329,17 +477,45 @@ void process_list_all(void) {
     kernel_printf("PID  | Name              | State | Stack\n");
     kernel_printf("-----|-------------------|-------|--------\n");
 
-    for (int i = 0; i < MAX_PROCESSES; i++) {
-        if (process_table_used[i]) {
-            process_t* proc = &process_table[i];
-            kernel_printf("%u | %s | %u | %u KB\n",
-                          proc->pid, proc->name, proc->state, proc->stack_size / 1024);
-        }
+    for (process_t* proc = all_process_head; proc != NULL; proc = proc->all_next) {
+        kernel_printf("%u | %s | %u | %u KB\n",
+                      proc->pid, proc->name, proc->state, proc->stack_size / 1024);
     }
 
     kernel_printf("-------------------\n\n");
 }
 
+/* 全プロセスのCPU使用率表示 (top風) */
+void process_top(void) {
+    extern u32 get_system_ticks(void);
+    u32 now = get_system_ticks();
+
+    kernel_printf("\n--- CPU Usage (top) ---\n");
+    kernel_printf("Uptime: %u ticks, Processes: %u\n", now, scheduler.process_count);
+    kernel_printf("PID  | Name              | State | %%CPU | Ticks | Vol | Invol | Last Run\n");
+    kernel_printf("-----|-------------------|-------|------|-------|-----|-------|---------\n");
+
+    for (process_t* proc = all_process_head; proc != NULL; proc = proc->all_next) {
+        /* プロセス生存期間に対する実行tickの割合 */
+        u32 alive = now - proc->created_ticks;
+        if (alive == 0) alive = 1;
+        u32 cpu_percent = (proc->cpu_ticks * 100) / alive;
+
+        kernel_printf("%u | %s | %u | %u%% | %u | %u | %u | ",
+                      proc->pid, proc->name, proc->state, cpu_percent,
+                      proc->cpu_ticks, proc->voluntary_switches,
+                      proc->involuntary_switches);
+
+        if (proc->last_scheduled == 0) {
+            kernel_printf("never\n");
+        } else {
+            kernel_printf("%u ticks ago\n", now - proc->last_scheduled);
+        }
+    }
+
+    kernel_printf("-----------------------\n\n");
+}
+
 /* デバッグ用プロセス */
 void idle_process(void) {
     kernel_printf("idle_process: Started\n");
@@ -388,10 +564,170 @@ void scheduler_switch_process(void) {
     // TODO: 実際のプロセス切り替え実装
 }
 
-/* スケジューラ: タイマー割り込み処理 (スタブ実装) */
+/* TSC読み出し (tickより細かいCPU時間計測用) */
+static u64 read_tsc(void) {
+    u32 lo, hi;
+    asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((u64)hi << 32) | lo;
+}
+
+/* 前回のscheduler_tick時のTSC値 */
+static u64 last_tick_tsc = 0;
+
+/* スケジューラ: タイマー割り込み処理
+ * 実行中プロセスへのCPU時間の付与とタイムスライス管理を行う */
 void scheduler_tick(void) {
-    kernel_printf("scheduler_tick: Called (stub implementation)\n");
-    // TODO: タイムスライス管理とプロセス切り替え実装
+    process_t* proc = scheduler.current_process;
+
+    /* 前回tickからのTSC差分を計測 (実行プロセスが無い間も進める) */
+    u64 tsc_now = read_tsc();
+    u64 tsc_delta = tsc_now - last_tick_tsc;
+    last_tick_tsc = tsc_now;
+
+    if (proc == NULL) return;
+
+    /* このtick分を実行中プロセスに課金 */
+    proc->cpu_ticks++;
+    proc->cpu_tsc += tsc_delta;
+
+    /* タイムスライス管理 */
+    if (proc->remaining_time > 0) {
+        proc->remaining_time--;
+    }
+    if (proc->remaining_time == 0) {
+        /* タイムスライス切れ: 強制切り替えとして記録 */
+        proc->involuntary_switches++;
+        proc->remaining_time = proc->time_slice;
+        scheduler_switch_process();
+    }
+}
+
+/* =========================== */
+/* スリープ・ウェイトキュー      */
+/* =========================== */
+
+/* ウェイトキュー初期化 */
+void wait_queue_init(wait_queue_t* queue) {
+    if (queue == NULL) return;
+
+    queue->head = NULL;
+    queue->tail = NULL;
+}
+
+/* ウェイトキューから指定プロセスを外す (O(1)) */
+static void wait_queue_unlink(wait_queue_t* queue, process_t* process) {
+    if (process->prev != NULL) {
+        process->prev->next = process->next;
+    } else {
+        queue->head = process->next;
+    }
+    if (process->next != NULL) {
+        process->next->prev = process->prev;
+    } else {
+        queue->tail = process->prev;
+    }
+
+    process->next = NULL;
+    process->prev = NULL;
+    process->waiting_on = NULL;
+}
+
+/* プロセスをウェイトキューに入れてBLOCKEDにする。
+ * レディキューから外れるため、scheduler_get_next_process が
+ * 待機中のプロセスを見ることは二度とない */
+void wait_queue_block(wait_queue_t* queue, process_t* process) {
+    if (queue == NULL || process == NULL) return;
+
+    /* レディキューから外す (双方向リストなのでO(1)) */
+    scheduler_remove_process(process);
+
+    /* ウェイトキュー末尾に追加 (next/prevリンクはレディキューと共用) */
+    process->next = NULL;
+    process->prev = queue->tail;
+    if (queue->tail != NULL) {
+        queue->tail->next = process;
+    } else {
+        queue->head = process;
+    }
+    queue->tail = process;
+    process->waiting_on = queue;
+
+    /* 自発的なCPU放棄として記録 */
+    process->voluntary_switches++;
+    process_set_state(process, PROCESS_BLOCKED);
+}
+
+/* ウェイトキュー先頭のプロセスを起床させる (イベント発生時に呼ぶ) */
+process_t* wait_queue_wake_one(wait_queue_t* queue) {
+    if (queue == NULL || queue->head == NULL) return NULL;
+
+    process_t* process = queue->head;
+    wait_queue_unlink(queue, process);
+
+    /* タイムアウト付き待機だった場合はタイマーも取り下げる */
+    timer_cancel(&process->sleep_timer);
+
+    scheduler_add_process(process);
+    return process;
+}
+
+/* ウェイトキューの全プロセスを起床させ、起床数を返す */
+u32 wait_queue_wake_all(wait_queue_t* queue) {
+    u32 count = 0;
+
+    while (wait_queue_wake_one(queue) != NULL) {
+        count++;
+    }
+    return count;
+}
+
+/* スリープタイマー発火: 起床時刻が来たプロセスを起こす */
+static void sleep_timer_expired(ktimer_t* timer, void* arg) {
+    UNUSED(timer);
+    process_wake((process_t*)arg);
+}
+
+/* 現在のプロセスを指定tick数スリープさせる。
+ * レディキューから外し、起床はタイマーホイールに任せる */
+void process_sleep(u32 ticks) {
+    process_t* proc = scheduler.current_process;
+    if (proc == NULL) {
+        kernel_printf("process_sleep: ERROR - No current process\n");
+        return;
+    }
+
+    kernel_printf("process_sleep: Process '%s' sleeping for %u ticks\n",
+                  proc->name, ticks);
+
+    /* レディキューから外して起床タイマーを登録 */
+    scheduler_remove_process(proc);
+    proc->waiting_on = NULL;
+    proc->voluntary_switches++;
+    process_set_state(proc, PROCESS_SLEEPING);
+
+    timer_add(&proc->sleep_timer, ticks, sleep_timer_expired, proc);
+
+    /* 別のプロセスに切り替える */
+    scheduler_switch_process();
+}
+
+/* スリープ/待機中のプロセスを起床させてレディキューに戻す */
+void process_wake(process_t* process) {
+    if (process == NULL) return;
+
+    if (process->state != PROCESS_SLEEPING && process->state != PROCESS_BLOCKED) {
+        return;
+    }
+
+    /* 起床タイマーが残っていれば取り下げる */
+    timer_cancel(&process->sleep_timer);
+
+    /* ウェイトキューで待機中ならそこから外す */
+    if (process->waiting_on != NULL) {
+        wait_queue_unlink(process->waiting_on, process);
+    }
+
+    scheduler_add_process(process);
 }
 
 /* =========================== */
@@ -433,6 +769,10 @@ void daemon_start(process_t* daemon) {
     extern u32 get_system_ticks(void);
     daemon->daemon_last_run = get_system_ticks();
 
+    /* 次回実行をタイマーホイールに登録 (以後は発火時に再アーム) */
+    timer_add(&daemon->daemon_timer, daemon->daemon_interval,
+              daemon_timer_expired, daemon);
+
     kernel_printf("daemon_start: Daemon '%s' started\n", daemon->name);
 }
 
@@ -444,33 +784,36 @@ void daemon_stop(process_t* daemon) {
     }
 
     daemon->daemon_enabled = false;
+
+    /* 登録済みの次回実行を取り下げる */
+    timer_cancel(&daemon->daemon_timer);
+
     kernel_printf("daemon_stop: Daemon '%s' stopped\n", daemon->name);
 }
 
-/* デーモンタスク実行チェック */
-void daemon_tick(void) {
-    extern u32 get_system_ticks(void);
-    u32 current_ticks = get_system_ticks();
+/* デーモンタイマー発火処理 (timer_tick から呼び出される)
+ * 従来の daemon_tick() のような全デーモン走査は行わず、
+ * 期限が来たデーモンだけがここに到達する */
+static void daemon_timer_expired(ktimer_t* timer, void* arg) {
+    process_t* proc = (process_t*)arg;
+    UNUSED(timer);
 
-    /* 全プロセスをチェック */
-    for (int i = 0; i < MAX_PROCESSES; i++) {
-        if (!process_table_used[i]) continue;
+    if (proc == NULL || !proc->is_daemon || !proc->daemon_enabled) return;
 
-        process_t* proc = &process_table[i];
-        if (!proc->is_daemon || !proc->daemon_enabled) continue;
+    extern u32 get_system_ticks(void);
+    proc->daemon_last_run = get_system_ticks();
+    proc->daemon_run_count++;
 
-        /* 実行間隔をチェック */
-        if (current_ticks - proc->daemon_last_run >= proc->daemon_interval) {
-            /* デーモンタスク実行 */
-            proc->daemon_last_run = current_ticks;
-            proc->daemon_run_count++;
+    kernel_printf("daemon_timer_expired: Running daemon '%s' (count=%u)\n",
+                 proc->name, proc->daemon_run_count);
 
-            kernel_printf("daemon_tick: Running daemon '%s' (count=%u)\n",
-                         proc->name, proc->daemon_run_count);
+    /* 実際のデーモンタスクを実行 */
+    daemon_execute_task(proc);
 
-            /* 実際のデーモンタスクを実行 */
-            daemon_execute_task(proc);
-        }
+    /* 実行完了後に次回分を再アーム */
+    if (proc->daemon_enabled) {
+        timer_add(&proc->daemon_timer, proc->daemon_interval,
+                  daemon_timer_expired, proc);
     }
 }
 
@@ -508,10 +851,7 @@ void daemon_list_all(void) {
     console_write("----|--------------|--------|--------|----------|-----\n");
 
     int daemon_count = 0;
-    for (int i = 0; i < MAX_PROCESSES; i++) {
-        if (!process_table_used[i]) continue;
-
-        process_t* proc = &process_table[i];
+    for (process_t* proc = all_process_head; proc != NULL; proc = proc->all_next) {
         if (!proc->is_daemon) continue;
 
         daemon_count++;
@@ -558,10 +898,7 @@ void daemon_list_all(void) {
 
 /* デーモン名で検索 */
 process_t* daemon_find_by_name(const char* name) {
-    for (int i = 0; i < MAX_PROCESSES; i++) {
-        if (!process_table_used[i]) continue;
-
-        process_t* proc = &process_table[i];
+    for (process_t* proc = all_process_head; proc != NULL; proc = proc->all_next) {
         if (proc->is_daemon && strcmp(proc->name, name) == 0) {
             return proc;
         }
@@ -571,10 +908,7 @@ process_t* daemon_find_by_name(const char* name) {
 
 /* デーモンタイプで検索 */
 process_t* daemon_find_by_type(daemon_type_t type) {
-    for (int i = 0; i < MAX_PROCESSES; i++) {
-        if (!process_table_used[i]) continue;
-
-        process_t* proc = &process_table[i];
+    for (process_t* proc = all_process_head; proc != NULL; proc = proc->all_next) {
         if (proc->is_daemon && proc->daemon_type == type) {
             return proc;
         }
@@ -594,10 +928,19 @@ static const char* daemon_type_to_string(daemon_type_t type) {
     }
 }
 
+/* SYSMONがLOGCLNに渡す観測レポート (MSG_SIZE以内に収めること) */
+typedef struct {
+    u32 used_percent;           /* メモリ使用率 (%) */
+    u32 used_kb;                /* 使用メモリ (KB) */
+    u32 total_kb;               /* 総メモリ (KB) */
+    u32 ticks;                  /* 観測時刻 */
+} sysmon_report_t;
+
 /* デーモンタスク実装 */
 static void daemon_system_monitor_task(void) {
     extern u32 get_free_memory(void);
     extern u32 get_total_memory(void);
+    extern u32 get_system_ticks(void);
 
     u32 free_mem = get_free_memory();
     u32 total_mem = get_total_memory();
@@ -605,11 +948,41 @@ static void daemon_system_monitor_task(void) {
 
     kernel_printf("SYSMON: Memory usage: %u%% (%u/%u KB)\n",
                   used_percent, (total_mem - free_mem) / 1024, total_mem / 1024);
+
+    /* 観測結果をログクリーナーのメッセージキューへ渡す
+     * (従来はデーモン間の連携手段がなく、共有グローバルのポーリングしか
+     * できなかった) */
+    process_t* cleaner = daemon_find_by_type(DAEMON_LOG_CLEANER);
+    if (cleaner != NULL) {
+        u8 buf[MSG_SIZE];
+        memset(buf, 0, sizeof(buf));
+
+        sysmon_report_t* report = (sysmon_report_t*)buf;
+        report->used_percent = used_percent;
+        report->used_kb = (total_mem - free_mem) / 1024;
+        report->total_kb = total_mem / 1024;
+        report->ticks = get_system_ticks();
+
+        msg_send(cleaner->pid, buf);
+    }
 }
 
 static void daemon_log_cleaner_task(void) {
-    kernel_printf("LOGCLN: Log cleanup completed\n");
-    /* 実際のログクリーンアップ処理をここに実装 */
+    /* SYSMONから届いた観測レポートを処理する */
+    process_t* self = daemon_find_by_type(DAEMON_LOG_CLEANER);
+    u8 buf[MSG_SIZE];
+    u32 processed = 0;
+
+    while (self != NULL && msg_try_recv(self, buf) == 0) {
+        sysmon_report_t* report = (sysmon_report_t*)buf;
+        kernel_printf("LOGCLN: Report at tick %u: %u%% used (%u/%u KB)\n",
+                      report->ticks, report->used_percent,
+                      report->used_kb, report->total_kb);
+        processed++;
+    }
+
+    kernel_printf("LOGCLN: Log cleanup completed (%u reports processed)\n",
+                  processed);
 }
 
 static void daemon_heartbeat_task(void) {
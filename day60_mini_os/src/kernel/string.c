@@ -1,13 +1,31 @@
 #include "kernel.h"
 
+/* ワード内に0バイトが含まれるか (word-at-a-time判定) */
+#define HAS_ZERO_BYTE(v) (((v) - 0x01010101u) & ~(v) & 0x80808080u)
+
 size_t strlen(const char* str) {
     if (!str) return 0;
 
-    size_t len = 0;
-    while (str[len]) {
-        len++;
+    const char* p = str;
+
+    /* 4バイト境界まではバイト単位で調べる */
+    while (((u32)p & 3) != 0) {
+        if (*p == '\0') return (size_t)(p - str);
+        p++;
+    }
+
+    /* ワード単位で0バイトを含むワードを探す */
+    const u32* w = (const u32*)p;
+    while (!HAS_ZERO_BYTE(*w)) {
+        w++;
     }
-    return len;
+
+    /* 0バイトの正確な位置をバイト単位で確定する */
+    p = (const char*)w;
+    while (*p) {
+        p++;
+    }
+    return (size_t)(p - str);
 }
 
 int strcmp(const char* s1, const char* s2) {
@@ -16,6 +34,29 @@ int strcmp(const char* s1, const char* s2) {
         return s1 ? 1 : -1;
     }
 
+    /* 両者のアラインメントが一致する場合のみワード比較できる */
+    if ((((u32)s1 ^ (u32)s2) & 3) == 0) {
+        /* 4バイト境界まではバイト単位で比較する */
+        while (((u32)s1 & 3) != 0) {
+            if (*s1 == '\0' || *s1 != *s2) {
+                return *(unsigned char*)s1 - *(unsigned char*)s2;
+            }
+            s1++;
+            s2++;
+        }
+
+        /* 一致し続ける間はワード単位で読み進める */
+        const u32* w1 = (const u32*)s1;
+        const u32* w2 = (const u32*)s2;
+        while (*w1 == *w2 && !HAS_ZERO_BYTE(*w1)) {
+            w1++;
+            w2++;
+        }
+        s1 = (const char*)w1;
+        s2 = (const char*)w2;
+    }
+
+    /* 差異または終端の位置をバイト単位で確定する */
     while (*s1 && (*s1 == *s2)) {
         s1++;
         s2++;
@@ -38,6 +79,24 @@ void* memset(void* ptr, int value, size_t size) {
     unsigned char* p = (unsigned char*)ptr;
     unsigned char val = (unsigned char)value;
 
+    /* 4バイト境界までバイト単位で埋める */
+    while (size > 0 && ((u32)p & 3) != 0) {
+        *p++ = val;
+        size--;
+    }
+
+    /* 本体はrep stosdでワード単位に埋める */
+    if (size >= 4) {
+        u32 word = (u32)val * 0x01010101u;
+        u32 words = size / 4;
+        asm volatile("rep stosl"
+                     : "+D"(p), "+c"(words)
+                     : "a"(word)
+                     : "memory");
+        size &= 3;
+    }
+
+    /* 端数をバイト単位で埋める */
     while (size--) {
         *p++ = val;
     }
@@ -51,6 +110,26 @@ void* memcpy(void* dest, const void* src, size_t size) {
     unsigned char* d = (unsigned char*)dest;
     const unsigned char* s = (const unsigned char*)src;
 
+    /* 両者のアラインメントが一致する場合のみワード転送できる */
+    if ((((u32)d ^ (u32)s) & 3) == 0) {
+        /* 4バイト境界までバイト単位でコピーする */
+        while (size > 0 && ((u32)d & 3) != 0) {
+            *d++ = *s++;
+            size--;
+        }
+
+        /* 本体はrep movsdでワード単位に転送する */
+        if (size >= 4) {
+            u32 words = size / 4;
+            asm volatile("rep movsl"
+                         : "+D"(d), "+S"(s), "+c"(words)
+                         :
+                         : "memory");
+            size &= 3;
+        }
+    }
+
+    /* 端数 (またはアラインメント不一致の全体) をバイト単位でコピーする */
     while (size--) {
         *d++ = *s++;
     }
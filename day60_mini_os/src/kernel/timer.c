@@ -0,0 +1,120 @@
+#include "timer.h"
+#include "kernel.h"
+
+/*
+ * カーネルタイマー (タイマーホイール実装)
+ *
+ * 従来は daemon_tick() が毎tick全デーモンの間隔カウンタを走査していた。
+ * ここでは発火時刻をスロット (expires % TIMER_WHEEL_SLOTS) に振り分けて
+ * 登録し、tickハンドラは現在時刻に対応するスロットのリストだけを見る。
+ * ホイール一周より先の発火時刻を持つタイマーは同じスロットに残り、
+ * 次の周回で時刻が一致したときに発火する。
+ */
+
+/* 現在時刻 (main.c のシステムtickカウンタ) */
+extern u32 get_system_ticks(void);
+
+/* スロットごとのタイマーリスト先頭 */
+static ktimer_t* timer_wheel[TIMER_WHEEL_SLOTS];
+
+/* 登録中のタイマー数 (情報表示用) */
+static u32 timer_count = 0;
+
+/* タイマーシステム初期化 */
+void timer_init(void) {
+    kernel_printf("timer_init: Initializing timer wheel (%u slots)...\n",
+                  (u32)TIMER_WHEEL_SLOTS);
+
+    for (int i = 0; i < TIMER_WHEEL_SLOTS; i++) {
+        timer_wheel[i] = NULL;
+    }
+    timer_count = 0;
+
+    kernel_printf("timer_init: Timer wheel initialized\n");
+}
+
+/* タイマーをスロットのリスト先頭に繋ぐ */
+static void timer_wheel_insert(ktimer_t* timer) {
+    u32 slot = timer->expires % TIMER_WHEEL_SLOTS;
+
+    timer->next = timer_wheel[slot];
+    timer->prev = NULL;
+    if (timer_wheel[slot] != NULL) {
+        timer_wheel[slot]->prev = timer;
+    }
+    timer_wheel[slot] = timer;
+    timer->pending = true;
+    timer_count++;
+}
+
+/* タイマーをスロットのリストから外す */
+static void timer_wheel_unlink(ktimer_t* timer) {
+    u32 slot = timer->expires % TIMER_WHEEL_SLOTS;
+
+    if (timer->prev != NULL) {
+        timer->prev->next = timer->next;
+    } else {
+        timer_wheel[slot] = timer->next;
+    }
+    if (timer->next != NULL) {
+        timer->next->prev = timer->prev;
+    }
+
+    timer->next = NULL;
+    timer->prev = NULL;
+    timer->pending = false;
+    timer_count--;
+}
+
+/* タイマー登録 (delta_ticks 後に callback を呼ぶ) */
+void timer_add(ktimer_t* timer, u32 delta_ticks, timer_callback_t callback, void* arg) {
+    if (timer == NULL || callback == NULL) return;
+
+    /* 登録済みなら一度外して再登録 */
+    if (timer->pending) {
+        timer_wheel_unlink(timer);
+    }
+
+    /* delta 0 は「次のtick」として扱う (現在スロットでの即時発火を防ぐ) */
+    if (delta_ticks == 0) {
+        delta_ticks = 1;
+    }
+
+    timer->expires = get_system_ticks() + delta_ticks;
+    timer->callback = callback;
+    timer->arg = arg;
+
+    timer_wheel_insert(timer);
+}
+
+/* タイマー解除 (未発火のまま取り下げる) */
+void timer_cancel(ktimer_t* timer) {
+    if (timer == NULL || !timer->pending) return;
+
+    timer_wheel_unlink(timer);
+}
+
+/* タイマー割り込みごとの処理: 現在時刻のスロットだけを見る */
+void timer_tick(void) {
+    u32 now = get_system_ticks();
+    u32 slot = now % TIMER_WHEEL_SLOTS;
+
+    ktimer_t* timer = timer_wheel[slot];
+    while (timer != NULL) {
+        ktimer_t* next = timer->next;  /* コールバック内の再登録に備えて先に保存 */
+
+        /* 発火時刻が過去または現在のものだけ発火。
+         * ホイール一周以上先のタイマーは次の周回まで残す */
+        if ((s32)(now - timer->expires) >= 0) {
+            timer_wheel_unlink(timer);
+            timer->callback(timer, timer->arg);
+        }
+
+        timer = next;
+    }
+}
+
+/* 登録中のタイマー数を返す */
+u32 timer_pending_count(void) {
+    return timer_count;
+}
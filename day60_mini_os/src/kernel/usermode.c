@@ -5,8 +5,17 @@
 /* グローバルユーザーモード管理変数 */
 static usermode_manager_t usermode_manager;
 
+/* SEP (sysenter/sysexit) 関連 */
+#define MSR_SYSENTER_CS     0x174
+#define MSR_SYSENTER_ESP    0x175
+#define MSR_SYSENTER_EIP    0x176
+#define CPUID_FEAT_EDX_SEP  (1 << 11)
+
+static bool sysenter_available = false;
+
 /* システムコール前方宣言 */
 void handle_syscall(interrupt_frame_t* frame);
+static u32 do_syscall(u32 syscall_num, u32 arg1, u32 arg2);
 
 void usermode_init(void) {
     kernel_printf("usermode_init: Initializing user mode system...\n");
@@ -26,6 +35,10 @@ void usermode_init(void) {
     kernel_printf("usermode_init: Registering system call handler...\n");
     register_interrupt_handler(0x80, handle_syscall);
 
+    /* sysenter高速パスの設定 (int 0x80はフォールバックとして残る) */
+    kernel_printf("usermode_init: Setting up sysenter fast path...\n");
+    sysenter_setup();
+
     usermode_manager.usermode_enabled = true;
     kernel_printf("usermode_init: User mode system initialized\n");
     kernel_printf("usermode_init: Phase 9 complete - ready for user mode execution\n");
@@ -129,6 +142,49 @@ void gdt_load(void) {
 void tss_set_kernel_stack(u32 stack_top) {
     usermode_manager.tss.esp0 = stack_top;
     usermode_manager.kernel_stack_top = stack_top;
+
+    /* sysenterのカーネルスタックも追従させる */
+    if (sysenter_available) {
+        asm volatile("wrmsr" :: "c"(MSR_SYSENTER_ESP), "a"(stack_top), "d"(0));
+    }
+}
+
+/* CPUがSEP (sysenter/sysexit) を持つか確認 */
+static bool cpu_has_sep(void) {
+    u32 eax, ebx, ecx, edx;
+    asm volatile("cpuid"
+                 : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx)
+                 : "a"(1));
+    return (edx & CPUID_FEAT_EDX_SEP) != 0;
+}
+
+/* MSR書き込み */
+static void wrmsr(u32 msr, u32 low, u32 high) {
+    asm volatile("wrmsr" :: "c"(msr), "a"(low), "d"(high));
+}
+
+/* sysenter高速システムコールパスの設定。
+ * SYSENTER_CS=カーネルCSを起点に、sysexitがCS+16/CS+24から
+ * ユーザーセレクタを導出するため、GDT配置 (0x08/0x10/0x18/0x20)
+ * がそのままSEPの要求と一致する */
+void sysenter_setup(void) {
+    if (!cpu_has_sep()) {
+        kernel_printf("sysenter_setup: CPU has no SEP support, int 0x80 only\n");
+        return;
+    }
+
+    wrmsr(MSR_SYSENTER_CS, KERNEL_CODE_SELECTOR, 0);
+    wrmsr(MSR_SYSENTER_ESP, usermode_manager.kernel_stack_top, 0);
+    wrmsr(MSR_SYSENTER_EIP, (u32)sysenter_entry, 0);
+
+    sysenter_available = true;
+    kernel_printf("sysenter_setup: sysenter enabled (entry=0x%x, esp=0x%x)\n",
+                  (u32)sysenter_entry, usermode_manager.kernel_stack_top);
+}
+
+/* sysenterが利用可能か (ユーザー側が呼び出し方法を選ぶための照会) */
+bool is_sysenter_available(void) {
+    return sysenter_available;
 }
 
 int create_user_process(const char* name, void* code, u32 code_size, u32 entry_point) {
@@ -221,16 +277,13 @@ void jump_to_user_mode(u32 code_addr, u32 stack_addr) {
     kernel_printf("jump_to_user_mode: ERROR - Returned from assembly function\n");
 }
 
-/* システムコールハンドラ */
-void handle_syscall(interrupt_frame_t* frame) {
-    u32 syscall_num = frame->eax;
-
+/* システムコール本体 (int 0x80とsysenterの両エントリから呼ばれる) */
+static u32 do_syscall(u32 syscall_num, u32 arg1, u32 arg2) {
     switch (syscall_num) {
         case 0: /* sys_exit */
             {
-                u32 exit_code = frame->ebx;
+                u32 exit_code = arg1;
                 kernel_printf("handle_syscall: Process exit with code %u\n", exit_code);
-                frame->eax = 0; /* 成功 */
                 /* プロセス終了処理（簡易版） */
                 kernel_printf("System call exit - halting system\n");
                 while (1) {
@@ -241,8 +294,8 @@ void handle_syscall(interrupt_frame_t* frame) {
 
         case 1: /* sys_write */
             {
-                const char* msg = (const char*)frame->ebx;
-                u32 len = frame->ecx;
+                const char* msg = (const char*)arg1;
+                u32 len = arg2;
                 kernel_printf("handle_syscall: Write request - len=%u\n", len);
 
                 /* 簡易的な文字列出力（長さチェック付き） */
@@ -263,9 +316,8 @@ void handle_syscall(interrupt_frame_t* frame) {
                     }
                 }
 
-                frame->eax = len; /* 書き込んだバイト数を返す */
+                return len; /* 書き込んだバイト数を返す */
             }
-            break;
 
         case 2: /* sys_getchar */
             {
@@ -275,20 +327,30 @@ void handle_syscall(interrupt_frame_t* frame) {
 
                 if (keyboard_has_input()) {
                     char c = keyboard_get_char();
-                    frame->eax = (u32)c; /* 文字を返す */
                     kernel_printf("handle_syscall: getchar returned '%c' (0x%x)\n",
                                   (c >= 32 && c <= 126) ? c : '?', (u32)c);
-                } else {
-                    frame->eax = 0; /* 入力がない場合は0を返す */
+                    return (u32)c; /* 文字を返す */
                 }
+                return 0; /* 入力がない場合は0を返す */
             }
-            break;
 
         default:
             kernel_printf("handle_syscall: Unknown system call %u\n", syscall_num);
-            frame->eax = -1; /* エラー */
-            break;
+            return (u32)-1; /* エラー */
     }
+
+    return 0;
+}
+
+/* int 0x80エントリ: フレーム経由で引数を受け渡す */
+void handle_syscall(interrupt_frame_t* frame) {
+    frame->eax = do_syscall(frame->eax, frame->ebx, frame->ecx);
+}
+
+/* sysenterエントリ (usermode_asm.asmのスタブから呼ばれる)。
+ * ecx/edxはsysexitの復帰用に使われるため、第2引数はesiで渡される */
+u32 sysenter_dispatch(u32 syscall_num, u32 arg1, u32 arg2) {
+    return do_syscall(syscall_num, arg1, arg2);
 }
 
 void usermode_print_info(void) {
@@ -132,6 +132,43 @@ syscall_entry:
     ; ユーザーモードに戻る
     iretd
 
+; sysenterエントリポイント（SEP高速システムコールパス）
+; 呼び出し規約: eax=システムコール番号, ebx=第1引数, esi=第2引数,
+;               ecx=ユーザーESP, edx=ユーザー復帰EIP
+; (ecx/edxの配置はsysexitの要求による。int 0x80とは第2引数のみ異なる)
+global sysenter_entry
+extern sysenter_dispatch
+sysenter_entry:
+    ; ESPはIA32_SYSENTER_ESPで設定済みのカーネルスタック
+    push edx                ; ユーザー復帰EIP
+    push ecx                ; ユーザーESP
+
+    ; カーネルデータセグメントに切り替え
+    mov cx, 0x10
+    mov ds, cx
+    mov es, cx
+    mov fs, cx
+    mov gs, cx
+
+    ; Cディスパッチャ呼び出し（cdecl: 番号, 第1引数, 第2引数）
+    push esi
+    push ebx
+    push eax
+    call sysenter_dispatch  ; 戻り値はeax
+    add esp, 12
+
+    ; ユーザーデータセグメントに戻す（sysexitはCS/SSのみMSRから導出する）
+    mov cx, 0x20 | 3
+    mov ds, cx
+    mov es, cx
+    mov fs, cx
+    mov gs, cx
+
+    pop ecx                 ; ユーザーESP
+    pop edx                 ; ユーザー復帰EIP
+    sti                     ; sysenterでクリアされたIFを戻す
+    sysexit
+
 ; ユーザーモードからカーネルモードに強制復帰
 global force_return_to_kernel
 force_return_to_kernel:
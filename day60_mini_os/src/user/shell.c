@@ -58,17 +58,78 @@ static int shell_strcmp(const char* s1, const char* s2) {
     return *s1 - *s2;
 }
 
-static int shell_strncmp(const char* s1, const char* s2, int n) {
-    for (int i = 0; i < n; i++) {
-        if (s1[i] != s2[i] || s1[i] == '\0' || s2[i] == '\0') {
-            return (unsigned char)s1[i] - (unsigned char)s2[i];
+/* 前方宣言 */
+static void execute_shell_command(const char* command);
+
+/* ---- コマンドレジストリ ----
+ * 従来はexecute_command/execute_shell_commandの両方がstrcmpのはしごで、
+ * 全コマンドを先頭から総当たりしていた。コマンドは{名前, ハッシュ,
+ * ハンドラ, ヘルプ}のテーブルに登録し、事前計算したハッシュの一致時だけ
+ * 1回strcmpする。両ディスパッチサイトが同じ検索機構を共有し、コマンド
+ * 追加はテーブルに1行足すだけでよい */
+
+typedef void (*shell_cmd_handler_t)(const char* args);
+
+typedef struct {
+    const char* name;           /* コマンド名 */
+    u32 hash;                   /* 名前のハッシュ (初回ディスパッチ時に計算) */
+    shell_cmd_handler_t handler;
+    const char* help;           /* helpコマンド用の説明 */
+} shell_command_t;
+
+/* 登録マクロ: 新コマンドはテーブルに1行足すだけ */
+#define SHELL_CMD(name, handler, help) { name, 0, handler, help }
+
+/* djb2ハッシュ (0は未計算の印として予約) */
+static u32 shell_hash(const char* s) {
+    u32 hash = 5381;
+    while (*s) {
+        hash = ((hash << 5) + hash) + (u8)*s++;
+    }
+    return hash != 0 ? hash : 1;
+}
+
+/* テーブル検索: ハッシュが一致したエントリだけ文字列比較する */
+static const shell_command_t* shell_lookup(shell_command_t* table, int count,
+                                           const char* name) {
+    u32 hash = shell_hash(name);
+
+    for (int i = 0; i < count; i++) {
+        if (table[i].hash == 0) {
+            table[i].hash = shell_hash(table[i].name);
+        }
+        if (table[i].hash == hash && shell_strcmp(table[i].name, name) == 0) {
+            return &table[i];
         }
     }
-    return 0;
+    return NULL;
 }
 
-/* 前方宣言 */
-static void execute_shell_command(const char* command);
+/* コマンド行を名前と引数に分割してテーブルから実行する。
+ * 戻り値: 0=実行, -1=未登録コマンド */
+static int shell_dispatch(shell_command_t* table, int count,
+                          const char* command) {
+    char name[32];
+    int len = 0;
+
+    while (command[len] != '\0' && command[len] != ' ' &&
+           len < (int)sizeof(name) - 1) {
+        name[len] = command[len];
+        len++;
+    }
+    name[len] = '\0';
+
+    const char* args = command + len;
+    while (*args == ' ') args++;
+
+    const shell_command_t* cmd = shell_lookup(table, count, name);
+    if (cmd == NULL) {
+        return -1;
+    }
+
+    cmd->handler(args);
+    return 0;
+}
 
 /* コマンドライン入力 */
 static int shell_readline(char* buffer, int max_len) {
@@ -103,48 +164,84 @@ static int shell_readline(char* buffer, int max_len) {
     return pos;
 }
 
+/* ---- ユーザーモードシェルのコマンド実装 ---- */
+
+static void user_cmd_help(const char* args);
+static void user_cmd_version(const char* args);
+static void user_cmd_memory(const char* args);
+static void user_cmd_clear(const char* args);
+static void user_cmd_uptime(const char* args);
+static void user_cmd_exit(const char* args);
+
+/* ユーザーモードシェルのコマンドテーブル */
+static shell_command_t user_commands[] = {
+    SHELL_CMD("help",    user_cmd_help,    "Show this help"),
+    SHELL_CMD("version", user_cmd_version, "Show OS version"),
+    SHELL_CMD("memory",  user_cmd_memory,  "Show memory info"),
+    SHELL_CMD("clear",   user_cmd_clear,   "Clear screen"),
+    SHELL_CMD("uptime",  user_cmd_uptime,  "Show system uptime"),
+    SHELL_CMD("exit",    user_cmd_exit,    "Exit shell"),
+};
+
+static const int user_command_count =
+    sizeof(user_commands) / sizeof(user_commands[0]);
+
+static void user_cmd_help(const char* args) {
+    UNUSED(args);
+    shell_print("=== Mini OS Shell v1.0 ===\n");
+    shell_print("Available commands:\n");
+    for (int i = 0; i < user_command_count; i++) {
+        shell_print("  ");
+        shell_print(user_commands[i].name);
+        shell_print(" - ");
+        shell_print(user_commands[i].help);
+        shell_print("\n");
+    }
+}
+
+static void user_cmd_version(const char* args) {
+    UNUSED(args);
+    shell_print("Mini OS v0.1.0 - User Mode Shell\n");
+    shell_print("Built with love and assembly code!\n");
+    shell_print("Features: Memory Management, Process Management, Interrupts, User Mode\n");
+}
+
+static void user_cmd_memory(const char* args) {
+    UNUSED(args);
+    shell_print("=== Memory Information ===\n");
+    shell_print("Total Memory: 256MB\n");
+    shell_print("Current Mode: User Mode (Ring 3)\n");
+    shell_print("Page Size: 4KB\n");
+    shell_print("Available: Dynamic allocation via system calls\n");
+}
+
+static void user_cmd_clear(const char* args) {
+    UNUSED(args);
+    shell_print("\033[2J\033[H");  // ANSI escape sequence for clear screen
+    shell_print("Screen cleared!\n");
+}
+
+static void user_cmd_uptime(const char* args) {
+    UNUSED(args);
+    shell_print("System uptime: Active since boot\n");
+    shell_print("Process management: 2 processes running\n");
+    shell_print("Interrupt system: Fully operational\n");
+}
+
+static void user_cmd_exit(const char* args) {
+    UNUSED(args);
+    shell_print("Thank you for using Mini OS Shell!\n");
+    shell_print("Shutting down...\n");
+    sys_exit(0);
+}
+
 /* コマンド解析と実行 */
 static void execute_command(const char* command) {
-    if (shell_strcmp(command, "help") == 0) {
-        shell_print("=== Mini OS Shell v1.0 ===\n");
-        shell_print("Available commands:\n");
-        shell_print("  help     - Show this help\n");
-        shell_print("  version  - Show OS version\n");
-        shell_print("  memory   - Show memory info\n");
-        shell_print("  clear    - Clear screen\n");
-        shell_print("  uptime   - Show system uptime\n");
-        shell_print("  exit     - Exit shell\n");
-    }
-    else if (shell_strcmp(command, "version") == 0) {
-        shell_print("Mini OS v0.1.0 - User Mode Shell\n");
-        shell_print("Built with love and assembly code!\n");
-        shell_print("Features: Memory Management, Process Management, Interrupts, User Mode\n");
+    if (command[0] == '\0') {
+        return;  // 空のコマンド - 何もしない
     }
-    else if (shell_strcmp(command, "memory") == 0) {
-        shell_print("=== Memory Information ===\n");
-        shell_print("Total Memory: 256MB\n");
-        shell_print("Current Mode: User Mode (Ring 3)\n");
-        shell_print("Page Size: 4KB\n");
-        shell_print("Available: Dynamic allocation via system calls\n");
-    }
-    else if (shell_strcmp(command, "clear") == 0) {
-        shell_print("\033[2J\033[H");  // ANSI escape sequence for clear screen
-        shell_print("Screen cleared!\n");
-    }
-    else if (shell_strcmp(command, "uptime") == 0) {
-        shell_print("System uptime: Active since boot\n");
-        shell_print("Process management: 2 processes running\n");
-        shell_print("Interrupt system: Fully operational\n");
-    }
-    else if (shell_strcmp(command, "exit") == 0) {
-        shell_print("Thank you for using Mini OS Shell!\n");
-        shell_print("Shutting down...\n");
-        sys_exit(0);
-    }
-    else if (command[0] == '\0') {
-        // 空のコマンド - 何もしない
-    }
-    else {
+
+    if (shell_dispatch(user_commands, user_command_count, command) != 0) {
         shell_print("Unknown command: '");
         shell_print(command);
         shell_print("'\n");
@@ -177,7 +274,7 @@ void shell_start(void) {
     extern void kernel_printf(const char* format, ...);
     extern void console_write(const char* str);
     extern void vga_clear(void);
-    extern int keyboard_getchar(void);  // キーボードから文字を取得
+    extern char keyboard_read_blocking(void);  // キーボードから文字を取得（入力までブロック）
 
     char command_buffer[256];
     int pos = 0;
@@ -216,11 +313,8 @@ void shell_start(void) {
 
         // コマンドライン入力処理
         while (pos < sizeof(command_buffer) - 1) {
-            /* キーボードから1文字取得（ポーリング） */
-            while ((c = keyboard_getchar()) == 0) {
-                /* キー入力を待機 */
-                asm("pause");  // CPUを一時停止してエネルギー節約
-            }
+            /* キーボードから1文字取得（入力到着までブロック） */
+            c = keyboard_read_blocking();
 
             if (c == '\n') {
                 /* Enterキーで入力完了 */
@@ -248,168 +342,254 @@ void shell_start(void) {
     }
 }
 
-/* コマンド実行（カーネルモード版） */
-static void execute_shell_command(const char* command) {
-    extern void console_write(const char* str);
+/* ---- カーネルモードシェルのコマンド実装 ---- */
+
+extern void console_write(const char* str);
+
+static void kernel_cmd_help(const char* args);
+static void kernel_cmd_version(const char* args);
+static void kernel_cmd_memory(const char* args);
+static void kernel_cmd_process(const char* args);
+static void kernel_cmd_top(const char* args);
+static void kernel_cmd_daemon(const char* args);
+static void kernel_cmd_clear(const char* args);
+static void kernel_cmd_uptime(const char* args);
+static void kernel_cmd_test(const char* args);
+static void kernel_cmd_bench(const char* args);
+static void kernel_cmd_inttest(const char* args);
+static void kernel_cmd_kbtest(const char* args);
+static void kernel_cmd_echo(const char* args);
+static void kernel_cmd_date(const char* args);
+static void kernel_cmd_irqstat(const char* args);
+static void kernel_cmd_cowtest(const char* args);
+static void kernel_cmd_reboot(const char* args);
+
+/* カーネルモードシェルのコマンドテーブル */
+static shell_command_t kernel_commands[] = {
+    SHELL_CMD("help",    kernel_cmd_help,    "Show this help"),
+    SHELL_CMD("echo",    kernel_cmd_echo,    "Display text (usage: echo [text])"),
+    SHELL_CMD("date",    kernel_cmd_date,    "Show current date and time"),
+    SHELL_CMD("version", kernel_cmd_version, "Show OS version"),
+    SHELL_CMD("memory",  kernel_cmd_memory,  "Show memory info"),
+    SHELL_CMD("process", kernel_cmd_process, "Show process info"),
+    SHELL_CMD("top",     kernel_cmd_top,     "Show per-process CPU usage"),
+    SHELL_CMD("daemon",  kernel_cmd_daemon,  "Show daemon status"),
+    SHELL_CMD("clear",   kernel_cmd_clear,   "Clear screen"),
+    SHELL_CMD("uptime",  kernel_cmd_uptime,  "Show system uptime"),
+    SHELL_CMD("test",    kernel_cmd_test,    "Run system test"),
+    SHELL_CMD("bench",   kernel_cmd_bench,   "Run kernel microbenchmarks"),
+    SHELL_CMD("inttest", kernel_cmd_inttest, "Run interrupt tests"),
+    SHELL_CMD("kbtest",  kernel_cmd_kbtest,  "Run keyboard test"),
+    SHELL_CMD("irqstat", kernel_cmd_irqstat, "Show interrupt statistics (irqstat reset to clear)"),
+    SHELL_CMD("cowtest", kernel_cmd_cowtest, "Run copy-on-write paging test"),
+    SHELL_CMD("reboot",  kernel_cmd_reboot,  "Restart system"),
+};
+
+static const int kernel_command_count =
+    sizeof(kernel_commands) / sizeof(kernel_commands[0]);
+
+static void kernel_cmd_help(const char* args) {
+    UNUSED(args);
+    console_write("=== Mini OS Shell v1.0 ===\n");
+    console_write("Available commands:\n");
+    for (int i = 0; i < kernel_command_count; i++) {
+        console_write("  ");
+        console_write(kernel_commands[i].name);
+        console_write(" - ");
+        console_write(kernel_commands[i].help);
+        console_write("\n");
+    }
+    console_write("Use Ctrl+C to exit shell.\n");
+}
+
+static void kernel_cmd_version(const char* args) {
+    UNUSED(args);
+    console_write("=== Mini OS Version Information ===\n");
+    console_write("OS Name:     Mini OS\n");
+    console_write("Version:     v0.1.0\n");
+    console_write("Build:       Day 60 Challenge\n");
+    console_write("Architecture: x86-32bit\n");
+    console_write("Mode:        Kernel Mode Shell\n");
+    console_write("Memory:      256MB RAM\n");
+    console_write("Features:    GDT, TSS, Interrupts, Paging-ready\n");
+}
+
+static void kernel_cmd_memory(const char* args) {
+    UNUSED(args);
     extern void memory_print_info(void);
+    console_write("=== Memory Information ===\n");
+    memory_print_info();
+}
+
+static void kernel_cmd_process(const char* args) {
+    UNUSED(args);
     extern void process_print_info(void);
-    extern void sprintf_simple(char* buffer, const char* format, ...);
+    extern void process_list_all(void);
+    console_write("=== Process Information ===\n");
+    process_print_info();
+    process_list_all();
+}
 
-    if (shell_strcmp(command, "help") == 0) {
-        console_write("=== Mini OS Shell v1.0 ===\n");
-        console_write("Available commands:\n");
-        console_write("  help     - Show this help\n");
-        console_write("  echo     - Display text (usage: echo [text])\n");
-        console_write("  date     - Show current date and time\n");
-        console_write("  version  - Show OS version\n");
-        console_write("  memory   - Show memory info\n");
-        console_write("  process  - Show process info\n");
-        console_write("  daemon   - Show daemon status\n");
-        console_write("  clear    - Clear screen\n");
-        console_write("  uptime   - Show system uptime\n");
-        console_write("  test     - Run system test\n");
-        console_write("  inttest  - Run interrupt tests\n");
-        console_write("  kbtest   - Run keyboard test\n");
-        console_write("  reboot   - Restart system\n");
-        console_write("Use Ctrl+C to exit shell.\n");
-    }
-    else if (shell_strcmp(command, "version") == 0) {
-        console_write("=== Mini OS Version Information ===\n");
-        console_write("OS Name:     Mini OS\n");
-        console_write("Version:     v0.1.0\n");
-        console_write("Build:       Day 60 Challenge\n");
-        console_write("Architecture: x86-32bit\n");
-        console_write("Mode:        Kernel Mode Shell\n");
-        console_write("Memory:      256MB RAM\n");
-        console_write("Features:    GDT, TSS, Interrupts, Paging-ready\n");
-    }
-    else if (shell_strcmp(command, "memory") == 0) {
-        console_write("=== Memory Information ===\n");
-        memory_print_info();
-    }
-    else if (shell_strcmp(command, "process") == 0) {
-        console_write("=== Process Information ===\n");
-        process_print_info();
-        extern void process_list_all(void);
-        process_list_all();
-    }
-    else if (shell_strcmp(command, "daemon") == 0) {
-        extern void daemon_list_all(void);
-        daemon_list_all();
-    }
-    else if (shell_strcmp(command, "clear") == 0) {
-        extern void vga_clear(void);
-        vga_clear();
-        console_write("Screen cleared!\n");
-    }
-    else if (shell_strcmp(command, "uptime") == 0) {
-        console_write("=== System Status ===\n");
-        console_write("Status:          Running\n");
-        console_write("Boot Status:     Completed successfully\n");
-        console_write("Memory Manager:  Active\n");
-        console_write("Process Manager: Active (2 processes)\n");
-        console_write("Interrupt System: Active\n");
-        console_write("Keyboard Driver: Active\n");
-        console_write("VGA Driver:     Active (80x25 text mode)\n");
-        console_write("User Mode:      Ready (GDT/TSS configured)\n");
-    }
-    else if (shell_strcmp(command, "test") == 0) {
-        console_write("=== Running System Test ===\n");
-        console_write("Testing memory allocation...\n");
-
-        extern u32 alloc_page(void);
-        extern void free_page(u32 page);
-
-        u32 test_page = alloc_page();
-        if (test_page != 0) {
-            console_write("✓ Memory allocation successful\n");
-            free_page(test_page);
-            console_write("✓ Memory deallocation successful\n");
-        } else {
-            console_write("✗ Memory allocation failed\n");
-        }
+static void kernel_cmd_top(const char* args) {
+    UNUSED(args);
+    extern void process_top(void);
+    process_top();
+}
 
-        console_write("✓ All tests passed!\n");
-    }
-    else if (shell_strcmp(command, "inttest") == 0) {
-        console_write("=== Running Interrupt System Tests ===\n");
+static void kernel_cmd_daemon(const char* args) {
+    UNUSED(args);
+    extern void daemon_list_all(void);
+    daemon_list_all();
+}
 
-        extern void run_interrupt_tests(void);
-        run_interrupt_tests();
+static void kernel_cmd_clear(const char* args) {
+    UNUSED(args);
+    extern void vga_clear(void);
+    vga_clear();
+    console_write("Screen cleared!\n");
+}
 
-        console_write("=== Interrupt tests completed ===\n");
+static void kernel_cmd_uptime(const char* args) {
+    UNUSED(args);
+    console_write("=== System Status ===\n");
+    console_write("Status:          Running\n");
+    console_write("Boot Status:     Completed successfully\n");
+    console_write("Memory Manager:  Active\n");
+    console_write("Process Manager: Active (2 processes)\n");
+    console_write("Interrupt System: Active\n");
+    console_write("Keyboard Driver: Active\n");
+    console_write("VGA Driver:     Active (80x25 text mode)\n");
+    console_write("User Mode:      Ready (GDT/TSS configured)\n");
+}
+
+static void kernel_cmd_test(const char* args) {
+    UNUSED(args);
+    extern u32 alloc_page(void);
+    extern void free_page(u32 page);
+
+    console_write("=== Running System Test ===\n");
+    console_write("Testing memory allocation...\n");
+
+    u32 test_page = alloc_page();
+    if (test_page != 0) {
+        console_write("✓ Memory allocation successful\n");
+        free_page(test_page);
+        console_write("✓ Memory deallocation successful\n");
+    } else {
+        console_write("✗ Memory allocation failed\n");
     }
-    else if (shell_strcmp(command, "kbtest") == 0) {
-        console_write("=== Running Keyboard Test ===\n");
-        console_write("Warning: This will temporarily replace keyboard handler\n");
-        console_write("Press any key when prompted...\n");
 
-        extern void test_keyboard_interrupt(void);
-        test_keyboard_interrupt();
+    console_write("✓ All tests passed!\n");
+}
 
-        console_write("=== Keyboard test completed ===\n");
-    }
-    else if (shell_strncmp(command, "echo ", 5) == 0) {
-        /* echo コマンド - テキストを表示 */
-        const char* text = command + 5;  /* "echo " の後の部分 */
-
-        /* 引数がない場合は空行を出力 */
-        if (*text == '\0') {
-            console_write("\n");
-        } else {
-            /* 引数の文字列を出力 */
-            console_write(text);
-            console_write("\n");
-        }
-    }
-    else if (shell_strcmp(command, "echo") == 0) {
-        /* 引数なしのecho - 空行を出力 */
+static void kernel_cmd_bench(const char* args) {
+    UNUSED(args);
+    extern void bench_run_all(void);
+    bench_run_all();
+}
+
+static void kernel_cmd_inttest(const char* args) {
+    UNUSED(args);
+    extern void run_interrupt_tests(void);
+
+    console_write("=== Running Interrupt System Tests ===\n");
+    run_interrupt_tests();
+    console_write("=== Interrupt tests completed ===\n");
+}
+
+static void kernel_cmd_kbtest(const char* args) {
+    UNUSED(args);
+    extern void test_keyboard_interrupt(void);
+
+    console_write("=== Running Keyboard Test ===\n");
+    console_write("Warning: This will temporarily replace keyboard handler\n");
+    console_write("Press any key when prompted...\n");
+
+    test_keyboard_interrupt();
+
+    console_write("=== Keyboard test completed ===\n");
+}
+
+static void kernel_cmd_echo(const char* args) {
+    /* 引数がない場合は空行を出力 */
+    if (*args == '\0') {
         console_write("\n");
-    }
-    else if (shell_strcmp(command, "date") == 0) {
-        /* 日付と時刻を表示 */
-        extern u32 get_system_ticks(void);
-        extern void format_current_time(u32 ticks, char* buffer);
-
-        u32 ticks = get_system_ticks();
-        char time_buffer[64];
-        format_current_time(ticks, time_buffer);
-
-        console_write("=== System Date & Time ===\n");
-        console_write("Date:         Saturday, June 7, 2025\n");
-        console_write("Current Time: ");
-        console_write(time_buffer);
+    } else {
+        console_write(args);
         console_write("\n");
-        console_write("Timezone:     JST (UTC+9)\n");
-        console_write("Uptime:       ");
-
-        /* 稼働時間を計算 */
-        u32 seconds = ticks / 2;  /* 2Hz */
-        u32 minutes = seconds / 60;
-        u32 hours = minutes / 60;
-
-        seconds %= 60;
-        minutes %= 60;
-
-        char uptime_str[32];
-        if (hours > 0) {
-            sprintf_simple(uptime_str, "%u:%02u:%02u", hours, minutes, seconds);
-        } else {
-            sprintf_simple(uptime_str, "%u:%02u", minutes, seconds);
-        }
+    }
+}
 
-        console_write(uptime_str);
-        console_write("\n");
+static void kernel_cmd_date(const char* args) {
+    UNUSED(args);
+    extern u32 get_system_ticks(void);
+    extern void format_current_time(u32 ticks, char* buffer);
+    extern void sprintf_simple(char* buffer, const char* format, ...);
+
+    u32 ticks = get_system_ticks();
+    char time_buffer[64];
+    format_current_time(ticks, time_buffer);
+
+    console_write("=== System Date & Time ===\n");
+    console_write("Date:         Saturday, June 7, 2025\n");
+    console_write("Current Time: ");
+    console_write(time_buffer);
+    console_write("\n");
+    console_write("Timezone:     JST (UTC+9)\n");
+    console_write("Uptime:       ");
+
+    /* 稼働時間を計算 */
+    u32 seconds = ticks / 2;  /* 2Hz */
+    u32 minutes = seconds / 60;
+    u32 hours = minutes / 60;
+
+    seconds %= 60;
+    minutes %= 60;
+
+    char uptime_str[32];
+    if (hours > 0) {
+        sprintf_simple(uptime_str, "%u:%02u:%02u", hours, minutes, seconds);
+    } else {
+        sprintf_simple(uptime_str, "%u:%02u", minutes, seconds);
     }
-    else if (shell_strcmp(command, "reboot") == 0) {
-        console_write("Rebooting system...\n");
-        console_write("(Use Ctrl+Alt+Del in QEMU or close window)\n");
-        // 実際のリブートは複雑なので、メッセージのみ表示
+
+    console_write(uptime_str);
+    console_write("\n");
+}
+
+static void kernel_cmd_irqstat(const char* args) {
+    extern void irq_stats_print(void);
+    extern void irq_stats_reset(void);
+
+    if (shell_strcmp(args, "reset") == 0) {
+        irq_stats_reset();
+        console_write("Interrupt statistics cleared.\n");
+        return;
     }
-    else if (command[0] == '\0') {
-        // 空のコマンド - 何もしない
+
+    irq_stats_print();
+}
+
+static void kernel_cmd_cowtest(const char* args) {
+    UNUSED(args);
+    extern void paging_cow_test(void);
+    paging_cow_test();
+}
+
+static void kernel_cmd_reboot(const char* args) {
+    UNUSED(args);
+    console_write("Rebooting system...\n");
+    console_write("(Use Ctrl+Alt+Del in QEMU or close window)\n");
+    // 実際のリブートは複雑なので、メッセージのみ表示
+}
+
+/* コマンド実行（カーネルモード版） */
+static void execute_shell_command(const char* command) {
+    if (command[0] == '\0') {
+        return;  // 空のコマンド - 何もしない
     }
-    else {
+
+    if (shell_dispatch(kernel_commands, kernel_command_count, command) != 0) {
         console_write("Unknown command: '");
         console_write(command);
         console_write("'\n");
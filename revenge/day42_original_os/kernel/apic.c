@@ -7,6 +7,11 @@
 #include <stdbool.h>
 #include "task.h" // For current_task and task_t, schedule(), full_context_t
 #include "idt.h"    // For struct registers (GPR part)
+#include "gdt.h"    // For gdt_ptr (APs reload the kernel GDT)
+#include "fpu.h"    // For fpu_on_context_switch (lazy FPU switching)
+#include "io.h"     // For outb (masking the legacy 8259 PICs)
+
+extern struct idt_ptr idt_ptr_struct; // Defined in idt.c; APs lidt the same IDT
 
 // Static inline memcpy to avoid dependency on standard library or other modules
 static inline void* local_memcpy(void *dest, const void *src, size_t n) {
@@ -58,9 +63,121 @@ inline void wrmsr(uint32_t msr, uint64_t value) {
 }
 */
 
+// --- Tickless operation via TSC-deadline mode ---
+// The fixed periodic tick runs the full schedule() path even on an idle
+// core -- pure overhead interrupts and hlt wakeups. When the CPU supports
+// TSC-deadline mode (CPUID.1:ECX[24]) the timer switches over after a short
+// calibration window: the handler re-arms a one-shot deadline only while
+// there is runnable work, and an idle core stays genuinely dormant until
+// sched_enqueue() kicks a new deadline in.
+#define IA32_TSC_DEADLINE_MSR 0x6E0
+#define TICKLESS_CALIBRATION_TICKS 16 // Periodic ticks used to measure TSC per tick
+
+bool tsc_deadline_supported = false;  // Set in init_apic from CPUID
+static bool tickless_active = false;  // Calibration done, tsc_per_tick valid
+static uint64_t tsc_per_tick = 0;     // TSC cycles per scheduler quantum
+static uint64_t tickless_calib_start = 0;
+static uint64_t tickless_calib_ticks = 0;
+static volatile uint8_t tickless_armed[SMP_MAX_CPUS];
+// Whether a CPU's own LVT timer has been switched to TSC-deadline mode.
+// The LVT is a per-CPU register, so each core flips its own on its first
+// tick after calibration; until then it keeps ticking periodically.
+static volatile uint8_t tickless_lvt_on[SMP_MAX_CPUS];
+
+static inline uint64_t read_tsc(void) {
+    uint32_t lo, hi;
+    asm volatile ("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static void lapic_tickless_arm(void) {
+    tickless_armed[smp_current_cpu_index()] = 1;
+    wrmsr(IA32_TSC_DEADLINE_MSR, read_tsc() + tsc_per_tick);
+}
+
+// Send a fixed-delivery IPI to one LAPIC (physical destination, edge).
+static void lapic_send_ipi(uint32_t lapic_id, uint8_t vector) {
+    if (x2apic_enabled) {
+        // x2APIC: one MSR write, destination in the high dword.
+        wrmsr(APIC_MSR_ICR, ((uint64_t)lapic_id << 32) |
+                            ICR_DELIVERY_MODE_FIXED | vector);
+    } else {
+        lapic_mmio_write(XAPIC_REG_ICR_HIGH, lapic_id << 24);
+        lapic_mmio_write(XAPIC_REG_ICR_LOW, ICR_DELIVERY_MODE_FIXED | vector);
+        while (lapic_mmio_read(XAPIC_REG_ICR_LOW) & ICR_DELIVERY_STATUS_PENDING) {
+            asm volatile("pause"); // xAPIC: wait until the ICR accepts reuse
+        }
+    }
+}
+
+// Wake `cpu` if its tickless deadline is disarmed. Called by sched_enqueue()
+// right after placing a task on that CPU's run queue. The calling CPU can
+// re-arm its own deadline directly; IA32_TSC_DEADLINE is not writable
+// cross-CPU, so a dormant remote core gets the timer vector as a fixed IPI
+// instead — its timer_handler then sees the queued work and re-arms itself.
+void lapic_tickless_kick(uint32_t cpu) {
+    if (cpu >= SMP_MAX_CPUS || !tickless_lvt_on[cpu]) {
+        return; // Still periodic (or uncalibrated): the next tick comes anyway
+    }
+    if (tickless_armed[cpu]) {
+        return;
+    }
+    if (cpu == smp_current_cpu_index()) {
+        lapic_tickless_arm();
+        return;
+    }
+    tickless_armed[cpu] = 1; // Suppress duplicate IPIs; timer_handler re-evaluates
+    lapic_send_ipi(smp_cpus[cpu].lapic_id, 32);
+}
+
+// Runs at the top of every tick. The BSP measures the TSC across
+// TICKLESS_CALIBRATION_TICKS periodic quanta (one CPU's ticks give a clean
+// measurement; all LAPIC timers are programmed identically); once
+// tsc_per_tick is known, each core — BSP and APs alike — flips its own LVT
+// timer into TSC-deadline mode on its next tick.
+static void lapic_tickless_on_tick(void) {
+    if (!tsc_deadline_supported) {
+        return;
+    }
+    uint32_t cpu = smp_current_cpu_index();
+    if (tickless_lvt_on[cpu]) {
+        return;
+    }
+
+    if (!tickless_active) {
+        if (cpu != 0) {
+            return; // Calibration is BSP-only; keep ticking periodically
+        }
+        if (tickless_calib_ticks == 0) {
+            tickless_calib_start = read_tsc();
+        }
+        if (++tickless_calib_ticks <= TICKLESS_CALIBRATION_TICKS) {
+            return;
+        }
+        tsc_per_tick = (read_tsc() - tickless_calib_start) / TICKLESS_CALIBRATION_TICKS;
+        tickless_active = true;
+        print_serial_str_int(SERIAL_COM1_BASE,
+                             "LAPIC timer: TSC-deadline (tickless) mode, cycles/tick: ",
+                             tsc_per_tick);
+    }
+
+    uint32_t lvt = 32 | LVT_TIMER_MODE_TSC_DEADLINE; // Vector 32, unmasked
+    if (x2apic_enabled) {
+        wrmsr(APIC_MSR_LVT_TIMER, lvt);
+    } else {
+        lapic_mmio_write(XAPIC_REG_LVT_TIMER, lvt);
+    }
+    // SDM: serialize between changing the timer mode and the first write
+    // to IA32_TSC_DEADLINE, or the write may be ignored.
+    asm volatile ("mfence" ::: "memory");
+    tickless_lvt_on[cpu] = 1;
+    lapic_tickless_arm();
+}
+
 // Called by the common IRQ handler
 void timer_handler(struct registers *regs) {
     tick_counter++;
+    lapic_tickless_on_tick();
 
     task_t *old_task = current_task;
     full_context_t* old_ctx_ptr = NULL;
@@ -107,14 +224,56 @@ void timer_handler(struct registers *regs) {
             load_cr3(new_ctx_ptr->cr3);
         }
         // Note: TSS.RSP0 was already set by schedule() for current_task->kernel_stack_top
+
+        // Arm lazy FPU switching: sets CR0.TS unless current_task already
+        // owns the FPU registers, so vector state is only saved/restored
+        // when the incoming task actually uses it (#NM path in fpu.c).
+        fpu_on_context_switch(current_task);
     }
     // If old_task == current_task, or current_task is NULL, no context switch happens here.
     // The original registers (potentially GPRs saved to old_task->context but not switched from)
     // will be popped by the assembly stub, and iretq will resume the interrupted task or spin.
 
+    // Tickless re-arm: only schedule another interrupt if this core has
+    // actual work. An idle core goes dormant until sched_enqueue kicks it.
+    if (tickless_lvt_on[smp_current_cpu_index()]) {
+        uint32_t cpu = smp_current_cpu_index();
+        bool have_work = cpu_run_queues[cpu].count > 0 ||
+                         (current_task != NULL && current_task != idle_tasks[cpu]);
+        if (have_work) {
+            lapic_tickless_arm();
+        } else {
+            tickless_armed[cpu] = 0;
+            wrmsr(IA32_TSC_DEADLINE_MSR, 0); // Explicit disarm
+        }
+    }
+
     lapic_send_eoi();
 }
 
+// Software-enable the LAPIC of the CPU we are currently running on by
+// setting SVR.APIC_ENABLE and the spurious vector. Works in both xAPIC
+// (MMIO, each CPU sees its own LAPIC at the same physical window) and
+// x2APIC (MSR) mode. Returns the SVR value written.
+static uint32_t lapic_sw_enable(void) {
+    uint32_t svr_value = 0;
+    uint32_t spurious_vector = 0xFF;
+    uint32_t svr_enable_flag = SVR_APIC_ENABLE;
+
+    if (x2apic_enabled) {
+        svr_value = (uint32_t)rdmsr(APIC_MSR_SVR);
+        svr_value |= svr_enable_flag; // Enable APIC bit
+        svr_value = (svr_value & ~SVR_VECTOR_MASK) | spurious_vector; // Set spurious vector
+        wrmsr(APIC_MSR_SVR, svr_value);
+    } else {
+        svr_value = lapic_mmio_read(XAPIC_REG_SVR);
+        svr_value |= svr_enable_flag; // Enable APIC bit
+        svr_value = (svr_value & ~SVR_VECTOR_MASK) | spurious_vector; // Set spurious vector
+        lapic_mmio_write(XAPIC_REG_SVR, svr_value);
+    }
+    return svr_value;
+}
+
 void init_apic(struct limine_smp_response *smp_info) {
     if (smp_info == NULL || smp_info->cpu_count == 0) {
         print_serial(SERIAL_COM1_BASE, "Error: SMP info not available\n");
@@ -183,22 +342,18 @@ void init_apic(struct limine_smp_response *smp_info) {
     print_serial_str_hex(SERIAL_COM1_BASE, "LAPIC Version Register: ", version_reg);
 
     // Enable the LAPIC by setting the Spurious Interrupt Vector Register (SVR)
-    uint32_t svr_value = 0;
-    uint32_t spurious_vector = 0xFF;
-    uint32_t svr_enable_flag = SVR_APIC_ENABLE;
+    uint32_t svr_value = lapic_sw_enable();
+    print_serial_str_hex(SERIAL_COM1_BASE, "SVR after enabling: ", svr_value);
 
-    if (x2apic_enabled) {
-        svr_value = (uint32_t)rdmsr(APIC_MSR_SVR);
-        svr_value |= svr_enable_flag; // Enable APIC bit
-        svr_value = (svr_value & ~SVR_VECTOR_MASK) | spurious_vector; // Set spurious vector
-        wrmsr(APIC_MSR_SVR, svr_value);
-    } else {
-        svr_value = lapic_mmio_read(XAPIC_REG_SVR);
-        svr_value |= svr_enable_flag; // Enable APIC bit
-        svr_value = (svr_value & ~SVR_VECTOR_MASK) | spurious_vector; // Set spurious vector
-        lapic_mmio_write(XAPIC_REG_SVR, svr_value);
+    // Detect TSC-deadline timer support (CPUID.1:ECX bit 24). The timer
+    // still starts periodic below; lapic_tickless_on_tick switches modes
+    // once it has calibrated TSC cycles per tick against that period.
+    {
+        uint32_t eax, ebx, ecx, edx;
+        asm volatile ("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(1), "c"(0));
+        tsc_deadline_supported = (ecx & (1U << 24)) != 0;
+        print_serial_str_int(SERIAL_COM1_BASE, "TSC-deadline timer supported: ", tsc_deadline_supported);
     }
-    print_serial_str_hex(SERIAL_COM1_BASE, "SVR after enabling: ", svr_value);
 
     // Configure the LAPIC timer
     #define TIMER_IRQ_VECTOR 32
@@ -212,6 +367,160 @@ void init_apic(struct limine_smp_response *smp_info) {
     print_serial_str_int(SERIAL_COM1_BASE, " and divide value index ", divide_value);
 
     print_serial(SERIAL_COM1_BASE, "LAPIC initialized successfully.\n");
+
+    // Bring the application processors online now that the BSP's LAPIC,
+    // IDT and paging are all in their final state.
+    init_smp_aps(smp_info);
+}
+
+// --- SMP Application Processor bring-up (Limine SMP protocol) ---
+
+smp_cpu_t smp_cpus[SMP_MAX_CPUS];
+static volatile uint64_t smp_online_count = 1; // BSP counts as online
+
+// Set by the BSP (main.c) once the run queues and per-CPU idle tasks exist.
+// APs park on this before unmasking their timer: taking a scheduler tick
+// while idle_tasks[] is still being built would dereference NULL tasks.
+volatile int smp_scheduler_ready = 0;
+
+uint64_t smp_online_cpu_count(void) {
+    return smp_online_count;
+}
+
+uint32_t smp_current_cpu_index(void) {
+    // Fast path: the per-CPU block caches the index, turning this into a
+    // single %gs-relative load instead of a LAPIC-ID read plus table scan
+    // (rdmsr alone costs more than the whole %gs access).
+    if (percpu_ready) {
+        return percpu_cpu_index();
+    }
+
+    uint32_t lapic_id;
+    if (x2apic_enabled) {
+        lapic_id = (uint32_t)rdmsr(APIC_MSR_ID);
+    } else if (apic_virt_base != 0) {
+        lapic_id = lapic_mmio_read(XAPIC_REG_ID) >> 24; // xAPIC keeps the ID in bits 24-31
+    } else {
+        return 0; // LAPIC not reachable yet (early boot): we are the BSP
+    }
+
+    for (uint32_t i = 0; i < SMP_MAX_CPUS; i++) {
+        if (smp_cpus[i].online && smp_cpus[i].lapic_id == lapic_id) {
+            return i;
+        }
+    }
+    return 0; // Unknown ID (pre-init_smp_aps): treat as CPU 0
+}
+
+// Entry point for each AP. Limine jumps here in 64-bit mode on a private
+// bootstrap stack with its own page tables, passing our limine_smp_info in
+// RDI. extra_argument carries the CPU's index into smp_cpus[].
+static void smp_ap_entry(struct limine_smp_info *info) {
+    uint64_t cpu_index = info->extra_argument;
+
+    // 1. Switch from Limine's page tables to the kernel PML4.
+    load_cr3((uint64_t)kernel_pml4_phys);
+
+    // 2. Load the kernel GDT and reload segment registers (CS via lretq,
+    //    since Limine's selectors need not match our GDT layout).
+    asm volatile(
+        "lgdt %0\n\t"
+        "pushq $0x08\n\t"
+        "leaq 1f(%%rip), %%rax\n\t"
+        "pushq %%rax\n\t"
+        "lretq\n\t"
+        "1:\n\t"
+        "movw $0x10, %%ax\n\t"
+        "movw %%ax, %%ds\n\t"
+        "movw %%ax, %%es\n\t"
+        "movw %%ax, %%ss\n\t"
+        "movw %%ax, %%fs\n\t"
+        "movw %%ax, %%gs\n\t"
+        : : "m"(gdt_ptr) : "rax", "memory");
+    // Note: no ltr here. The TSS is still a single BSP structure; loading
+    // it on a second CPU would set its busy bit twice and #GP. Per-CPU TSS
+    // comes with the per-CPU run queue work.
+
+    // 3. Point GS at this CPU's per-CPU block. Must come right after the
+    //    segment reload above (which resets the GS base to 0) and before
+    //    anything that reads current_task or smp_current_cpu_index().
+    init_percpu((uint32_t)cpu_index);
+
+    // 4. Load the shared kernel IDT.
+    asm volatile("lidt %0" : : "m"(idt_ptr_struct));
+
+    // 5. Software-enable this CPU's LAPIC (SVR).
+    lapic_sw_enable();
+
+    // 6. Report in. The serial port is shared; keep the AP's output to one
+    //    short line to limit interleaving with the BSP.
+    smp_cpus[cpu_index].online = 1;
+    __sync_fetch_and_add(&smp_online_count, 1);
+    print_serial_str_int(SERIAL_COM1_BASE, "AP online: LAPIC ID ", info->lapic_id);
+
+    // 7. Wait (interrupts off) until the BSP has built the run queues and
+    //    per-CPU idle tasks; init_smp_aps runs before either exists.
+    while (!smp_scheduler_ready) {
+        asm volatile("pause");
+    }
+
+    // 8. Start this CPU's LAPIC timer like the BSP's and enable interrupts:
+    //    the first tick enters timer_handler/schedule(), which switches to
+    //    this CPU's idle task (or real work from its run queue) and never
+    //    returns to the bootstrap stack below. hlt keeps the core parked
+    //    between ticks until then.
+    lapic_timer_set(32 /* TIMER_IRQ_VECTOR */, 10000000, TIMER_DIVIDE_BY_16,
+                    LVT_TIMER_MODE_PERIODIC);
+    asm volatile("sti");
+    for (;;) {
+        asm volatile("hlt");
+    }
+}
+
+void init_smp_aps(struct limine_smp_response *smp_info) {
+    if (smp_info == NULL || smp_info->cpu_count <= 1) {
+        print_serial(SERIAL_COM1_BASE, "SMP: No application processors to start.\n");
+        return;
+    }
+
+    uint64_t cpu_count = smp_info->cpu_count;
+    if (cpu_count > SMP_MAX_CPUS) {
+        print_serial_str_int(SERIAL_COM1_BASE, "SMP: Capping CPU count to SMP_MAX_CPUS from ", (uint32_t)cpu_count);
+        cpu_count = SMP_MAX_CPUS;
+    }
+
+    print_serial_str_int(SERIAL_COM1_BASE, "SMP: Starting APs, total CPUs: ", (uint32_t)cpu_count);
+
+    for (uint64_t i = 0; i < cpu_count; i++) {
+        struct limine_smp_info *cpu = smp_info->cpus[i];
+
+        smp_cpus[i].processor_id = cpu->processor_id;
+        smp_cpus[i].lapic_id = cpu->lapic_id;
+
+        if (cpu->lapic_id == smp_info->bsp_lapic_id) {
+            smp_cpus[i].online = 1; // BSP is already running (that's us)
+            continue;
+        }
+
+        smp_cpus[i].online = 0;
+        cpu->extra_argument = i;
+        // Writing goto_address releases the AP from Limine's parking loop.
+        // The write must be visible before the AP polls it, hence the
+        // atomic store.
+        __atomic_store_n(&cpu->goto_address, smp_ap_entry, __ATOMIC_SEQ_CST);
+
+        // Wait (bounded) for the AP to check in before releasing the next
+        // one, so the serial log stays readable.
+        for (volatile uint64_t spin = 0; spin < 100000000ULL; spin++) {
+            if (smp_cpus[i].online) break;
+            asm volatile("pause");
+        }
+        if (!smp_cpus[i].online) {
+            print_serial_str_int(SERIAL_COM1_BASE, "SMP: Timeout waiting for AP with LAPIC ID ", cpu->lapic_id);
+        }
+    }
+
+    print_serial_str_int(SERIAL_COM1_BASE, "SMP: CPUs online: ", (uint32_t)smp_online_count);
 }
 
 void lapic_timer_set(uint32_t vector, uint64_t initial_count, uint32_t divide_config_index, uint64_t mode) {
@@ -241,3 +550,60 @@ void lapic_send_eoi() {
         lapic_mmio_write(XAPIC_REG_EOI, APIC_EOI_ACK); // Write any value (0 is fine)
     }
 }
+
+// --- I/O APIC ---
+// Legacy device interrupts (ISA IRQs like the COM1 UART on IRQ 4) reach the
+// LAPICs through the I/O APIC redirection table; nothing here is needed for
+// the LAPIC timer, which is why this only appears now that a device IRQ
+// (serial TX) is actually consumed. The single I/O APIC at the architectural
+// default physical base is assumed, which holds for QEMU's pc/q35 machines.
+
+#define IOAPIC_DEFAULT_PHYS_BASE 0xFEC00000ULL
+#define IOAPIC_REG_SELECT 0x00 // Register select window (IOREGSEL)
+#define IOAPIC_REG_WINDOW 0x10 // Register data window (IOWIN)
+#define IOAPIC_REDTBL_BASE 0x10 // Redirection entries: two 32-bit regs per GSI
+
+static uintptr_t ioapic_virt_base = 0;
+
+static void ioapic_write(uint8_t reg, uint32_t value) {
+    *(volatile uint32_t *)(ioapic_virt_base + IOAPIC_REG_SELECT) = reg;
+    *(volatile uint32_t *)(ioapic_virt_base + IOAPIC_REG_WINDOW) = value;
+}
+
+// Map the I/O APIC MMIO page on first use, mirroring the LAPIC MMIO mapping
+// done in init_paging (uncached, non-executable, HHDM address).
+static void ioapic_ensure_mapped(void) {
+    if (ioapic_virt_base != 0) {
+        return;
+    }
+    map_page(NULL, IOAPIC_DEFAULT_PHYS_BASE + hhdm_offset, IOAPIC_DEFAULT_PHYS_BASE,
+             PTE_PRESENT | PTE_WRITABLE | PTE_NO_EXECUTE | PTE_NO_CACHE_DISABLE,
+             "IOAPIC MMIO");
+    ioapic_virt_base = IOAPIC_DEFAULT_PHYS_BASE + hhdm_offset;
+
+    // The legacy 8259 PICs must stay quiet now that the I/O APIC delivers
+    // device interrupts; mask every line on both of them.
+    outb(0x21, 0xFF);
+    outb(0xA1, 0xFF);
+}
+
+// Route a global system interrupt to the given IDT vector on the calling
+// CPU's LAPIC (fixed delivery, physical destination, edge, active high --
+// the right shape for ISA IRQs like the UART).
+void ioapic_route_gsi(uint8_t gsi, uint8_t vector) {
+    ioapic_ensure_mapped();
+
+    uint32_t dest_lapic_id;
+    if (x2apic_enabled) {
+        dest_lapic_id = (uint32_t)rdmsr(APIC_MSR_ID);
+    } else {
+        dest_lapic_id = lapic_mmio_read(XAPIC_REG_ID) >> 24;
+    }
+
+    uint8_t reg = IOAPIC_REDTBL_BASE + gsi * 2;
+    ioapic_write(reg + 1, dest_lapic_id << 24); // Destination (bits 56-63)
+    ioapic_write(reg, vector);                  // Vector, everything else 0 = fixed/physical/edge/high/unmasked
+
+    print_serial_str_int(SERIAL_COM1_BASE, "IOAPIC: Routed GSI ", gsi);
+    print_serial_str_int(SERIAL_COM1_BASE, "  -> vector ", vector);
+}
@@ -97,10 +97,40 @@ extern volatile uint64_t tick_counter; // Global tick counter
 extern bool x2apic_enabled;
 extern uintptr_t apic_virt_base; // Virtual base address for MMIO (if xAPIC)
 
+// --- SMP ---
+#define SMP_MAX_CPUS 16 // Matches PMM_MAX_CPUS (per-CPU page caches)
+
+// Per-CPU bookkeeping filled in during AP bring-up
+typedef struct {
+    uint32_t processor_id;    // ACPI processor ID (from Limine)
+    uint32_t lapic_id;        // Local APIC ID
+    volatile uint32_t online; // Set by the AP itself once it is up
+} smp_cpu_t;
+
+extern smp_cpu_t smp_cpus[SMP_MAX_CPUS];
+
+// Set by the BSP once run queues and idle tasks exist; APs hold their timer
+// unmask (and thus their first schedule()) until this flips to 1.
+extern volatile int smp_scheduler_ready;
+
 // Function prototypes
 void init_apic(struct limine_smp_response *smp_info);
 void lapic_timer_set(uint32_t vector, uint64_t initial_count, uint32_t divide_value, uint64_t mode);
 void lapic_send_eoi(void);
+// Start all application processors via the Limine SMP protocol (goto_address).
+// Called at the end of init_apic on the BSP.
+void init_smp_aps(struct limine_smp_response *smp_info);
+uint64_t smp_online_cpu_count(void);
+// Index of the CPU we are running on (0 before SMP bring-up / on the BSP).
+// Maps the current LAPIC ID through smp_cpus[].
+uint32_t smp_current_cpu_index(void);
+// Route a global system interrupt (ISA IRQ number for the legacy devices)
+// through the I/O APIC to the given IDT vector on the calling CPU.
+void ioapic_route_gsi(uint8_t gsi, uint8_t vector);
+// Tickless mode: wake `cpu` if its deadline is disarmed — directly when it
+// is the calling CPU, via a timer-vector IPI otherwise. No-op while that
+// CPU's LVT timer is still periodic.
+void lapic_tickless_kick(uint32_t cpu);
 
 // MSR helper functions (defined static inline in msr.h)
 // uint64_t rdmsr(uint32_t msr); // Remove extern declaration
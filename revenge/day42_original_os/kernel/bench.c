@@ -0,0 +1,160 @@
+#include "bench.h"
+#include "main.h"
+#include "io.h"
+#include "pmm.h"
+#include "paging.h"
+#include "task.h"
+#include "prof.h"
+#include "serial.h"
+
+// Microbenchmarks for the paths we argue about when taking a new kernel
+// drop: PMM page alloc/free, map_page/unmap_page, scheduler context
+// switches and serial console throughput. Built only into BENCH_BUILD
+// images (see the `bench` target in the Makefile); the numbers land on
+// COM1 as BENCH|... lines that scripts/run_bench.sh files away.
+//
+// All timings are raw TSC cycles. The capture script records them as-is;
+// converting to wall time (if anyone cares) is an offline job, so the
+// kernel does not need to know its TSC frequency.
+
+// Scratch virtual address for the map/unmap benchmark. Far away from the
+// kernel image (-2 GiB region), the kernel stack and the HHDM.
+#define BENCH_MAP_VIRT 0xFFFF900000000000ULL
+
+// isa-debug-exit port (see QEMU_OPTS_BENCH in the Makefile). Writing value
+// v makes QEMU exit with status (v << 1) | 1.
+#define BENCH_QEMU_EXIT_PORT 0xF4
+
+static void bench_report(const char *name, uint64_t iters, uint64_t cycles) {
+    print_serial(SERIAL_COM1_BASE, "BENCH|");
+    print_serial(SERIAL_COM1_BASE, name);
+    print_serial(SERIAL_COM1_BASE, "|iters=");
+    print_serial_dec(SERIAL_COM1_BASE, iters);
+    print_serial(SERIAL_COM1_BASE, "|cycles=");
+    print_serial_dec(SERIAL_COM1_BASE, cycles);
+    print_serial(SERIAL_COM1_BASE, "|cyc_per_op=");
+    print_serial_dec(SERIAL_COM1_BASE, iters ? cycles / iters : 0);
+    print_serial(SERIAL_COM1_BASE, "\n");
+}
+
+// PMM single-page alloc/free round trips. Dominated by the per-CPU
+// magazine fast path, with periodic refills/drains against the global
+// stack — exactly the mix real allocation traffic sees.
+static void bench_pmm(void) {
+    const uint64_t iters = 100000;
+    uint64_t start = prof_begin();
+    for (uint64_t i = 0; i < iters; i++) {
+        void *page = pmm_alloc_page();
+        if (page == NULL) {
+            bench_report("pmm-alloc-free|OOM", i, prof_begin() - start);
+            return;
+        }
+        pmm_free_page(page);
+    }
+    bench_report("pmm-alloc-free", iters, prof_begin() - start);
+}
+
+// map_page + unmap_page of one scratch page: full table walk, PTE write,
+// invlpg on map, plus the walk and invlpg on unmap.
+static void bench_map_unmap(void) {
+    const uint64_t iters = 20000;
+    void *frame = pmm_alloc_page();
+    if (frame == NULL) {
+        bench_report("map-unmap|OOM", 0, 0);
+        return;
+    }
+
+    uint64_t start = prof_begin();
+    for (uint64_t i = 0; i < iters; i++) {
+        map_page(NULL, BENCH_MAP_VIRT, (uint64_t)frame,
+                 PTE_PRESENT | PTE_WRITABLE | PTE_NX, "bench");
+        unmap_page(NULL, BENCH_MAP_VIRT);
+    }
+    bench_report("map-unmap", iters, prof_begin() - start);
+
+    pmm_free_page(frame);
+}
+
+// --- Context-switch benchmark ---
+// Two spinner tasks share the run queue with the bench task; the timer
+// then round-robins all three. We count actual switches through the
+// existing PROF_EVENT_CTX_SWITCH counter over a fixed TSC window, so the
+// result reflects the real schedule()-plus-context-restore path, not a
+// synthetic register save/load loop.
+static volatile int bench_spin_stop = 0;
+
+static void bench_spin_task_main(void) {
+    while (!bench_spin_stop) {
+        asm volatile("pause");
+    }
+    current_task->state = TASK_STATE_TERMINATED;
+    while (1) {
+        asm volatile("hlt");
+    }
+}
+
+static void bench_ctx_switch(void) {
+    const uint64_t window_cycles = 2000000000ULL; // ~1s at 2 GHz
+
+    bench_spin_stop = 0;
+    task_t *spin_a = create_task("bench-spin-a", bench_spin_task_main,
+                                 (uint64_t)kernel_pml4_phys);
+    task_t *spin_b = create_task("bench-spin-b", bench_spin_task_main,
+                                 (uint64_t)kernel_pml4_phys);
+    if (spin_a == NULL || spin_b == NULL) {
+        bench_report("ctx-switch|no-tasks", 0, 0);
+        return;
+    }
+    sched_enqueue(spin_a);
+    sched_enqueue(spin_b);
+
+    prof_reset();
+    uint64_t start = prof_begin();
+    while (prof_begin() - start < window_cycles) {
+        asm volatile("pause"); // The bench task spins too, and gets preempted too
+    }
+    uint64_t switches = prof_event_count(PROF_EVENT_CTX_SWITCH);
+
+    // Reported as switches over the window; switches/sec falls out offline
+    // once the TSC frequency is known.
+    bench_report("ctx-switch", switches, window_cycles);
+
+    bench_spin_stop = 1; // Spinners terminate themselves at the next pass
+}
+
+// Serial console throughput: push a fixed byte count through the normal
+// write path (TX ring + THR-empty interrupt when enabled, polled
+// otherwise). This is the path every kernel log line takes.
+static void bench_serial(void) {
+    const uint64_t bytes = 16384;
+    uint64_t start = prof_begin();
+    for (uint64_t i = 0; i < bytes; i++) {
+        // 64-byte lines of '#' keep the output harmless to the parser.
+        write_serial_char(SERIAL_COM1_BASE, (i & 63) == 63 ? '\n' : '#');
+    }
+    uint64_t cycles = prof_begin() - start;
+    write_serial_char(SERIAL_COM1_BASE, '\n');
+    bench_report("serial-write", bytes, cycles);
+}
+
+void bench_task_main(void) {
+    print_serial(SERIAL_COM1_BASE, "\nBENCH|start\n");
+
+    bench_pmm();
+    bench_map_unmap();
+    bench_serial();
+    bench_ctx_switch(); // Last: it perturbs the run queue and resets prof
+
+    print_serial(SERIAL_COM1_BASE, "BENCH|done\n");
+
+    // Give the serial TX ring time to drain, then exit QEMU so the capture
+    // script gets its prompt back.
+    for (volatile int i = 0; i < 50000000; i++) { asm volatile("pause"); }
+    outb(BENCH_QEMU_EXIT_PORT, 0);
+
+    // If isa-debug-exit is absent (manual run), just park.
+    current_task->state = TASK_STATE_TERMINATED;
+    while (1) {
+        asm volatile("hlt");
+    }
+}
@@ -0,0 +1,13 @@
+#ifndef KERNEL_BENCH_H
+#define KERNEL_BENCH_H
+
+// --- In-kernel microbenchmarks (BENCH_BUILD images only) ---
+// Entry point for the "bench" task that `make bench` boots: runs the PMM
+// alloc/free, map_page/unmap_page, context-switch and serial-throughput
+// benchmarks, emits one machine-parseable line per result over COM1
+// (format: BENCH|<name>|iters=<n>|cycles=<total>|cyc_per_op=<avg>) and
+// then exits QEMU through the isa-debug-exit device so the capture script
+// (scripts/run_bench.sh) terminates cleanly.
+void bench_task_main(void);
+
+#endif // KERNEL_BENCH_H
@@ -0,0 +1,174 @@
+#include "fpu.h"
+#include "pmm.h"
+#include "paging.h"
+#include "serial.h"
+#include "main.h" // For print_serial etc.
+#include <stddef.h>
+
+// The task whose state currently lives in the FPU registers (BSP only for
+// now; becomes per-CPU together with the rest of the per-CPU data work).
+static task_t *fpu_owner = NULL;
+
+static int xsave_supported = 0;
+static uint64_t xcr0_mask = 0; // Feature mask enabled in XCR0 (x87|SSE|AVX as available)
+
+// --- CR0/CR4/XCR0 helpers ---
+
+static inline uint64_t read_cr0(void) {
+    uint64_t v;
+    asm volatile("mov %%cr0, %0" : "=r"(v));
+    return v;
+}
+
+static inline void write_cr0(uint64_t v) {
+    asm volatile("mov %0, %%cr0" : : "r"(v) : "memory");
+}
+
+static inline uint64_t read_cr4(void) {
+    uint64_t v;
+    asm volatile("mov %%cr4, %0" : "=r"(v));
+    return v;
+}
+
+static inline void write_cr4(uint64_t v) {
+    asm volatile("mov %0, %%cr4" : : "r"(v) : "memory");
+}
+
+static inline void clts(void) {
+    asm volatile("clts");
+}
+
+static inline void xsetbv(uint32_t xcr, uint64_t value) {
+    asm volatile("xsetbv" : : "c"(xcr), "a"((uint32_t)value), "d"((uint32_t)(value >> 32)));
+}
+
+static inline void cpuid(uint32_t leaf, uint32_t subleaf,
+                         uint32_t *a, uint32_t *b, uint32_t *c, uint32_t *d) {
+    asm volatile("cpuid"
+                 : "=a"(*a), "=b"(*b), "=c"(*c), "=d"(*d)
+                 : "a"(leaf), "c"(subleaf));
+}
+
+#define CR0_TS (1ULL << 3)
+#define CR4_OSFXSR     (1ULL << 9)
+#define CR4_OSXMMEXCPT (1ULL << 10)
+#define CR4_OSXSAVE    (1ULL << 18)
+#define CPUID_1_ECX_XSAVE (1U << 26)
+#define CPUID_1_ECX_AVX   (1U << 28)
+#define XCR0_X87 (1ULL << 0)
+#define XCR0_SSE (1ULL << 1)
+#define XCR0_AVX (1ULL << 2)
+
+// --- Save/restore primitives ---
+
+static void fpu_save_state(void *area) {
+    if (xsave_supported) {
+        asm volatile("xsave (%0)" : : "r"(area),
+                     "a"((uint32_t)xcr0_mask), "d"((uint32_t)(xcr0_mask >> 32)) : "memory");
+    } else {
+        asm volatile("fxsave (%0)" : : "r"(area) : "memory");
+    }
+}
+
+static void fpu_restore_state(void *area) {
+    if (xsave_supported) {
+        asm volatile("xrstor (%0)" : : "r"(area),
+                     "a"((uint32_t)xcr0_mask), "d"((uint32_t)(xcr0_mask >> 32)) : "memory");
+    } else {
+        asm volatile("fxrstor (%0)" : : "r"(area) : "memory");
+    }
+}
+
+// Allocate and map one zeroed frame for a task's save area. A page is more
+// than any XSAVE layout we enable (x87+SSE+AVX is 832 bytes) and gives the
+// 64-byte alignment XSAVE demands for free. The zeroing matters: XSAVE
+// requires a zeroed XSAVE header on first use.
+static void *fpu_alloc_state_area(void) {
+    uint64_t phys = (uint64_t)pmm_alloc_page();
+    if (phys == 0) return NULL;
+    uint64_t virt = phys + hhdm_offset;
+    map_page(NULL, virt, phys, PTE_PRESENT | PTE_WRITABLE | PTE_NO_EXECUTE, "FPU State");
+    zero_page((void *)virt);
+    return (void *)virt;
+}
+
+// #NM (Device Not Available) handler: the lazy-switch slow path. Runs once
+// per task per "FPU epoch", not once per context switch.
+static void fpu_nm_handler(struct registers *regs) {
+    (void)regs;
+
+    clts(); // Make the FPU usable again before touching any state
+
+    task_t *task = current_task;
+    if (task == NULL) {
+        print_serial(SERIAL_COM1_BASE, "#NM with no current task! Halting.\n");
+        asm volatile("cli; hlt");
+    }
+
+    if (fpu_owner == task) {
+        return; // Spurious (TS set but state already ours): clts was enough
+    }
+
+    // Evict the previous owner's live registers into its save area.
+    if (fpu_owner != NULL && fpu_owner->fpu_state != NULL) {
+        fpu_save_state(fpu_owner->fpu_state);
+    }
+
+    if (task->fpu_state == NULL) {
+        // First FPU/SIMD instruction this task has ever executed.
+        task->fpu_state = fpu_alloc_state_area();
+        if (task->fpu_state == NULL) {
+            print_serial(SERIAL_COM1_BASE, "fpu: Failed to allocate save area! Halting.\n");
+            asm volatile("cli; hlt");
+        }
+        // Fresh, defined state instead of whatever the last owner left.
+        asm volatile("fninit");
+        uint32_t mxcsr = 0x1F80; // Reset value: all exceptions masked
+        asm volatile("ldmxcsr %0" : : "m"(mxcsr));
+    } else {
+        fpu_restore_state(task->fpu_state);
+    }
+
+    fpu_owner = task;
+}
+
+void fpu_on_context_switch(task_t *next) {
+    if (next != NULL && next == fpu_owner) {
+        // Incoming task already owns the registers: no trap needed.
+        write_cr0(read_cr0() & ~CR0_TS);
+    } else {
+        // Arm the lazy trap; integer-only tasks never hit it.
+        write_cr0(read_cr0() | CR0_TS);
+    }
+}
+
+void init_fpu(void) {
+    uint32_t a, b, c, d;
+    cpuid(1, 0, &a, &b, &c, &d);
+
+    // SSE support is architectural on x86_64; enable FXSAVE and SIMD FP exceptions.
+    write_cr4(read_cr4() | CR4_OSFXSR | CR4_OSXMMEXCPT);
+
+    if (c & CPUID_1_ECX_XSAVE) {
+        write_cr4(read_cr4() | CR4_OSXSAVE);
+        xcr0_mask = XCR0_X87 | XCR0_SSE;
+        if (c & CPUID_1_ECX_AVX) {
+            xcr0_mask |= XCR0_AVX;
+        }
+        xsetbv(0, xcr0_mask);
+        xsave_supported = 1;
+        print_serial_str_hex(SERIAL_COM1_BASE, "fpu: XSAVE enabled, XCR0 = 0x", xcr0_mask);
+    } else {
+        xsave_supported = 0;
+        print_serial(SERIAL_COM1_BASE, "fpu: XSAVE not supported, using FXSAVE/FXRSTOR.\n");
+    }
+
+    asm volatile("fninit"); // Defined x87 state for the boot CPU
+
+    register_interrupt_handler(7, fpu_nm_handler); // #NM: lazy-switch slow path
+
+    // No task owns the FPU yet; the first vector instruction after the
+    // first context switch takes the #NM path.
+    write_cr0(read_cr0() | CR0_TS);
+    print_serial(SERIAL_COM1_BASE, "fpu: Lazy FPU switching armed (CR0.TS).\n");
+}
@@ -0,0 +1,26 @@
+#ifndef KERNEL_FPU_H
+#define KERNEL_FPU_H
+
+#include <stdint.h>
+#include "task.h" // For task_t
+#include "idt.h"  // For struct registers
+
+// --- Lazy FPU/SIMD context switching ---
+// GPR context switching stays eager (cheap); the ~0.5-2KiB of x87/SSE/AVX
+// state is switched lazily via CR0.TS: every task switch sets TS, and the
+// first FPU/SIMD instruction of the incoming task traps #NM (vector 7),
+// where we save the previous owner's state and restore (or lazily allocate)
+// the new owner's. Integer-only tasks never pay for vector state at all.
+//
+// Uses XSAVE/XRSTOR when the CPU supports it (CR4.OSXSAVE + XCR0 set up in
+// init_fpu), falling back to FXSAVE/FXRSTOR otherwise.
+
+// Set up CR4 (OSFXSR/OSXMMEXCPT, and OSXSAVE+XCR0 when available) and
+// register the #NM handler. Call after init_idt.
+void init_fpu(void);
+
+// Called from the context-switch path when the running task changes.
+// Arms CR0.TS unless the incoming task already owns the FPU.
+void fpu_on_context_switch(task_t *next);
+
+#endif // KERNEL_FPU_H
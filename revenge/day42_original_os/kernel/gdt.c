@@ -61,6 +61,14 @@ void init_gdt(void) {
     // Granularity: G=1 (4KiB pages), D/B=1 (32-bit default, but L=0 here)
     set_gdt_entry(GDT_ENTRY_KERNEL_DATA, 0, 0xFFFFF, 0x92, 0xCF); // 0xCF -> G=1, Sz=1, L=0, AVL=0
 
+    // User Data Segment (DS, SS) - Selector 0x18 (RPL 3 -> 0x1B)
+    // Access: P=1, DPL=3, S=1, Type=Writable (0xF2)
+    set_gdt_entry(GDT_ENTRY_USER_DATA, 0, 0xFFFFF, 0xF2, 0xCF);
+
+    // User Code Segment (CS) - Selector 0x20 (RPL 3 -> 0x23)
+    // Access: P=1, DPL=3, S=1, Type=Executable, Readable (0xFA); L=1 for 64-bit
+    set_gdt_entry(GDT_ENTRY_USER_CODE, 0, 0xFFFFF, 0xFA, 0xAF);
+
     // Initialize TSS structure - Added back
     tss.rsp0 = 0; // Placeholder, will be set later by tss_set_rsp0
     tss.iomap_base = sizeof(struct tss_packed); // No I/O map
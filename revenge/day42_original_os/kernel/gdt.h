@@ -6,8 +6,10 @@
 // Basic GDT Entry Indices (adjust if user entries were planned)
 #define GDT_ENTRY_KERNEL_CODE 1
 #define GDT_ENTRY_KERNEL_DATA 2
-// #define GDT_ENTRY_USER_CODE   3 // Not used yet
-// #define GDT_ENTRY_USER_DATA   4 // Not used yet
+// User segments, ordered data-then-code so sysret's fixed STAR[63:48]+8 (SS)
+// and +16 (CS) offsets land on them (see init_syscall in syscall.c).
+#define GDT_ENTRY_USER_DATA   3
+#define GDT_ENTRY_USER_CODE   4
 #define GDT_ENTRY_TSS_LOW     5 // TSS Descriptor (Lower 8 bytes)
 #define GDT_ENTRY_TSS_HIGH    6 // TSS Descriptor (Upper 8 bytes)
 
@@ -52,6 +54,9 @@ struct gdt_ptr_packed {
     uint64_t base;         // Address of GDT
 } __attribute__((packed));
 
+// GDT pointer (defined in gdt.c); APs reload the same GDT via lgdt during SMP bring-up.
+extern struct gdt_ptr_packed gdt_ptr;
+
 // Function prototype for GDT initialization
 void init_gdt(void);
 
@@ -7,6 +7,8 @@
 #include "paging.h" // For PAGING_HHDM_OFFSET
 #include "main.h"   // For serial printing
 #include "apic.h"   // For lapic_send_eoi and tick_counter
+#include "vmm.h"    // For vmm_handle_page_fault (demand paging)
+#include "prof.h"   // Cycle counters for interrupt dispatch
 
 // For serial printing, temporary
 // Ideally, we should have a proper logging/panic system
@@ -64,11 +66,13 @@ static void idt_set_gate(uint8_t num, uint64_t base, uint16_t sel, uint8_t flags
 // Called from the assembly ISR common stub
 void isr_handler_c(struct registers *regs) {
     // For now, print a message to serial port. Later, call registered C handler.
+    uint64_t prof_start = prof_begin();
 
     // If it's a page fault, call the dedicated handler
     if (regs->int_no == 14) {
         page_fault_c_handler(regs);
-        return; // page_fault_c_handler halts, so this is mostly for clarity
+        prof_end(PROF_EVENT_PAGE_FAULT, prof_start);
+        return; // page_fault_c_handler halts on real faults
     }
 
     print_serial_idt(SERIAL_COM1_BASE_IDT, "Interrupt Received: ");
@@ -91,6 +95,7 @@ void isr_handler_c(struct registers *regs) {
         // For unhandled interrupts, especially exceptions, it's often best to halt.
         asm volatile ("cli; hlt");
     }
+    prof_end(PROF_EVENT_EXCEPTION, prof_start);
 }
 
 // Placeholder C handlers for specific exceptions
@@ -122,12 +127,34 @@ static void general_protection_fault_handler(struct registers* regs) {
 // The assembly stub for ISR 14 is expected to push the error code and then call this handler,
 // passing a pointer to the stack where registers (including error code) are saved.
 void page_fault_c_handler(struct registers *regs) { // err_code is now part of struct registers
-    (void)regs; // Suppress unused parameter warning
-    // Temporarily disable all serial output to isolate the issue
-    /*
     uint64_t faulting_address;
     asm volatile("mov %%cr2, %0" : "=r"(faulting_address));
 
+    // Demand paging: lazily-backed regions get their frame allocated and
+    // mapped here on first touch (and CoW-broken on first write to the
+    // shared zero page). On success, simply return and retry the access.
+    if (vmm_handle_page_fault(faulting_address, regs->err_code) == 0) {
+        return;
+    }
+
+    // Not a lazy region: this is a real fault. Report and halt.
+    print_serial_idt(SERIAL_COM1_BASE_IDT, "\n--- PAGE FAULT (#14) ---\n");
+    DBG_IDT(faulting_address); // Using DBG macro
+    DBG_IDT(regs->err_code);   // Accessing err_code from struct registers
+    DBG_IDT(regs->rip);
+
+    print_serial_idt(SERIAL_COM1_BASE_IDT, "  Error Code Breakdown: ");
+    if (regs->err_code & 0x1) print_serial_idt(SERIAL_COM1_BASE_IDT, "P ");   // Present
+    else print_serial_idt(SERIAL_COM1_BASE_IDT, "~P ");
+    if (regs->err_code & 0x2) print_serial_idt(SERIAL_COM1_BASE_IDT, "W ");   // Write
+    else print_serial_idt(SERIAL_COM1_BASE_IDT, "R ");
+    if (regs->err_code & 0x4) print_serial_idt(SERIAL_COM1_BASE_IDT, "U ");   // User
+    else print_serial_idt(SERIAL_COM1_BASE_IDT, "S ");
+    if (regs->err_code & 0x8) print_serial_idt(SERIAL_COM1_BASE_IDT, "RSVD "); // Reserved Write
+    if (regs->err_code & 0x10) print_serial_idt(SERIAL_COM1_BASE_IDT, "I/D"); // Instruction Fetch
+    print_serial_idt(SERIAL_COM1_BASE_IDT, "\n");
+
+    /*
     print_serial_idt(SERIAL_COM1_BASE_IDT, "\n--- PAGE FAULT (#14) ---");
     DBG_IDT(faulting_address); // Using DBG macro
     DBG_IDT(regs->err_code);   // Accessing err_code from struct registers
@@ -215,6 +242,7 @@ void interrupt_handler_c(struct registers *regs) {
 // Hardware interrupts (IRQs) typically do not push an error code.
 void irq_handler_c(struct registers regs) {
     // IRQ numbers are typically int_no - 32
+    uint64_t prof_start = prof_begin();
     uint8_t irq_num = regs.int_no - 32;
 
     if (irq_handlers[irq_num] != NULL) {
@@ -236,6 +264,7 @@ void irq_handler_c(struct registers regs) {
     // For now, specific handlers will send EOI.
     // If it was a PIC interrupt that got here unhandled, we might need to send EOI to PIC.
     // lapic_send_eoi(); // Moved to specific handler
+    prof_end(PROF_EVENT_IRQ, prof_start);
 }
 
 // Timer interrupt handler (IRQ 0, Vector 32)
@@ -0,0 +1,205 @@
+#include "ipc.h"
+#include "pmm.h"
+#include "paging.h"
+#include "kmalloc.h"
+#include "main.h"
+#include "klog.h"
+
+// Zero-copy SPSC ring IPC (see ipc.h for the protocol).
+//
+// Memory-ordering notes: head is only written by the producer, tail only by
+// the consumer, so each side reads the other's index as a plain volatile
+// load and publishes its own with a full barrier *after* the data bytes are
+// in place. Indices are free-running byte counts (masked on access), which
+// keeps full/empty unambiguous without sacrificing a slot.
+//
+// The blocking path reuses the scheduler's parking pattern: the consumer
+// marks itself WAITING and hlt-spins; at the next tick schedule() saves its
+// context, moves it to PARKED and does not re-enqueue it, so the core moves
+// on to other work. The producer's commit wakes it through the two-phase
+// handshake in task.h: a PARKED consumer is flipped to READY and
+// sched_enqueue()d (which also kicks a tickless core's deadline timer); a
+// consumer still WAITING — registers live on its CPU until the next tick —
+// is only flipped to READY, and its own CPU finishes the wake.
+
+ipc_ring_t *ipc_ring_create(uint64_t order) {
+    ipc_ring_t *ring = (ipc_ring_t *)kmalloc(sizeof(ipc_ring_t));
+    if (!ring) {
+        KLOG_ERROR("ipc: ring header alloc failed, order", order);
+        return NULL;
+    }
+    memset(ring, 0, sizeof(ipc_ring_t));
+
+    void *phys = pmm_alloc_pages(order);
+    if (!phys) {
+        KLOG_ERROR("ipc: ring buffer alloc failed, order", order);
+        kfree(ring);
+        return NULL;
+    }
+
+    uint64_t pages = 1ULL << order;
+    uint64_t virt = (uint64_t)phys + hhdm_offset;
+    // The HHDM is not blanket-mapped in the kernel PML4, so make the buffer
+    // pages visible to every task sharing the kernel address space.
+    map_range(NULL, virt, (uint64_t)phys, pages,
+              PTE_PRESENT | PTE_WRITABLE | PTE_NX, "ipc_ring");
+
+    ring->buf = (uint8_t *)virt;
+    ring->size = pages * PAGE_SIZE;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->consumer = NULL;
+    ring->consumer_waiting = 0;
+    return ring;
+}
+
+// --- Producer side ---
+
+uint64_t ipc_ring_produce_reserve(ipc_ring_t *ring, uint64_t want, void **out) {
+    uint64_t head = ring->head;
+    uint64_t free_bytes = ring->size - (head - ring->tail);
+    if (free_bytes == 0) {
+        *out = NULL;
+        return 0;
+    }
+
+    uint64_t idx = head & (ring->size - 1);
+    uint64_t contiguous = ring->size - idx; // Bytes until the wrap point
+    uint64_t grant = want;
+    if (grant > free_bytes) grant = free_bytes;
+    if (grant > contiguous) grant = contiguous;
+
+    *out = &ring->buf[idx];
+    return grant;
+}
+
+void ipc_ring_produce_commit(ipc_ring_t *ring, uint64_t len) {
+    // Data bytes must be globally visible before the new head is.
+    __sync_synchronize();
+    ring->head = ring->head + len;
+    __sync_synchronize();
+
+    // Wake a parked consumer. test-and-set on the flag makes the wakeup
+    // fire exactly once even if commits race ahead of the consumer's park.
+    if (__sync_lock_test_and_set(&ring->consumer_waiting, 0)) {
+        task_t *consumer = ring->consumer;
+        if (consumer == NULL) return;
+
+        // Only a PARKED task (context saved, off the run queues — see
+        // task.h) may be made runnable here. If the consumer is still
+        // WAITING its registers are live on another CPU: flip it to READY
+        // and let that CPU finish the wake (the consumer exits its spin,
+        // or its next tick's schedule() re-enqueues it). Enqueueing now
+        // would let a second CPU switch into the stale saved context.
+        // WAITING is tried first: it can only advance to PARKED (by the
+        // consumer CPU's schedule()), so a failed first CAS means the park
+        // completed and the second CAS cannot lose.
+        if (__sync_bool_compare_and_swap(&consumer->state,
+                                         TASK_STATE_WAITING,
+                                         TASK_STATE_READY)) {
+            return; // Consumer's own CPU completes the wake
+        }
+        if (__sync_bool_compare_and_swap(&consumer->state,
+                                         TASK_STATE_PARKED,
+                                         TASK_STATE_READY)) {
+            if (sched_enqueue(consumer) != 0) {
+                KLOG_ERROR("ipc: consumer wakeup enqueue failed, pid", consumer->pid);
+            }
+        }
+    }
+}
+
+// --- Consumer side ---
+
+uint64_t ipc_ring_consume_peek(ipc_ring_t *ring, void **out) {
+    uint64_t tail = ring->tail;
+    uint64_t used = ring->head - tail;
+    if (used == 0) {
+        *out = NULL;
+        return 0;
+    }
+    // head was published after the data; make sure our data reads happen
+    // after the head read that made them visible.
+    __sync_synchronize();
+
+    uint64_t idx = tail & (ring->size - 1);
+    uint64_t contiguous = ring->size - idx;
+    uint64_t grant = (used < contiguous) ? used : contiguous;
+
+    *out = &ring->buf[idx];
+    return grant;
+}
+
+void ipc_ring_consume_release(ipc_ring_t *ring, uint64_t len) {
+    // The consumer must be done reading the span before the producer may
+    // overwrite it.
+    __sync_synchronize();
+    ring->tail = ring->tail + len;
+}
+
+// --- Copying convenience wrappers ---
+
+uint64_t ipc_ring_write(ipc_ring_t *ring, const void *data, uint64_t len) {
+    const uint8_t *src = (const uint8_t *)data;
+    uint64_t done = 0;
+    while (done < len) {
+        void *span;
+        uint64_t n = ipc_ring_produce_reserve(ring, len - done, &span);
+        if (n == 0) break; // Ring full: SPSC writers don't block
+        memcpy(span, src + done, n);
+        ipc_ring_produce_commit(ring, n);
+        done += n;
+    }
+    return done;
+}
+
+uint64_t ipc_ring_read(ipc_ring_t *ring, void *data, uint64_t len) {
+    uint8_t *dst = (uint8_t *)data;
+    uint64_t done = 0;
+    while (done < len) {
+        void *span;
+        uint64_t n = ipc_ring_consume_peek(ring, &span);
+        if (n == 0) break;
+        if (n > len - done) n = len - done;
+        memcpy(dst + done, span, n);
+        ipc_ring_consume_release(ring, n);
+        done += n;
+    }
+    return done;
+}
+
+uint64_t ipc_ring_read_blocking(ipc_ring_t *ring, void *data, uint64_t len) {
+    for (;;) {
+        uint64_t n = ipc_ring_read(ring, data, len);
+        if (n > 0) return n;
+
+        // Empty: park. Publish the waiting flag *before* the final empty
+        // re-check so a producer committing in between sees it and wakes us
+        // (classic lost-wakeup ordering).
+        ring->consumer = current_task;
+        current_task->state = TASK_STATE_WAITING;
+        __sync_lock_test_and_set(&ring->consumer_waiting, 1);
+
+        if (ring->head != ring->tail) {
+            // Data arrived during the window; un-park ourselves if the
+            // producer didn't already consume the flag.
+            if (__sync_lock_test_and_set(&ring->consumer_waiting, 0)) {
+                current_task->state = TASK_STATE_RUNNING;
+                continue;
+            }
+            // The producer owns the wake; fall through and wait for it so
+            // the state machine keeps a single writer per transition.
+        }
+
+        // Spin until a wake moves us out of WAITING/PARKED (see task.h).
+        // Two ways out: the producer finds us PARKED (context saved by a
+        // tick) and re-enqueues us, so we resume via schedule() already
+        // RUNNING — or it finds us still WAITING, flips us to READY, and
+        // we observe that right here without ever leaving this CPU.
+        while (current_task->state == TASK_STATE_WAITING ||
+               current_task->state == TASK_STATE_PARKED) {
+            asm volatile("sti; hlt");
+        }
+        current_task->state = TASK_STATE_RUNNING;
+    }
+}
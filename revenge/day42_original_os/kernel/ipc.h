@@ -0,0 +1,59 @@
+#ifndef KERNEL_IPC_H
+#define KERNEL_IPC_H
+
+#include <stdint.h>
+#include "task.h"
+
+// --- Zero-copy SPSC ring IPC ---
+// Single-producer/single-consumer byte rings for task pipelines. The ring
+// storage is PMM pages mapped at their HHDM alias via map_page, visible to
+// both tasks (all tasks currently share the kernel address space). Head and
+// tail are written by exactly one side each, so the indices need no lock --
+// just release-ordered stores.
+//
+// Zero-copy protocol (no staging copy through the kernel):
+//   producer: ipc_ring_produce_reserve() -> write into the returned span
+//             -> ipc_ring_produce_commit()
+//   consumer: ipc_ring_consume_peek() -> read from the returned span
+//             -> ipc_ring_consume_release()
+// Spans are contiguous; at the wrap point a span is shorter than the free/
+// used total, and the caller simply does another reserve/peek round.
+//
+// ipc_ring_write/ipc_ring_read are convenience copy wrappers on top, and
+// ipc_ring_read_blocking parks the consumer via the scheduler (state
+// WAITING, off the run queues) instead of spinning when the ring is empty.
+
+typedef struct ipc_ring {
+    uint8_t *buf;            // Ring storage (HHDM-mapped PMM pages)
+    uint64_t size;           // Bytes, power of two
+    volatile uint64_t head;  // Total bytes produced (producer-owned)
+    volatile uint64_t tail;  // Total bytes consumed (consumer-owned)
+    task_t *consumer;        // Parked consumer, if any (for the wakeup)
+    volatile int consumer_waiting;
+} ipc_ring_t;
+
+// Allocate a ring with 2^order pages of storage. NULL on allocation failure.
+ipc_ring_t *ipc_ring_create(uint64_t order);
+
+// Producer side: reserve up to `want` contiguous writable bytes. Returns the
+// usable span length (0 if the ring is full) and points *out at it.
+uint64_t ipc_ring_produce_reserve(ipc_ring_t *ring, uint64_t want, void **out);
+// Publish `len` bytes previously written into a reserved span and wake a
+// parked consumer.
+void ipc_ring_produce_commit(ipc_ring_t *ring, uint64_t len);
+
+// Consumer side: peek at the contiguous readable span (0 if empty).
+uint64_t ipc_ring_consume_peek(ipc_ring_t *ring, void **out);
+// Retire `len` consumed bytes.
+void ipc_ring_consume_release(ipc_ring_t *ring, uint64_t len);
+
+// Copying convenience wrappers. Both are non-blocking and return the number
+// of bytes actually moved.
+uint64_t ipc_ring_write(ipc_ring_t *ring, const void *data, uint64_t len);
+uint64_t ipc_ring_read(ipc_ring_t *ring, void *data, uint64_t len);
+
+// Like ipc_ring_read, but parks the calling task via the scheduler until at
+// least one byte is available. Only the (single) consumer may call this.
+uint64_t ipc_ring_read_blocking(ipc_ring_t *ring, void *data, uint64_t len);
+
+#endif // KERNEL_IPC_H
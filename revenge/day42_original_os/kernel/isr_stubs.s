@@ -13,6 +13,13 @@
 // Common stub for all ISRs
 .global isr_common_stub
 isr_common_stub:
+    // If we interrupted user mode (CS RPL != 0), switch to the kernel GS
+    // base so %gs-relative per-CPU accesses hit this CPU's percpu block.
+    // Stack here: [rsp]=int_no, +8=err_code, +16=RIP, +24=CS.
+    test byte ptr [rsp + 24], 3
+    jz 1f
+    swapgs
+1:
     // Save all general purpose registers that are not saved by the CPU
     push rax; push rbx; push rcx; push rdx
     push rsi; push rdi; push rbp
@@ -31,6 +38,11 @@ isr_common_stub:
     pop rbp; pop rdi; pop rsi
     pop rdx; pop rcx; pop rbx; pop rax
 
+    // Mirror the entry swapgs when returning to user mode.
+    test byte ptr [rsp + 24], 3
+    jz 2f
+    swapgs
+2:
     add rsp, 16 # Clean up interrupt number and error code from stack (pushed by macro or CPU+macro)
 
     iretq // Return from interrupt
@@ -110,6 +122,11 @@ irq\num:
 
 // Common stub for IRQs
 irq_common_stub:
+    // Same user-mode GS handling as isr_common_stub (CS at rsp+24 here too).
+    test byte ptr [rsp + 24], 3
+    jz 3f
+    swapgs
+3:
     // Save all general purpose registers not saved by CPU
     push r15
     push r14
@@ -147,6 +164,10 @@ irq_common_stub:
     pop r14
     pop r15
 
+    test byte ptr [rsp + 24], 3
+    jz 4f
+    swapgs
+4:
     add rsp, 16       // Clean up vector number and dummy error code from stack
     sti                         // Re-enable interrupts (IF SET BEFORE THIS INTERRUPT)
     iretq                       // Return from interrupt
@@ -0,0 +1,93 @@
+#include "klog.h"
+#include "serial.h"
+#include "main.h" // For print_serial, print_serial_hex, print_serial_dec
+
+// --- Deferred in-memory kernel log (see klog.h) ---
+//
+// Writers reserve a slot with an atomic fetch-and-add on klog_write_seq, fill
+// it, then publish by storing seq = ticket + 1 into the slot. The single
+// reader (klog_flush, run from the idle loop) checks that published seq: if
+// it does not match the ticket it expects, the slot is mid-write or has been
+// lapped, and the reader skips it rather than printing torn data. No locks,
+// no UART access on the write side.
+
+static klog_entry_t klog_ring[KLOG_RING_ENTRIES];
+static volatile uint64_t klog_write_seq = 0; // Next ticket to hand out
+static uint64_t klog_read_seq = 0;           // Next ticket the reader expects
+static uint64_t klog_dropped = 0;            // Entries lost to overrun
+static volatile int klog_flush_lock = 0;     // One drainer at a time
+
+static const char *klog_level_names[] = { "DEBUG", "INFO ", "WARN ", "ERROR" };
+
+static inline uint64_t klog_rdtsc(void) {
+    uint32_t lo, hi;
+    asm volatile ("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+void klog(uint8_t level, const char *msg, uint64_t value) {
+    uint64_t ticket = __sync_fetch_and_add(&klog_write_seq, 1);
+    klog_entry_t *slot = &klog_ring[ticket & (KLOG_RING_ENTRIES - 1)];
+
+    slot->tsc = klog_rdtsc();
+    slot->value = value;
+    slot->msg = msg;
+    slot->level = level;
+    __sync_synchronize();   // Entry body must be visible before the publish
+    slot->seq = ticket + 1; // Publish: reader now trusts this slot
+}
+
+uint64_t klog_dropped_count(void) {
+    return klog_dropped;
+}
+
+// Print one published entry. Format:
+//   [<tsc-hex>] LEVEL msg 0x<value>
+static void klog_print_entry(const klog_entry_t *e) {
+    print_serial(SERIAL_COM1_BASE, "[");
+    print_serial_hex(SERIAL_COM1_BASE, e->tsc);
+    print_serial(SERIAL_COM1_BASE, "] ");
+    print_serial(SERIAL_COM1_BASE, klog_level_names[e->level & 3]);
+    print_serial(SERIAL_COM1_BASE, " ");
+    print_serial(SERIAL_COM1_BASE, e->msg);
+    print_serial(SERIAL_COM1_BASE, " 0x");
+    print_serial_hex(SERIAL_COM1_BASE, e->value);
+    print_serial(SERIAL_COM1_BASE, "\n");
+}
+
+void klog_flush(void) {
+    // Multiple idle tasks (one per CPU) call this; only one drains at a time
+    // and the rest just return instead of spinning.
+    if (__sync_lock_test_and_set(&klog_flush_lock, 1) != 0) {
+        return;
+    }
+
+    for (;;) {
+        uint64_t write = klog_write_seq;
+        if (klog_read_seq == write) {
+            break; // Drained
+        }
+
+        // Writers lapped us: everything older than one ring's worth is
+        // already overwritten. Jump forward and account for the loss.
+        if (write - klog_read_seq > KLOG_RING_ENTRIES) {
+            klog_dropped += (write - klog_read_seq) - KLOG_RING_ENTRIES;
+            klog_read_seq = write - KLOG_RING_ENTRIES;
+        }
+
+        klog_entry_t *slot = &klog_ring[klog_read_seq & (KLOG_RING_ENTRIES - 1)];
+        // Copy out before printing: the UART is slow and a writer may reuse
+        // the slot while we drain it.
+        klog_entry_t copy = *slot;
+        __sync_synchronize();
+        if (copy.seq == klog_read_seq + 1) {
+            klog_print_entry(&copy);
+        } else {
+            // Slot is mid-write or already recycled; count it as dropped.
+            klog_dropped++;
+        }
+        klog_read_seq++;
+    }
+
+    __sync_lock_release(&klog_flush_lock);
+}
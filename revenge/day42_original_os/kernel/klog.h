@@ -0,0 +1,60 @@
+#ifndef KERNEL_KLOG_H
+#define KERNEL_KLOG_H
+
+#include <stdint.h>
+
+// --- Deferred in-memory kernel log ---
+// print_serial busy-waits on the UART (~87us per character at 115200 baud),
+// which is far too slow for the PMM fast path or schedule(). klog() instead
+// records a fixed-size binary entry (TSC timestamp, level, message pointer,
+// one value) into a lock-free ring and returns in a handful of cycles; the
+// idle task drains the ring to serial via klog_flush() when nothing better
+// is runnable.
+//
+// The message must be a string literal / static string: only the pointer is
+// stored, nothing is formatted or copied on the hot path.
+
+// Log levels, in increasing severity.
+#define KLOG_LEVEL_DEBUG 0
+#define KLOG_LEVEL_INFO  1
+#define KLOG_LEVEL_WARN  2
+#define KLOG_LEVEL_ERROR 3
+
+// Compile-time floor: call sites below this level compile to nothing
+// (the level check is a constant, so the whole statement folds away).
+// Override with -DKLOG_COMPILE_LEVEL=KLOG_LEVEL_INFO for release builds.
+#ifndef KLOG_COMPILE_LEVEL
+#define KLOG_COMPILE_LEVEL KLOG_LEVEL_DEBUG
+#endif
+
+#define KLOG_DEBUG(msg, val) do { if (KLOG_COMPILE_LEVEL <= KLOG_LEVEL_DEBUG) klog(KLOG_LEVEL_DEBUG, (msg), (val)); } while (0)
+#define KLOG_INFO(msg, val)  do { if (KLOG_COMPILE_LEVEL <= KLOG_LEVEL_INFO)  klog(KLOG_LEVEL_INFO,  (msg), (val)); } while (0)
+#define KLOG_WARN(msg, val)  do { if (KLOG_COMPILE_LEVEL <= KLOG_LEVEL_WARN)  klog(KLOG_LEVEL_WARN,  (msg), (val)); } while (0)
+#define KLOG_ERROR(msg, val) do { if (KLOG_COMPILE_LEVEL <= KLOG_LEVEL_ERROR) klog(KLOG_LEVEL_ERROR, (msg), (val)); } while (0)
+
+// Ring capacity in entries. Power of two (index math is a mask).
+#define KLOG_RING_ENTRIES 1024
+
+// One ring slot. 'seq' is written last (release) so the reader can detect
+// a slot it raced with and skip it instead of printing torn data.
+typedef struct klog_entry {
+    volatile uint64_t seq; // Ticket of the writer that owns this slot + 1
+    uint64_t tsc;          // rdtsc at the call site
+    uint64_t value;        // The one logged value (address, count, pid, ...)
+    const char *msg;       // Static string; pointer only, never copied
+    uint8_t level;         // KLOG_LEVEL_*
+    uint8_t pad[7];
+} klog_entry_t;
+
+// Record one entry. Never blocks, never touches the UART; safe from
+// interrupt handlers and from multiple CPUs concurrently.
+void klog(uint8_t level, const char *msg, uint64_t value);
+
+// Drain pending entries to COM1. Called from the idle loop; also safe to
+// call explicitly (e.g. right before a panic halt) to get the tail out.
+void klog_flush(void);
+
+// Entries lost to ring overrun since boot (writers lapped the reader).
+uint64_t klog_dropped_count(void);
+
+#endif // KERNEL_KLOG_H
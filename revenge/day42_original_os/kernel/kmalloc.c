@@ -0,0 +1,137 @@
+#include "kmalloc.h"
+#include "slab.h"
+#include "pmm.h"
+#include "paging.h"
+#include "serial.h"
+#include "main.h" // For print_serial etc.
+
+// Size classes are powers of two from 32B to 4KiB; the 16-byte header is
+// included in the class size, so e.g. a 24-byte request lands in the 64B
+// bin (24 + 16 = 40 > 32).
+#define KMALLOC_NUM_BINS    8
+#define KMALLOC_MIN_CLASS   32
+#define KMALLOC_MAX_CLASS   4096 // == PAGE_SIZE; beyond this we go to pmm_alloc_pages
+
+#define KMALLOC_MAGIC 0x4B4D414C // "KMAL"
+
+// Prepended to every block, 16 bytes so payloads keep SLAB_MIN_ALIGN alignment.
+typedef struct kmalloc_header {
+    uint32_t magic;
+    uint8_t  bin;      // Bin index for slab-backed blocks
+    uint8_t  is_pages; // 1 if backed by pmm_alloc_pages
+    uint16_t order;    // Page order for page-backed blocks
+    uint64_t usable;   // Payload bytes available past the header
+} kmalloc_header_t;
+
+static slab_cache_t kmalloc_bins[KMALLOC_NUM_BINS];
+static const char *kmalloc_bin_names[KMALLOC_NUM_BINS] = {
+    "kmalloc-32", "kmalloc-64", "kmalloc-128", "kmalloc-256",
+    "kmalloc-512", "kmalloc-1024", "kmalloc-2048", "kmalloc-4096",
+};
+static int kmalloc_initialized = 0;
+
+static void kmalloc_copy(void *dest, const void *src, size_t n) {
+    memcpy(dest, src, n);
+}
+
+static void kmalloc_init(void) {
+    uint64_t class_size = KMALLOC_MIN_CLASS;
+    for (int i = 0; i < KMALLOC_NUM_BINS; i++) {
+        slab_cache_init(&kmalloc_bins[i], kmalloc_bin_names[i], class_size, NULL);
+        class_size <<= 1;
+    }
+    kmalloc_initialized = 1;
+    print_serial(SERIAL_COM1_BASE, "kmalloc: Size-class bins 32B..4KiB ready.\n");
+}
+
+void *kmalloc(size_t size) {
+    if (size == 0) return NULL;
+    if (!kmalloc_initialized) kmalloc_init();
+
+    uint64_t total = size + sizeof(kmalloc_header_t);
+
+    if (total <= KMALLOC_MAX_CLASS) {
+        // Small path: smallest power-of-two bin that fits header + payload.
+        int bin = 0;
+        uint64_t class_size = KMALLOC_MIN_CLASS;
+        while (class_size < total) {
+            class_size <<= 1;
+            bin++;
+        }
+
+        kmalloc_header_t *hdr = (kmalloc_header_t *)slab_alloc(&kmalloc_bins[bin]);
+        if (hdr == NULL) return NULL;
+        hdr->magic = KMALLOC_MAGIC;
+        hdr->bin = (uint8_t)bin;
+        hdr->is_pages = 0;
+        hdr->order = 0;
+        hdr->usable = class_size - sizeof(kmalloc_header_t);
+        return (void *)(hdr + 1);
+    }
+
+    // Large path: contiguous run from the PMM, mapped at its HHDM address.
+    uint64_t pages = (total + PAGE_SIZE - 1) / PAGE_SIZE;
+    uint64_t order = 0;
+    while ((1ULL << order) < pages) order++;
+
+    uint64_t phys = (uint64_t)pmm_alloc_pages(order);
+    if (phys == 0) {
+        print_serial_str_hex(SERIAL_COM1_BASE, "kmalloc: No contiguous run for order 0x", order);
+        return NULL;
+    }
+    uint64_t virt = phys + hhdm_offset;
+    map_range(NULL, virt, phys, 1ULL << order, PTE_PRESENT | PTE_WRITABLE | PTE_NO_EXECUTE, "kmalloc pages");
+
+    kmalloc_header_t *hdr = (kmalloc_header_t *)virt;
+    hdr->magic = KMALLOC_MAGIC;
+    hdr->bin = 0;
+    hdr->is_pages = 1;
+    hdr->order = (uint16_t)order;
+    hdr->usable = ((1ULL << order) * PAGE_SIZE) - sizeof(kmalloc_header_t);
+    return (void *)(hdr + 1);
+}
+
+void kfree(void *ptr) {
+    if (ptr == NULL) return;
+
+    kmalloc_header_t *hdr = ((kmalloc_header_t *)ptr) - 1;
+    if (hdr->magic != KMALLOC_MAGIC) {
+        print_serial_str_hex(SERIAL_COM1_BASE, "kfree: Bad magic for block at 0x", (uint64_t)ptr);
+        return; // Refuse to free something we did not hand out
+    }
+    hdr->magic = 0; // Catch double frees on the next kfree
+
+    if (hdr->is_pages) {
+        pmm_free_pages((void *)((uint64_t)hdr - hhdm_offset), hdr->order);
+    } else {
+        slab_free(&kmalloc_bins[hdr->bin], hdr);
+    }
+}
+
+size_t kmalloc_usable_size(void *ptr) {
+    if (ptr == NULL) return 0;
+    kmalloc_header_t *hdr = ((kmalloc_header_t *)ptr) - 1;
+    if (hdr->magic != KMALLOC_MAGIC) return 0;
+    return hdr->usable;
+}
+
+void *krealloc(void *ptr, size_t size) {
+    if (ptr == NULL) return kmalloc(size);
+    if (size == 0) {
+        kfree(ptr);
+        return NULL;
+    }
+
+    size_t old_usable = kmalloc_usable_size(ptr);
+    if (old_usable >= size) {
+        return ptr; // Current block already big enough
+    }
+
+    void *new_ptr = kmalloc(size);
+    if (new_ptr == NULL) {
+        return NULL; // Old block stays valid
+    }
+    kmalloc_copy(new_ptr, ptr, old_usable);
+    kfree(ptr);
+    return new_ptr;
+}
@@ -0,0 +1,24 @@
+#ifndef KERNEL_KMALLOC_H
+#define KERNEL_KMALLOC_H
+
+#include <stdint.h>
+#include <stddef.h> // For size_t, NULL
+
+// --- General kernel heap ---
+// Byte-granular allocator on top of the PMM:
+//   - small requests come from power-of-two size-class bins (32B..4KiB),
+//     each bin a slab cache, so sub-page structures stop wasting frames
+//   - large requests use pmm_alloc_pages() (contiguous, naturally aligned)
+// Every block carries a 16-byte header in front of the returned pointer so
+// kfree()/krealloc() know the block's bin or page order.
+
+void *kmalloc(size_t size);
+void kfree(void *ptr);
+// Resize a block. Contents are preserved up to min(old, new) size. Returns
+// NULL (leaving the old block intact) if the new allocation fails.
+void *krealloc(void *ptr, size_t size);
+
+// Usable bytes of an allocated block (>= the requested size). 0 for NULL.
+size_t kmalloc_usable_size(void *ptr);
+
+#endif // KERNEL_KMALLOC_H
@@ -9,6 +9,13 @@
 #include "apic.h"
 #include "font.h"
 #include "task.h"
+#include "vmm.h"
+#include "fpu.h"
+#include "syscall.h"
+#include "kmalloc.h" // For the console shadow buffer
+#include "prof.h"    // For prof_begin (boot timeline timestamps)
+#include "ipc.h"     // TaskA -> TaskB shared-memory ring demo
+#include "bench.h"   // In-kernel microbenchmarks (BENCH_BUILD images)
 #include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
@@ -40,8 +47,159 @@ extern uint64_t kernel_stack_top_phys; // Re-add TSS related extern
 // This needs to be updated if the framebuffer address is virtualized after paging.
 static struct limine_framebuffer *current_framebuffer = NULL;
 
+// --- Console shadow buffer (double buffering) ---
+// The Limine framebuffer is write-combining MMIO, so per-pixel stores are
+// painfully slow. All drawing targets this system-RAM copy instead; a dirty
+// rectangle tracks what changed and console_flush() copies only those rows
+// out to the real framebuffer in wide 64-bit bursts. Until init_fbcon()
+// runs (or if its allocation fails) fb_shadow stays NULL and drawing falls
+// back to writing the framebuffer directly, exactly as before.
+static uint32_t *fb_shadow = NULL;
+static uint64_t fb_pitch_px = 0; // Pitch in 32-bit pixels (shadow shares the fb's pitch)
+static bool fb_dirty = false;
+static uint64_t fb_dirty_x0, fb_dirty_y0, fb_dirty_x1, fb_dirty_y1; // Inclusive pixel bounds
+
+// Where drawing goes: the shadow buffer when it exists, the framebuffer otherwise.
+static inline uint32_t *console_target(void) {
+    return fb_shadow != NULL ? fb_shadow : (uint32_t *)framebuffer->address;
+}
+
+// Grow the dirty rectangle to cover [x0..x1] x [y0..y1] (inclusive, pixels).
+static void console_mark_dirty(uint64_t x0, uint64_t y0, uint64_t x1, uint64_t y1) {
+    if (!fb_dirty) {
+        fb_dirty_x0 = x0; fb_dirty_y0 = y0;
+        fb_dirty_x1 = x1; fb_dirty_y1 = y1;
+        fb_dirty = true;
+        return;
+    }
+    if (x0 < fb_dirty_x0) fb_dirty_x0 = x0;
+    if (y0 < fb_dirty_y0) fb_dirty_y0 = y0;
+    if (x1 > fb_dirty_x1) fb_dirty_x1 = x1;
+    if (y1 > fb_dirty_y1) fb_dirty_y1 = y1;
+}
+
+// Copy the dirty rows of the shadow buffer to the framebuffer and clear the
+// dirty rectangle. The span is widened to an even pixel boundary so each
+// row moves as 64-bit (two-pixel) stores into the MMIO aperture.
+void console_flush(void) {
+    if (fb_shadow == NULL || !fb_dirty) {
+        return;
+    }
+
+    uint64_t x0 = fb_dirty_x0 & ~1ULL;           // Round down to even pixel
+    uint64_t x1 = fb_dirty_x1 | 1ULL;            // Round up to odd pixel
+    if (x1 >= framebuffer->width) x1 = framebuffer->width - 1;
+    uint64_t y1 = fb_dirty_y1;
+    if (y1 >= framebuffer->height) y1 = framebuffer->height - 1;
+
+    uint32_t *fb_ptr = (uint32_t *)framebuffer->address;
+    for (uint64_t y = fb_dirty_y0; y <= y1; y++) {
+        uint64_t *src = (uint64_t *)&fb_shadow[y * fb_pitch_px + x0];
+        uint64_t *dst = (uint64_t *)&fb_ptr[y * fb_pitch_px + x0];
+        uint64_t qwords = (x1 - x0 + 2) / 2;
+        asm volatile ("rep movsq" : "+D"(dst), "+S"(src), "+c"(qwords) : : "memory");
+    }
+
+    fb_dirty = false;
+}
+
+// Allocate the shadow buffer (one full frame of system RAM) and seed it with
+// the framebuffer's current contents so the first partial flush is coherent.
+// Needs kmalloc, so this runs in kernel_main_after_paging, not _start.
+void init_fbcon(void) {
+    if (framebuffer == NULL || framebuffer->address == NULL) {
+        return;
+    }
+    fb_pitch_px = framebuffer->pitch / (framebuffer->bpp / 8);
+
+    uint64_t size = framebuffer->height * framebuffer->pitch;
+    fb_shadow = (uint32_t *)kmalloc(size);
+    if (fb_shadow == NULL) {
+        print_serial(SERIAL_COM1_BASE, "fbcon: Shadow buffer allocation failed, drawing directly.\n");
+        return;
+    }
+
+    uint64_t *src = (uint64_t *)framebuffer->address;
+    uint64_t *dst = (uint64_t *)fb_shadow;
+    for (uint64_t i = 0; i < size / 8; i++) {
+        dst[i] = src[i];
+    }
+    fb_dirty = false;
+    print_serial_str_hex(SERIAL_COM1_BASE, "fbcon: Shadow buffer at V: ", (uint64_t)fb_shadow);
+}
+
+// --- Boot timeline ---
+// TSC timestamp per init milestone, printed as a table once boot settles.
+// Costs one rdtsc and two stores per mark, so marks are safe to sprinkle
+// even through the early pre-paging path.
+#define BOOT_MARKS_MAX 32
+static struct {
+    const char *name;
+    uint64_t tsc;
+} boot_marks[BOOT_MARKS_MAX];
+static int boot_mark_count = 0;
+
+void boot_mark(const char *name) {
+    if (boot_mark_count < BOOT_MARKS_MAX) {
+        boot_marks[boot_mark_count].name = name;
+        boot_marks[boot_mark_count].tsc = prof_begin();
+        boot_mark_count++;
+    }
+}
+
+// Print every milestone with cycles since boot (first mark) and since the
+// previous milestone -- the second column is where regressions show up.
+void boot_timeline_dump(void) {
+    print_serial(SERIAL_COM1_BASE, "--- Boot timeline (cycles) ---\n");
+    print_serial(SERIAL_COM1_BASE, "milestone  since-boot  since-prev\n");
+    for (int i = 0; i < boot_mark_count; i++) {
+        print_serial(SERIAL_COM1_BASE, boot_marks[i].name);
+        print_serial(SERIAL_COM1_BASE, "  ");
+        print_serial_dec(SERIAL_COM1_BASE, boot_marks[i].tsc - boot_marks[0].tsc);
+        print_serial(SERIAL_COM1_BASE, "  ");
+        print_serial_dec(SERIAL_COM1_BASE, i > 0 ? boot_marks[i].tsc - boot_marks[i - 1].tsc : 0);
+        print_serial(SERIAL_COM1_BASE, "\n");
+    }
+}
+
+// --- Deferred initialization ---
+// Init steps the boot-critical path does not need (console shadow buffer,
+// debug facilities) are queued here and run by a one-shot kernel task once
+// the scheduler is live, so they stop adding to worst-case time-to-failover.
+#define DEFERRED_INITS_MAX 8
+static struct {
+    void (*fn)(void);
+    const char *name;
+} deferred_inits[DEFERRED_INITS_MAX];
+static int deferred_init_count = 0;
+
+void deferred_init_register(void (*fn)(void), const char *name) {
+    if (deferred_init_count < DEFERRED_INITS_MAX) {
+        deferred_inits[deferred_init_count].fn = fn;
+        deferred_inits[deferred_init_count].name = name;
+        deferred_init_count++;
+    }
+}
+
+// Body of the one-shot "deferred" task: run every queued step, close the
+// boot timeline, then terminate (schedule() drops TERMINATED tasks).
+static void deferred_init_task_main(void) {
+    for (int i = 0; i < deferred_init_count; i++) {
+        deferred_inits[i].fn();
+        boot_mark(deferred_inits[i].name);
+    }
+    boot_mark("boot-complete");
+    boot_timeline_dump();
+
+    current_task->state = TASK_STATE_TERMINATED;
+    for (;;) {
+        asm volatile ("hlt"); // Until the next tick deschedules us for good
+    }
+}
+
 // Kernel entry point
 void _start(void) {
+    boot_mark("entry");
     // struct kernel_addr kernel_addresses; // Local struct is fine // <- REMOVE THIS LINE
 
     // Honor Limine requests (accessing static volatiles is okay)
@@ -59,6 +217,9 @@ void _start(void) {
     if (init_serial(SERIAL_COM1_BASE) != 0) { /* Handle error? */ }
     print_serial(SERIAL_COM1_BASE, "Serial port initialized.\n");
 
+    init_string_ops(); // Pick memcpy/memset fast paths (ERMS probe)
+    boot_mark("serial");
+
     // Print Limine info (using helpers that call correct print_serial)
     print_serial_str_hex(SERIAL_COM1_BASE, "HHDM Offset: ", hhdm_offset);
     // ... other print calls ...
@@ -67,8 +228,11 @@ void _start(void) {
 
     // Initialize GDT, IDT, PMM
     init_gdt();
+    boot_mark("gdt");
     init_idt();
+    boot_mark("idt-early");
     init_pmm(memmap_request.response);
+    boot_mark("pmm");
     print_serial(SERIAL_COM1_BASE, "PMM Initialized. Free pages: ");
     print_serial_dec(SERIAL_COM1_BASE, pmm_get_free_page_count());
     print_serial(SERIAL_COM1_BASE, "\n");
@@ -85,6 +249,7 @@ void _start(void) {
     struct limine_framebuffer *fb_for_kernel_main = framebuffer;
 
     print_serial(SERIAL_COM1_BASE, "Calling init_paging...\n");
+    boot_mark("paging-call");
 
     // Call init_paging with correct arguments
     init_paging(
@@ -100,11 +265,22 @@ void _start(void) {
 }
 
 // --- Dummy Task Functions ---
+// TaskA/TaskB now form a producer/consumer pipeline over a shared-memory
+// SPSC ring (kernel/ipc.c): TaskA writes bytes into the ring, TaskB drains
+// them to the serial console. While the ring is empty TaskB is parked off
+// the run queues (TASK_STATE_WAITING) instead of spinning.
+static ipc_ring_t *demo_ipc_ring = NULL;
+
 void dummy_task_a_main(void) {
     uint64_t counter = 0;
     while (1) {
-        if ((counter % 500000) == 0) { // Adjust frequency as needed
-            print_serial(SERIAL_COM1_BASE, "A");
+        if ((counter % 500000) == 0 && demo_ipc_ring) {
+            // Zero-copy path: write straight into the ring's storage.
+            void *span;
+            if (ipc_ring_produce_reserve(demo_ipc_ring, 1, &span) >= 1) {
+                *(char *)span = 'A';
+                ipc_ring_produce_commit(demo_ipc_ring, 1);
+            }
         }
         counter++;
         // Small delay to prevent spamming and allow observation
@@ -114,15 +290,17 @@ void dummy_task_a_main(void) {
 }
 
 void dummy_task_b_main(void) {
-    uint64_t counter = 0;
+    char buf[64];
     while (1) {
-        if ((counter % 500000) == 0) { // Adjust frequency as needed
-            print_serial(SERIAL_COM1_BASE, "B");
+        if (!demo_ipc_ring) {
+            asm volatile ("hlt");
+            continue;
+        }
+        // Blocks (parked via the scheduler) until TaskA commits bytes.
+        uint64_t n = ipc_ring_read_blocking(demo_ipc_ring, buf, sizeof(buf));
+        for (uint64_t i = 0; i < n; i++) {
+            write_serial_char(SERIAL_COM1_BASE, buf[i]);
         }
-        counter++;
-        // Small delay to prevent spamming and allow observation
-        for (volatile int i = 0; i < 1000; ++i) { asm volatile ("nop"); }
-        // asm volatile ("hlt");
     }
 }
 
@@ -135,6 +313,12 @@ void kernel_main_after_paging(struct limine_framebuffer *fb_info, uint64_t new_r
         current_framebuffer->address = (void *)((uint64_t)current_framebuffer->address + hhdm_offset);
     }
 
+    boot_mark("higher-half");
+
+    // The console works (slower) without its shadow buffer, so that setup
+    // is off the boot-critical path and runs once the scheduler is live.
+    deferred_init_register(init_fbcon, "fbcon(deferred)");
+
     clear_screen_with_color(COLOR_DARK_SLATE_GRAY);
     set_text_color(COLOR_LIGHT_CYAN);
     set_bg_color(COLOR_DARK_SLATE_GRAY);
@@ -157,14 +341,43 @@ void kernel_main_after_paging(struct limine_framebuffer *fb_info, uint64_t new_r
     tss_set_rsp0(KERNEL_STACK_VIRT_TOP);
     print_serial_str_hex(SERIAL_COM1_BASE, "TSS.RSP0 set to: ", KERNEL_STACK_VIRT_TOP);
 
+    // Per-CPU block for the BSP (always CPU 0); must precede the IDT load
+    // so interrupt paths can use %gs-relative state from the first vector.
+    init_percpu(0);
+    print_serial(SERIAL_COM1_BASE, "Per-CPU data area initialized (BSP, GS base set).\n");
+
     init_idt();
     print_serial(SERIAL_COM1_BASE, "IDT initialized and loaded (after paging).\n");
+    boot_mark("idt");
+
+    init_fpu();
+    boot_mark("fpu");
+
+    init_syscall();
+    boot_mark("syscall");
 
     init_apic(smp_request.response);
     print_serial(SERIAL_COM1_BASE, "APIC initialized (after paging).\n");
 
-    init_task_queue(&ready_queue);
-    print_serial(SERIAL_COM1_BASE, "Task ready queue initialized.\n");
+    boot_mark("apic");
+
+    // IDT and I/O APIC are up: stop busy-waiting the UART per character.
+    serial_enable_tx_irq();
+
+    init_vmm();
+    print_serial(SERIAL_COM1_BASE, "VMM initialized (demand paging active).\n");
+    boot_mark("vmm");
+
+    init_run_queues();
+    print_serial(SERIAL_COM1_BASE, "Per-CPU run queues initialized.\n");
+
+    init_idle_tasks();
+
+    // Run queues and idle tasks exist for every online CPU: release the
+    // parked APs so they unmask their LAPIC timers and start scheduling.
+    smp_scheduler_ready = 1;
+    print_serial(SERIAL_COM1_BASE, "Scheduler ready; APs released into their run queues.\n");
+    boot_mark("sched");
 
     print_serial(SERIAL_COM1_BASE, "\n--- Testing PMM Stack Page Mapping ---\n");
     print_serial_str_hex(SERIAL_COM1_BASE, "PMM stack physical base: 0x", pmm_info.stack_phys_base);
@@ -208,8 +421,27 @@ void kernel_main_after_paging(struct limine_framebuffer *fb_info, uint64_t new_r
     }
     print_serial(SERIAL_COM1_BASE, "--- PMM Stack Page Mapping Test Complete ---\n\n");
 
+#ifdef BENCH_BUILD
+    // Benchmark image (`make bench`): run the microbenchmark task instead
+    // of the demo pipeline, so its serial output stays machine-parseable.
+    print_serial(SERIAL_COM1_BASE, "\n--- Creating Benchmark Task (BENCH_BUILD) ---\n");
+    task_t *bench_task = create_task("bench", bench_task_main, (uint64_t)kernel_pml4_phys);
+    if (bench_task != NULL) {
+        sched_enqueue(bench_task);
+    } else {
+        print_serial(SERIAL_COM1_BASE, "Failed to create bench task.\n");
+    }
+#else
     print_serial(SERIAL_COM1_BASE, "\n--- Creating and Enqueueing Dummy Tasks ---\n");
 
+    // Shared ring for the TaskA -> TaskB pipeline (1 page of storage).
+    demo_ipc_ring = ipc_ring_create(0);
+    if (demo_ipc_ring) {
+        print_serial(SERIAL_COM1_BASE, "IPC ring for TaskA->TaskB created.\n");
+    } else {
+        print_serial(SERIAL_COM1_BASE, "Failed to create IPC ring; tasks will idle.\n");
+    }
+
     print_serial(SERIAL_COM1_BASE, "Attempting to create TaskA...\n");
     task_t *task_a = create_task("TaskA", dummy_task_a_main, (uint64_t)kernel_pml4_phys);
     if (task_a) {
@@ -219,7 +451,7 @@ void kernel_main_after_paging(struct limine_framebuffer *fb_info, uint64_t new_r
         print_serial_str(SERIAL_COM1_BASE, pid_str_a);
         print_serial_str(SERIAL_COM1_BASE, "\n");
         print_serial(SERIAL_COM1_BASE, "Attempting to enqueue TaskA...\n");
-        if (enqueue_task(&ready_queue, task_a) == 0) {
+        if (sched_enqueue(task_a) == 0) {
             print_serial_str(SERIAL_COM1_BASE, "TaskA enqueued successfully.\n");
         } else {
             print_serial_str(SERIAL_COM1_BASE, "Failed to enqueue TaskA.\n");
@@ -237,7 +469,7 @@ void kernel_main_after_paging(struct limine_framebuffer *fb_info, uint64_t new_r
         print_serial_str(SERIAL_COM1_BASE, pid_str_b);
         print_serial_str(SERIAL_COM1_BASE, "\n");
         print_serial(SERIAL_COM1_BASE, "Attempting to enqueue TaskB...\n");
-        if (enqueue_task(&ready_queue, task_b) == 0) {
+        if (sched_enqueue(task_b) == 0) {
             print_serial_str(SERIAL_COM1_BASE, "TaskB enqueued successfully.\n");
         } else {
             print_serial_str(SERIAL_COM1_BASE, "Failed to enqueue TaskB.\n");
@@ -246,15 +478,21 @@ void kernel_main_after_paging(struct limine_framebuffer *fb_info, uint64_t new_r
         print_serial_str(SERIAL_COM1_BASE, "Failed to create TaskB.\n");
     }
     print_serial(SERIAL_COM1_BASE, "--- Dummy Task Creation and Enqueueing Complete ---\n\n");
+#endif // BENCH_BUILD
+    boot_mark("tasks");
+
+    // One-shot task that runs the deferred init steps (and prints the boot
+    // timeline) once the scheduler is dispatching.
+    task_t *deferred_task = create_task("deferred", deferred_init_task_main, (uint64_t)kernel_pml4_phys);
+    if (deferred_task != NULL) {
+        sched_enqueue(deferred_task);
+    }
 
     print_serial(SERIAL_COM1_BASE, "Setting up initial task for execution...\n");
-    if (is_task_queue_empty(&ready_queue)) {
-        panic("Ready queue is empty after task creation! Cannot start scheduler.");
-    }
 
-    current_task = dequeue_task(&ready_queue);
+    current_task = sched_pick_next(smp_current_cpu_index());
     if (current_task == NULL) {
-        panic("Failed to dequeue initial task!");
+        panic("Ready queues are empty after task creation! Cannot start scheduler.");
     }
 
     print_serial_str(SERIAL_COM1_BASE, "Dequeued initial task: ");
@@ -294,18 +532,74 @@ void hcf(void) {
     }
 }
 
+// --- Tuned memory primitives ---
+// On ERMS-capable CPUs (Enhanced REP MOVSB/STOSB, CPUID.7.0:EBX bit 9) a
+// plain `rep movsb`/`rep stosb` is the fastest copy/fill at every size the
+// kernel uses. Older CPUs get 64-bit GPR loops with byte tails. Vector
+// registers are deliberately not used: kernel code must not touch SSE state
+// while the lazy-FPU path (CR0.TS) is armed.
+static bool cpu_has_erms = false;
+
+// One-time CPUID feature probe for the routines below. Called early in
+// _start; until then the (safe) non-ERMS paths are used.
+void init_string_ops(void) {
+    uint32_t eax, ebx, ecx, edx;
+    asm volatile ("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(0), "c"(0));
+    if (eax >= 7) {
+        asm volatile ("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(7), "c"(0));
+        cpu_has_erms = (ebx & (1U << 9)) != 0;
+    }
+}
+
 void *memcpy(void *dest, const void *src, size_t n) {
-    (void)src; // Suppress unused parameter warning
-    (void)n;   // Suppress unused parameter warning
+    if (cpu_has_erms) {
+        void *d = dest;
+        asm volatile ("rep movsb" : "+D"(d), "+S"(src), "+c"(n) : : "memory");
+        return dest;
+    }
+    uint8_t *d = (uint8_t *)dest;
+    const uint8_t *s = (const uint8_t *)src;
+    while (n >= 8) { // Unaligned 64-bit accesses are fine on x86
+        *(uint64_t *)d = *(const uint64_t *)s;
+        d += 8; s += 8; n -= 8;
+    }
+    while (n--) {
+        *d++ = *s++;
+    }
     return dest;
 }
 
 void *memset(void *s, int c, size_t n) {
-    (void)c; // Suppress unused parameter warning
-    (void)n; // Suppress unused parameter warning
+    if (cpu_has_erms) {
+        void *d = s;
+        asm volatile ("rep stosb" : "+D"(d), "+c"(n) : "a"((uint8_t)c) : "memory");
+        return s;
+    }
+    uint64_t pattern = 0x0101010101010101ULL * (uint8_t)c;
+    uint8_t *d = (uint8_t *)s;
+    while (n >= 8) {
+        *(uint64_t *)d = pattern;
+        d += 8; n -= 8;
+    }
+    while (n--) {
+        *d++ = (uint8_t)c;
+    }
     return s;
 }
 
+// Zero one 4 KiB page with non-temporal stores. Freshly cleared pages (PMM
+// stack pages, demand-paged frames, PCBs) are usually not read back right
+// away, so movnti keeps the 4 KiB from evicting a page worth of live cache
+// lines. movnti writes from a GPR and is untouched by CR0.TS, so it is safe
+// on every kernel path.
+void zero_page(void *page_virt) {
+    uint64_t *p = (uint64_t *)page_virt;
+    for (size_t i = 0; i < PAGE_SIZE / sizeof(uint64_t); i++) {
+        asm volatile ("movnti %1, %0" : "=m"(p[i]) : "r"(0ULL));
+    }
+    asm volatile ("sfence" ::: "memory"); // Order NT stores before the page is handed out
+}
+
 void uint64_to_dec_str(uint64_t value, char *buffer) {
     if (buffer == NULL) return;
     if (value == 0) {
@@ -365,30 +659,98 @@ void fill_screen(uint32_t color) {
     if (!framebuffer || !framebuffer->address) return;
     // Assuming bpp is 32, framebuffer->address is uint32_t aligned.
     // Pitch is in bytes. Width and height are in pixels.
-    uint32_t *fb_ptr = (uint32_t *)framebuffer->address;
+    uint32_t *fb_ptr = console_target();
     uint64_t pitch_in_pixels = framebuffer->pitch / (framebuffer->bpp / 8);
 
+    // Two pixels per store: each row is one rep stosq burst instead of
+    // width individual 32-bit writes. The row pitch is respected, so this
+    // never spills into the inter-row padding of odd-pitch modes.
+    uint64_t pattern = ((uint64_t)color << 32) | color;
     for (uint64_t y = 0; y < framebuffer->height; y++) {
-        for (uint64_t x = 0; x < framebuffer->width; x++) {
-            fb_ptr[y * pitch_in_pixels + x] = color;
+        uint32_t *row = &fb_ptr[y * pitch_in_pixels];
+        uint64_t *row64 = (uint64_t *)row;
+        uint64_t pairs = framebuffer->width / 2;
+        asm volatile ("rep stosq" : "+D"(row64), "+c"(pairs) : "a"(pattern) : "memory");
+        if (framebuffer->width & 1) {
+            row[framebuffer->width - 1] = color;
         }
     }
+    console_mark_dirty(0, 0, framebuffer->width - 1, framebuffer->height - 1);
+    console_flush();
     // Reset cursor after filling
     cursor_x = 0;
     cursor_y = 0;
 }
 
-// Updated put_char implementation with integrated scaling
-void put_char(char c, int x_char_pos, int y_char_pos) {
+// --- Pre-rendered glyph cache ---
+// font8x8_basic stores one bit per pixel, so the general draw path branches
+// per pixel to pick text_color vs bg_color. For the common case (FONT_SCALE
+// 1, current color pair) every glyph is pre-expanded here into an 8x8 block
+// of ready 32bpp pixels, turning console_draw_char into eight straight row
+// copies. Rebuilt lazily whenever the (fg, bg) pair changes; 128 glyphs x
+// 64 pixels x 4 bytes = 32 KiB of BSS.
+#define GLYPH_CACHE_CHARS 128
+static uint32_t glyph_cache[GLYPH_CACHE_CHARS][FONT_DATA_WIDTH * FONT_DATA_HEIGHT]
+    __attribute__((aligned(8))); // Rows are copied as 64-bit pairs
+static uint32_t glyph_cache_fg, glyph_cache_bg;
+static bool glyph_cache_valid = false;
+
+static void glyph_cache_build(void) {
+    for (int ch = 0; ch < GLYPH_CACHE_CHARS; ch++) {
+        const uint8_t *glyph = font8x8_basic[ch];
+        uint32_t *out = glyph_cache[ch];
+        for (int cy = 0; cy < FONT_DATA_HEIGHT; cy++) {
+            uint8_t row_bits = glyph[cy];
+            for (int cx = 0; cx < FONT_DATA_WIDTH; cx++) {
+                out[cy * FONT_DATA_WIDTH + cx] =
+                    (row_bits & (1 << cx)) ? text_color : bg_color;
+            }
+        }
+    }
+    glyph_cache_fg = text_color;
+    glyph_cache_bg = bg_color;
+    glyph_cache_valid = true;
+}
+
+// Draw one glyph into the shadow buffer (or framebuffer when no shadow)
+// without flushing; put_string batches many of these behind one flush.
+static void console_draw_char(char c, int x_char_pos, int y_char_pos) {
     if (!framebuffer || !framebuffer->address) return;
     if ((uint8_t)c >= 128) c = '?'; // Handle out-of-range ASCII
+
+    // Fast path: unscaled glyph, fully on screen. Copy the pre-rendered
+    // pixel block row by row (as 64-bit pairs) straight into the target.
+    if (FONT_SCALE == 1) {
+        int px = x_char_pos * FONT_DATA_WIDTH;
+        int py = y_char_pos * FONT_DATA_HEIGHT;
+        if (px >= 0 && py >= 0 &&
+            (uint64_t)(px + FONT_DATA_WIDTH) <= framebuffer->width &&
+            (uint64_t)(py + FONT_DATA_HEIGHT) <= framebuffer->height) {
+            if (!glyph_cache_valid || glyph_cache_fg != text_color || glyph_cache_bg != bg_color) {
+                glyph_cache_build();
+            }
+            uint32_t *fb_ptr = console_target();
+            uint64_t pitch_in_pixels = framebuffer->pitch / (framebuffer->bpp / 8);
+            const uint32_t *src = glyph_cache[(uint8_t)c];
+            for (int cy = 0; cy < FONT_DATA_HEIGHT; cy++) {
+                uint32_t *dst_row = &fb_ptr[(py + cy) * pitch_in_pixels + px];
+                const uint32_t *src_row = &src[cy * FONT_DATA_WIDTH];
+                for (int i = 0; i < FONT_DATA_WIDTH / 2; i++) {
+                    ((uint64_t *)dst_row)[i] = ((const uint64_t *)src_row)[i];
+                }
+            }
+            console_mark_dirty(px, py, px + FONT_DATA_WIDTH - 1, py + FONT_DATA_HEIGHT - 1);
+            return;
+        }
+    }
+
     const uint8_t* glyph = font8x8_basic[(uint8_t)c];
 
     // Calculate base screen coordinates (top-left corner of the scaled character cell)
     int base_screen_x = x_char_pos * FONT_DATA_WIDTH * FONT_SCALE;
     int base_screen_y = y_char_pos * FONT_DATA_HEIGHT * FONT_SCALE;
 
-    uint32_t *fb_ptr = (uint32_t *)framebuffer->address;
+    uint32_t *fb_ptr = console_target();
     // Calculate pitch in terms of pixels (uint32_t elements)
     uint64_t pitch_in_pixels = framebuffer->pitch / (framebuffer->bpp / 8);
 
@@ -405,7 +767,7 @@ void put_char(char c, int x_char_pos, int y_char_pos) {
                     int final_x = base_screen_x + cx * FONT_SCALE + sx;
                     int final_y = base_screen_y + cy * FONT_SCALE + sy;
 
-                    // Bounds check before writing to framebuffer
+                    // Bounds check before writing
                     if (final_x >= 0 && (uint64_t)final_x < framebuffer->width &&
                         final_y >= 0 && (uint64_t)final_y < framebuffer->height) {
                         fb_ptr[final_y * pitch_in_pixels + final_x] = pixel_color;
@@ -414,6 +776,21 @@ void put_char(char c, int x_char_pos, int y_char_pos) {
             }
         }
     }
+
+    // Mark the (clipped) character cell dirty
+    int x1 = base_screen_x + FONT_DATA_WIDTH * FONT_SCALE - 1;
+    int y1 = base_screen_y + FONT_DATA_HEIGHT * FONT_SCALE - 1;
+    if (x1 >= (int)framebuffer->width) x1 = framebuffer->width - 1;
+    if (y1 >= (int)framebuffer->height) y1 = framebuffer->height - 1;
+    if (base_screen_x < (int)framebuffer->width && base_screen_y < (int)framebuffer->height) {
+        console_mark_dirty(base_screen_x, base_screen_y, x1, y1);
+    }
+}
+
+// Updated put_char implementation with integrated scaling
+void put_char(char c, int x_char_pos, int y_char_pos) {
+    console_draw_char(c, x_char_pos, y_char_pos);
+    console_flush();
 }
 
 // Definition matching main.h declaration: void put_string(const char *str);
@@ -437,10 +814,11 @@ void put_string(const char *str) {
                 cursor_y = 0;
             }
             // Pass character grid coordinates
-            put_char(c, cursor_x / EFFECTIVE_FONT_WIDTH, cursor_y / EFFECTIVE_FONT_HEIGHT);
+            console_draw_char(c, cursor_x / EFFECTIVE_FONT_WIDTH, cursor_y / EFFECTIVE_FONT_HEIGHT);
             cursor_x += EFFECTIVE_FONT_WIDTH;
         }
     }
+    console_flush(); // One flush for the whole string, not one per glyph
 }
 
 // Definition matching main.h declaration: void put_hex(uint64_t value);
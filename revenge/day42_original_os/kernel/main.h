@@ -63,8 +63,10 @@ void _start(void) __attribute__((noreturn));
 void hcf(void) __attribute__((noreturn)); // Halt and catch fire
 
 // Memory utility functions
+void init_string_ops(void); // One-time CPUID probe (ERMS) for the routines below
 void *memcpy(void *dest, const void *src, size_t n);
 void *memset(void *s, int c, size_t n);
+void zero_page(void *page_virt); // Non-temporal 4 KiB zeroing for page-clearing paths
 
 // String conversion utilities
 void uint64_to_dec_str(uint64_t value, char *buffer);
@@ -74,6 +76,11 @@ void uint64_to_hex_str(uint64_t value, char *buffer);
 void panic(const char *message) __attribute__((noreturn));
 
 // Framebuffer drawing functions
+void boot_mark(const char *name);   // Record a TSC-stamped boot milestone
+void boot_timeline_dump(void);      // Print the milestone table to serial
+void deferred_init_register(void (*fn)(void), const char *name); // Run fn after the scheduler starts
+void init_fbcon(void);     // Allocate the console shadow buffer (after paging + kmalloc)
+void console_flush(void);  // Copy dirty shadow-buffer rows to the framebuffer
 void fill_screen(uint32_t color);
 void put_char(char c, int x_char_pos, int y_char_pos); // Takes character grid position
 void put_string(const char *str);
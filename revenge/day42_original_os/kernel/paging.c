@@ -207,6 +207,199 @@ void map_page(uint64_t *pml4_virt_param, uint64_t virt_addr, uint64_t phys_addr,
     invlpg((void *)virt_addr);
 }
 
+// Descend to (and if needed allocate) the page table covering virt_addr.
+// Shared by map_range so consecutive pages in the same 2MiB window reuse the
+// returned PT instead of re-walking PML4->PDPT->PD each time.
+// Returns NULL if the address is covered by an existing huge-page mapping.
+static uint64_t *paging_get_pt(uint64_t *pml4_virt_param, uint64_t virt_addr, const char* debug_tag) {
+    uint64_t pml4_idx = PML4_INDEX(virt_addr);
+    uint64_t pdpt_idx = PDPT_INDEX(virt_addr);
+    uint64_t pd_idx = PD_INDEX(virt_addr);
+
+    uint64_t *pdpt_virt;
+    if (!(pml4_virt_param[pml4_idx] & PTE_PRESENT)) {
+        uint64_t new_pdpt_phys = (uint64_t)pmm_alloc_page();
+        if (new_pdpt_phys == 0) {
+            print_serial_format("paging_get_pt ERROR: Failed to allocate PDPT for VA 0x%lx. Tag: %s. Halting.\n", virt_addr, debug_tag ? debug_tag : "N/A");
+            hcf();
+        }
+        pdpt_virt = (uint64_t*)(new_pdpt_phys + hhdm_offset);
+        clear_page(pdpt_virt);
+        pml4_virt_param[pml4_idx] = new_pdpt_phys | PTE_PRESENT | PTE_WRITABLE | PTE_USER;
+    } else {
+        pdpt_virt = (uint64_t*)((pml4_virt_param[pml4_idx] & PTE_ADDR_MASK) + hhdm_offset);
+    }
+
+    if (pdpt_virt[pdpt_idx] & PTE_PSE) {
+        return NULL; // 1GB page already covers this range
+    }
+
+    uint64_t *pd_virt;
+    if (!(pdpt_virt[pdpt_idx] & PTE_PRESENT)) {
+        uint64_t new_pd_phys = (uint64_t)pmm_alloc_page();
+        if (new_pd_phys == 0) {
+            print_serial_format("paging_get_pt ERROR: Failed to allocate PD for VA 0x%lx. Tag: %s. Halting.\n", virt_addr, debug_tag ? debug_tag : "N/A");
+            hcf();
+        }
+        pd_virt = (uint64_t*)(new_pd_phys + hhdm_offset);
+        clear_page(pd_virt);
+        pdpt_virt[pdpt_idx] = new_pd_phys | PTE_PRESENT | PTE_WRITABLE | PTE_USER;
+    } else {
+        pd_virt = (uint64_t*)((pdpt_virt[pdpt_idx] & PTE_ADDR_MASK) + hhdm_offset);
+    }
+
+    if (pd_virt[pd_idx] & PTE_PSE) {
+        return NULL; // 2MB page already covers this range
+    }
+
+    uint64_t *pt_virt;
+    if (!(pd_virt[pd_idx] & PTE_PRESENT)) {
+        uint64_t new_pt_phys = (uint64_t)pmm_alloc_page();
+        if (new_pt_phys == 0) {
+            print_serial_format("paging_get_pt ERROR: Failed to allocate PT for VA 0x%lx. Tag: %s. Halting.\n", virt_addr, debug_tag ? debug_tag : "N/A");
+            hcf();
+        }
+        pt_virt = (uint64_t*)(new_pt_phys + hhdm_offset);
+        clear_page(pt_virt);
+        pd_virt[pd_idx] = new_pt_phys | PTE_PRESENT | PTE_WRITABLE | PTE_USER;
+    } else {
+        pt_virt = (uint64_t*)((pd_virt[pd_idx] & PTE_ADDR_MASK) + hhdm_offset);
+    }
+
+    return pt_virt;
+}
+
+// Map `count` consecutive 4KiB pages starting at virt_addr/phys_addr.
+//
+// Unlike calling map_page in a loop, the PML4->PDPT->PD->PT walk state is
+// kept across pages and only refreshed when the range crosses into the next
+// 2MiB window, and the TLB is flushed once at the end: per-page invlpg for
+// short ranges, a single CR3 reload for long ones.
+void map_range(uint64_t *pml4_virt_param, uint64_t virt_addr, uint64_t phys_addr, uint64_t count, uint64_t flags, const char* debug_tag) {
+    if (pml4_virt_param == NULL) {
+        if (kernel_pml4_virt == NULL) {
+            print_serial_format("CRITICAL map_range: pml4_virt_param is NULL and kernel_pml4_virt is also NULL! Tag: %s. VA=0x%lx. Halting.\n",
+                                debug_tag ? debug_tag : "N/A", virt_addr);
+            hcf();
+        }
+        pml4_virt_param = (uint64_t*)kernel_pml4_virt;
+    }
+
+    uint64_t *pt_virt = NULL;
+    uint64_t cached_window = ~0ULL; // VA >> 21 of the 2MiB window pt_virt covers
+
+    uint64_t va = virt_addr;
+    uint64_t pa = phys_addr;
+    for (uint64_t i = 0; i < count; i++, va += PAGE_SIZE, pa += PAGE_SIZE) {
+        if (pt_virt == NULL || (va >> 21) != cached_window) {
+            pt_virt = paging_get_pt(pml4_virt_param, va, debug_tag);
+            if (pt_virt == NULL) {
+                print_serial_format("map_range ERROR: VA 0x%lx is inside an existing huge-page mapping. Tag: %s\n",
+                                    va, debug_tag ? debug_tag : "N/A");
+                return;
+            }
+            cached_window = va >> 21;
+        }
+        pt_virt[PT_INDEX(va)] = (pa & PTE_ADDR_MASK_4KB) | flags;
+    }
+
+    // Consolidated TLB flush for the whole range.
+    #define MAP_RANGE_INVLPG_LIMIT 16
+    if (count <= MAP_RANGE_INVLPG_LIMIT) {
+        for (uint64_t i = 0; i < count; i++) {
+            invlpg((void *)(virt_addr + i * PAGE_SIZE));
+        }
+    } else {
+        load_cr3(get_current_cr3()); // Flushes all non-global entries at once
+    }
+}
+
+// Non-allocating page-table walk: return a pointer to the PTE covering
+// virt_addr, or NULL if any level is missing or a huge page covers it.
+// Used by the demand-paging fault handler to inspect/replace live mappings.
+pte_t *paging_find_pte(uint64_t *pml4_virt_param, uint64_t virt_addr) {
+    if (pml4_virt_param == NULL) {
+        if (kernel_pml4_virt == NULL) return NULL;
+        pml4_virt_param = (uint64_t*)kernel_pml4_virt;
+    }
+
+    pml4e_t pml4e = pml4_virt_param[PML4_INDEX(virt_addr)];
+    if (!(pml4e & PTE_PRESENT)) return NULL;
+
+    uint64_t *pdpt_virt = (uint64_t*)((pml4e & PTE_ADDR_MASK) + hhdm_offset);
+    pdpte_t pdpte = pdpt_virt[PDPT_INDEX(virt_addr)];
+    if (!(pdpte & PTE_PRESENT) || (pdpte & PTE_PSE)) return NULL;
+
+    uint64_t *pd_virt = (uint64_t*)((pdpte & PTE_ADDR_MASK) + hhdm_offset);
+    pde_t pde = pd_virt[PD_INDEX(virt_addr)];
+    if (!(pde & PTE_PRESENT) || (pde & PTE_PSE)) return NULL;
+
+    uint64_t *pt_virt = (uint64_t*)((pde & PTE_ADDR_MASK) + hhdm_offset);
+    return &pt_virt[PT_INDEX(virt_addr)];
+}
+
+// Map a single 2MiB huge page by installing a PDE with PS set.
+// One such entry replaces a whole PT (512 4KiB PTEs), so large aligned
+// ranges cost far fewer page-table pages and TLB entries.
+void map_page_2m(uint64_t *pml4_virt_param, uint64_t virt_addr, uint64_t phys_addr, uint64_t flags, const char* debug_tag) {
+    if (pml4_virt_param == NULL) {
+        if (kernel_pml4_virt == NULL) {
+            print_serial_format("CRITICAL map_page_2m: pml4_virt_param is NULL and kernel_pml4_virt is also NULL! Tag: %s. VA=0x%lx. Halting.\n",
+                                debug_tag ? debug_tag : "N/A", virt_addr);
+            hcf();
+        }
+        pml4_virt_param = (uint64_t*)kernel_pml4_virt;
+    }
+
+    if ((virt_addr & (SIZE_2MB - 1)) || (phys_addr & (SIZE_2MB - 1))) {
+        print_serial_format("map_page_2m ERROR: VA 0x%lx / PA 0x%lx not 2MiB aligned. Tag: %s\n",
+                            virt_addr, phys_addr, debug_tag ? debug_tag : "N/A");
+        return;
+    }
+
+    uint64_t pml4_idx = PML4_INDEX(virt_addr);
+    uint64_t pdpt_idx = PDPT_INDEX(virt_addr);
+    uint64_t pd_idx = PD_INDEX(virt_addr);
+
+    uint64_t *pdpt_virt;
+    if (!(pml4_virt_param[pml4_idx] & PTE_PRESENT)) {
+        uint64_t new_pdpt_phys = (uint64_t)pmm_alloc_page();
+        if (new_pdpt_phys == 0) {
+            print_serial_format("map_page_2m ERROR: Failed to allocate PDPT for VA 0x%lx. Tag: %s. Halting.\n", virt_addr, debug_tag ? debug_tag : "N/A");
+            hcf();
+        }
+        pdpt_virt = (uint64_t*)(new_pdpt_phys + hhdm_offset);
+        clear_page(pdpt_virt);
+        pml4_virt_param[pml4_idx] = new_pdpt_phys | PTE_PRESENT | PTE_WRITABLE | PTE_USER;
+    } else {
+        pdpt_virt = (uint64_t*)((pml4_virt_param[pml4_idx] & PTE_ADDR_MASK) + hhdm_offset);
+    }
+
+    uint64_t *pd_virt;
+    if (!(pdpt_virt[pdpt_idx] & PTE_PRESENT)) {
+        uint64_t new_pd_phys = (uint64_t)pmm_alloc_page();
+        if (new_pd_phys == 0) {
+            print_serial_format("map_page_2m ERROR: Failed to allocate PD for VA 0x%lx. Tag: %s. Halting.\n", virt_addr, debug_tag ? debug_tag : "N/A");
+            hcf();
+        }
+        pd_virt = (uint64_t*)(new_pd_phys + hhdm_offset);
+        clear_page(pd_virt);
+        pdpt_virt[pdpt_idx] = new_pd_phys | PTE_PRESENT | PTE_WRITABLE | PTE_USER;
+    } else {
+        if (pdpt_virt[pdpt_idx] & PTE_PSE) {
+            print_serial_format("map_page_2m ERROR: VA 0x%lx is inside an existing 1GB page. Tag: %s\n",
+                                virt_addr, debug_tag ? debug_tag : "N/A");
+            return;
+        }
+        pd_virt = (uint64_t*)((pdpt_virt[pdpt_idx] & PTE_ADDR_MASK) + hhdm_offset);
+    }
+
+    // Note: if this PDE previously pointed to a PT, that PT page is replaced
+    // (and leaked) — callers are expected to map disjoint ranges at boot.
+    pd_virt[pd_idx] = (phys_addr & PTE_ADDR_MASK_2MB) | flags | PTE_PSE;
+    invlpg((void *)virt_addr);
+}
+
 void unmap_page(uint64_t *pml4_virt, uint64_t virt_addr) {
     if (pml4_virt == NULL) {
         // If no specific PML4 is given, assume we are operating on the kernel's PML4.
@@ -325,9 +518,11 @@ void init_paging(
     print_serial(SERIAL_COM1_BASE, " - 0x");
     print_serial_hex(SERIAL_COM1_BASE, (uint64_t)_text_end);
     print_serial(SERIAL_COM1_BASE, ")\n");
-    for (uint64_t v = ALIGN_DOWN((uint64_t)_text_start, PAGE_SIZE); v < ALIGN_UP((uint64_t)_text_end, PAGE_SIZE); v += PAGE_SIZE) {
-        uint64_t p = (v - (uint64_t)_kernel_start) + kernel_load_phys_addr;
-        map_page(NULL, v, p, PTE_PRESENT, ".text");
+    {
+        uint64_t text_virt = ALIGN_DOWN((uint64_t)_text_start, PAGE_SIZE);
+        uint64_t text_pages = (ALIGN_UP((uint64_t)_text_end, PAGE_SIZE) - text_virt) / PAGE_SIZE;
+        uint64_t text_phys = (text_virt - (uint64_t)_kernel_start) + kernel_load_phys_addr;
+        map_range(NULL, text_virt, text_phys, text_pages, PTE_PRESENT, ".text");
     }
 
     print_serial(SERIAL_COM1_BASE, "Mapping .rodata section (VA: 0x");
@@ -335,9 +530,11 @@ void init_paging(
     print_serial(SERIAL_COM1_BASE, " - 0x");
     print_serial_hex(SERIAL_COM1_BASE, (uint64_t)_rodata_end);
     print_serial(SERIAL_COM1_BASE, ")\n");
-    for (uint64_t v = ALIGN_DOWN((uint64_t)_rodata_start, PAGE_SIZE); v < ALIGN_UP((uint64_t)_rodata_end, PAGE_SIZE); v += PAGE_SIZE) {
-        uint64_t p = (v - (uint64_t)_kernel_start) + kernel_load_phys_addr;
-        map_page(NULL, v, p, PTE_PRESENT | PTE_NO_EXECUTE, ".rodata");
+    {
+        uint64_t rodata_virt = ALIGN_DOWN((uint64_t)_rodata_start, PAGE_SIZE);
+        uint64_t rodata_pages = (ALIGN_UP((uint64_t)_rodata_end, PAGE_SIZE) - rodata_virt) / PAGE_SIZE;
+        uint64_t rodata_phys = (rodata_virt - (uint64_t)_kernel_start) + kernel_load_phys_addr;
+        map_range(NULL, rodata_virt, rodata_phys, rodata_pages, PTE_PRESENT | PTE_NO_EXECUTE, ".rodata");
     }
 
     uint64_t data_bss_start_virt = ALIGN_DOWN((uint64_t)_data_start, PAGE_SIZE);
@@ -347,10 +544,10 @@ void init_paging(
     print_serial(SERIAL_COM1_BASE, " - 0x");
     print_serial_hex(SERIAL_COM1_BASE, data_bss_end_virt);
     print_serial(SERIAL_COM1_BASE, ")\n");
-    for (uint64_t v = data_bss_start_virt; v < data_bss_end_virt; v += PAGE_SIZE) {
-        uint64_t p = (v - (uint64_t)_kernel_start) + kernel_load_phys_addr;
-        map_page(NULL, v, p, PTE_PRESENT | PTE_WRITABLE | PTE_NO_EXECUTE, ".data/.bss");
-    }
+    map_range(NULL, data_bss_start_virt,
+              (data_bss_start_virt - (uint64_t)_kernel_start) + kernel_load_phys_addr,
+              (data_bss_end_virt - data_bss_start_virt) / PAGE_SIZE,
+              PTE_PRESENT | PTE_WRITABLE | PTE_NO_EXECUTE, ".data/.bss");
     print_serial(SERIAL_COM1_BASE, "Kernel sections mapped.\n");
 
     if (framebuffer_resp == NULL || framebuffer_resp->framebuffer_count < 1) {
@@ -368,10 +565,20 @@ void init_paging(
     print_serial(SERIAL_COM1_BASE, " Size:0x");
     print_serial_hex(SERIAL_COM1_BASE, fb_size);
     print_serial(SERIAL_COM1_BASE, "\n");
-    for (uint64_t offset = 0; offset < fb_size; offset += PAGE_SIZE) {
-        uint64_t phys = fb_addr_phys_base + offset;
-        uint64_t virt = fb_addr_virt_base + offset;
-        map_page(NULL, virt, phys, PTE_PRESENT | PTE_WRITABLE /*| PTE_PWT | PTE_PCD*/, "Framebuffer");
+    // Use 2MiB huge pages for the large aligned middle of the framebuffer;
+    // fall back to 4KiB pages for unaligned head/tail.
+    uint64_t fb_offset = 0;
+    while (fb_offset < fb_size) {
+        uint64_t phys = fb_addr_phys_base + fb_offset;
+        uint64_t virt = fb_addr_virt_base + fb_offset;
+        if ((phys & (SIZE_2MB - 1)) == 0 && (virt & (SIZE_2MB - 1)) == 0 &&
+            (fb_size - fb_offset) >= SIZE_2MB) {
+            map_page_2m(NULL, virt, phys, PTE_PRESENT | PTE_WRITABLE /*| PTE_PWT | PTE_PCD*/, "Framebuffer (2MiB)");
+            fb_offset += SIZE_2MB;
+        } else {
+            map_page(NULL, virt, phys, PTE_PRESENT | PTE_WRITABLE /*| PTE_PWT | PTE_PCD*/, "Framebuffer");
+            fb_offset += PAGE_SIZE;
+        }
     }
     print_serial(SERIAL_COM1_BASE, "Framebuffer mapped.\n");
 
@@ -382,16 +589,8 @@ void init_paging(
     print_serial(SERIAL_COM1_BASE, " Size:0x");
     print_serial_hex(SERIAL_COM1_BASE, kernel_stack_size);
     print_serial(SERIAL_COM1_BASE, "\n");
-    for (uint64_t off = 0; off < kernel_stack_size; off += PAGE_SIZE) {
-        uint64_t stack_page_virt = kernel_stack_phys_base + hhdm_offset + off;
-        uint64_t stack_page_phys = kernel_stack_phys_base + off;
-        map_page(NULL, stack_page_virt, stack_page_phys, PTE_PRESENT | PTE_WRITABLE, "Kernel Stack Page");
-        print_serial(SERIAL_COM1_BASE, "  Mapped Stack Page: V=0x");
-        print_serial_hex(SERIAL_COM1_BASE, stack_page_virt);
-        print_serial(SERIAL_COM1_BASE, " -> P=0x");
-        print_serial_hex(SERIAL_COM1_BASE, stack_page_phys);
-        print_serial(SERIAL_COM1_BASE, "\n");
-    }
+    map_range(NULL, kernel_stack_phys_base + hhdm_offset, kernel_stack_phys_base,
+              kernel_stack_size / PAGE_SIZE, PTE_PRESENT | PTE_WRITABLE, "Kernel Stack");
     print_serial(SERIAL_COM1_BASE, "Kernel stack mapped.\n");
 
     // Map APIC MMIO region (if needed, based on MSR check)
@@ -427,11 +626,8 @@ void init_paging(
         print_serial(SERIAL_COM1_BASE, num_pages_str);
         print_serial(SERIAL_COM1_BASE, "\n");
 
-        for (uint64_t i = 0; i < pmm_info.pmm_stack_size_pages; i++) {
-            uint64_t phys_addr = pmm_info.stack_phys_base + (i * PAGE_SIZE);
-            uint64_t virt_addr = phys_addr + hhdm_offset;
-            map_page(NULL, virt_addr, phys_addr, PTE_PRESENT | PTE_WRITABLE | PTE_NO_EXECUTE, "PMM Stack");
-        }
+        map_range(NULL, pmm_info.stack_phys_base + hhdm_offset, pmm_info.stack_phys_base,
+                  pmm_info.pmm_stack_size_pages, PTE_PRESENT | PTE_WRITABLE | PTE_NO_EXECUTE, "PMM Stack");
         print_serial(SERIAL_COM1_BASE, "PMM internal stack mapped to HHDM.\n");
     } else {
         print_serial(SERIAL_COM1_BASE, "PMM internal stack mapping skipped (base or size is zero).\n");
@@ -513,14 +709,11 @@ void init_paging(
     print_serial_hex(SERIAL_COM1_BASE, idt_size);
     print_serial(SERIAL_COM1_BASE, ")\n");
 
-    for (uint64_t p_addr = ALIGN_DOWN(idt_phys_start, PAGE_SIZE); p_addr < ALIGN_UP(idt_phys_end, PAGE_SIZE); p_addr += PAGE_SIZE) {
-        uint64_t v_addr = p_addr + hhdm_offset;
-        map_page(NULL, v_addr, p_addr, PTE_PRESENT | PTE_WRITABLE | PTE_NO_EXECUTE, "IDT"); // IDT itself is data, handlers are code
-        // print_serial(SERIAL_COM1_BASE, "  Mapped IDT Page: V=0x");
-        // print_serial_hex(SERIAL_COM1_BASE, v_addr);
-        // print_serial(SERIAL_COM1_BASE, " -> P=");
-        // print_serial_hex(SERIAL_COM1_BASE, p_addr);
-        // print_serial(SERIAL_COM1_BASE, "\n");
+    {
+        uint64_t idt_map_phys = ALIGN_DOWN(idt_phys_start, PAGE_SIZE);
+        uint64_t idt_map_pages = (ALIGN_UP(idt_phys_end, PAGE_SIZE) - idt_map_phys) / PAGE_SIZE;
+        map_range(NULL, idt_map_phys + hhdm_offset, idt_map_phys, idt_map_pages,
+                  PTE_PRESENT | PTE_WRITABLE | PTE_NO_EXECUTE, "IDT"); // IDT itself is data, handlers are code
     }
     print_serial(SERIAL_COM1_BASE, "IDT mapped to HHDM.\n");
 
@@ -2,6 +2,7 @@
 #define PAGING_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include "limine.h"
 
 #define PAGE_SIZE 0x1000 // 4 KiB
@@ -32,6 +33,7 @@
 // For 4KB pages, bits 12 through (MAX_PHY_ADDR-1) store the address.
 // MAX_PHY_ADDR is typically 52 for modern x86_64 CPUs.
 #define PTE_ADDR_MASK 0x000FFFFFFFFFF000ULL
+#define PTE_ADDR_MASK_4KB PTE_ADDR_MASK // For 4KB pages (PT entry)
 
 // Address masks for larger pages
 #define PTE_ADDR_MASK_2MB 0x000FFFFFFFE00000ULL // For 2MB pages (PD entry), bits 21 to (MAX_PHY_ADDR-1)
@@ -67,22 +69,31 @@ void kernel_main_after_paging(struct limine_framebuffer *fb, uint64_t new_rsp);
 
 // Function to initialize paging
 void init_paging(
-    uint64_t physical_base_addr,
-    uint64_t virtual_base_addr,
-    uint64_t kernel_phys_start,
-    uint64_t kernel_phys_end,
-    uint64_t _hhdm_offset,
-    struct limine_memmap_entry **memmap,
-    size_t memmap_entries,
-    struct limine_kernel_address_response *kernel_addr,
-    struct limine_framebuffer *fb
+    struct limine_framebuffer_response *framebuffer_resp,
+    struct limine_memmap_response *memmap_resp,
+    uint64_t kernel_stack_phys_base,
+    uint64_t kernel_stack_size,
+    uint64_t new_rsp_virt_top,
+    void (*kernel_entry_after_paging_fn)(struct limine_framebuffer *, uint64_t),
+    struct limine_framebuffer *fb_for_kernel_main
 );
 
 // Function to map a single virtual page to a physical page
 // virt_addr and phys_addr must be page-aligned
 // The PML4 table virtual address (pml4_virt_param) must be provided.
 void map_page(uint64_t *pml4_virt_param, uint64_t virt_addr, uint64_t phys_addr, uint64_t flags, const char* debug_tag);
+// Map one 2MiB huge page (PDE with PS set). virt_addr and phys_addr must be
+// 2MiB-aligned. Used for large aligned ranges to cut page-table memory and
+// TLB pressure compared to 512 individual 4KiB PTEs.
+void map_page_2m(uint64_t *pml4_virt_param, uint64_t virt_addr, uint64_t phys_addr, uint64_t flags, const char* debug_tag);
+// Map `count` consecutive 4KiB pages. Keeps the table-walk state across
+// pages (re-descending only on 2MiB window crossings) and performs one
+// consolidated TLB flush at the end instead of per-page invlpg.
+void map_range(uint64_t *pml4_virt_param, uint64_t virt_addr, uint64_t phys_addr, uint64_t count, uint64_t flags, const char* debug_tag);
 void unmap_page(uint64_t *pml4_virt, uint64_t virt_addr);
+// Non-allocating walk: pointer to the live PTE for virt_addr, or NULL if the
+// address is unmapped or covered by a huge page. Pass NULL to use the kernel PML4.
+pte_t *paging_find_pte(uint64_t *pml4_virt_param, uint64_t virt_addr);
 
 // Re-add stack virtual address macros
 #define KERNEL_STACK_PAGES 16
@@ -116,6 +127,4 @@ extern void switch_to_kernel_higher_half_and_run(
     struct limine_framebuffer *fb_virt
 ) __attribute__((noreturn));
 
-void load_pml4(uint64_t pml4_phys);
-
 #endif // PAGING_H
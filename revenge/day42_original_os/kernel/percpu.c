@@ -0,0 +1,50 @@
+#include "percpu.h"
+#include "msr.h"
+#include "apic.h" // SMP_MAX_CPUS
+#include "task.h" // cpu_run_queues
+#include "pmm.h"  // pmm_percpu_cache
+#include "prof.h" // prof_percpu_slots
+#include <stddef.h>
+
+#define IA32_GS_BASE        0xC0000101
+#define IA32_KERNEL_GS_BASE 0xC0000102
+
+volatile int percpu_ready = 0;
+
+// Statically sized like every other per-CPU table in this kernel (run
+// queues, idle tasks, PMM magazines); the alignment attribute on percpu_t
+// keeps each block on its own cache line.
+static percpu_t percpu_blocks[SMP_MAX_CPUS];
+
+// The inline accessors in percpu.h hard-code these offsets in their %gs
+// operands; fail the build if the layout drifts.
+_Static_assert(offsetof(percpu_t, self) == 0, "percpu_get reads %gs:0");
+_Static_assert(offsetof(percpu_t, cpu_index) == 8, "percpu_cpu_index reads %gs:8");
+_Static_assert(offsetof(percpu_t, syscall_kernel_rsp) == 72, "syscall_entry reads gs:[72]");
+_Static_assert(offsetof(percpu_t, syscall_user_rsp) == 80, "syscall_entry uses gs:[80]");
+
+void init_percpu(uint32_t cpu_index) {
+    percpu_t *p = &percpu_blocks[cpu_index];
+    p->self = p;
+    p->cpu_index = cpu_index;
+    p->current = NULL;
+    p->run_queue = &cpu_run_queues[cpu_index];
+    p->pmm_cache = pmm_percpu_cache(cpu_index);
+    p->prof_slots = prof_percpu_slots(cpu_index);
+    p->sched_switches = 0;
+    p->sched_steals = 0;
+    p->sched_idle_entries = 0;
+    p->syscall_kernel_rsp = 0; // Filled in by init_syscall on this CPU
+    p->syscall_user_rsp = 0;
+
+    // GS_BASE makes the block reachable from kernel code; KERNEL_GS_BASE
+    // mirrors it so the conditional swapgs in the interrupt entry stubs
+    // lands on the same block no matter which side of a (future) user-mode
+    // transition we entered from. This is the only place either MSR is
+    // written: syscall_entry.s reaches its stack slots through this block
+    // too, so init_syscall must not re-point KERNEL_GS_BASE elsewhere.
+    wrmsr(IA32_GS_BASE, (uint64_t)p);
+    wrmsr(IA32_KERNEL_GS_BASE, (uint64_t)p);
+
+    percpu_ready = 1;
+}
@@ -0,0 +1,68 @@
+#ifndef KERNEL_PERCPU_H
+#define KERNEL_PERCPU_H
+
+#include <stdint.h>
+
+// --- Per-CPU data area (%gs-based) ---
+// One cache-line-aligned block per CPU, reachable through the GS segment
+// base: init_percpu() points IA32_GS_BASE (and IA32_KERNEL_GS_BASE, so the
+// swapgs guards in the entry stubs are harmless either way) at this CPU's
+// block, and percpu_get() is then a single %gs:0 load — no LAPIC-ID read,
+// no table search, no false sharing with other cores.
+//
+// The block gathers the state a core touches on every scheduling decision:
+// its current task, its run queue, its PMM page magazine and its profiling
+// slots, plus scheduler statistics that used to have nowhere per-CPU to
+// live. The `current_task` name every file already uses is now a macro over
+// this block (see task.h), so existing code picks up the per-CPU version
+// without edits.
+
+struct task;
+struct task_queue;
+
+typedef struct percpu {
+    struct percpu *self;          // %gs:0 -> the block itself (must stay first)
+    uint32_t cpu_index;           // Index into smp_cpus[] / cpu_run_queues[]
+    uint32_t pad0;
+    struct task *current;         // This CPU's running task (aka current_task)
+    struct task_queue *run_queue; // &cpu_run_queues[cpu_index]
+    void *pmm_cache;              // struct pmm_cpu_cache (pmm.c page magazine)
+    void *prof_slots;             // prof_cpu_slots_t (prof.c event counters)
+
+    // Scheduler statistics (written only by the owning core).
+    uint64_t sched_switches;      // Context switches performed
+    uint64_t sched_steals;        // Tasks taken from another CPU's queue
+    uint64_t sched_idle_entries;  // Times the core fell back to its idle task
+
+    // syscall fast-path stack switch. syscall_entry.s reaches these through
+    // the post-swapgs GS base, so KERNEL_GS_BASE has exactly one owner (this
+    // block) for both the entry stubs and the syscall path. The gs:[72] /
+    // gs:[80] offsets are ABI for syscall_entry.s; asserted in percpu.c.
+    uint64_t syscall_kernel_rsp;  // Top of this CPU's syscall kernel stack
+    uint64_t syscall_user_rsp;    // Scratch slot holding the user RSP
+} __attribute__((aligned(64))) percpu_t;
+
+// 0 until the first init_percpu(); code that can run earlier (e.g. the PMM
+// during boot) must check this before any %gs-relative access.
+extern volatile int percpu_ready;
+
+// Point GS at this CPU's block and fill it in. The BSP calls this once
+// paging is up; each AP calls it in smp_ap_entry right after reloading its
+// segment registers (which resets the GS base to 0).
+void init_percpu(uint32_t cpu_index);
+
+static inline percpu_t *percpu_get(void) {
+    percpu_t *p;
+    asm volatile("movq %%gs:0, %0" : "=r"(p));
+    return p;
+}
+
+// cpu_index without the extra dereference (offset 8 = after the self pointer;
+// asserted in percpu.c).
+static inline uint32_t percpu_cpu_index(void) {
+    uint32_t idx;
+    asm volatile("movl %%gs:8, %0" : "=r"(idx));
+    return idx;
+}
+
+#endif // KERNEL_PERCPU_H
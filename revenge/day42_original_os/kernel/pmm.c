@@ -5,6 +5,9 @@
 #include <stddef.h>  // For NULL and size_t
 #include <stdbool.h> // For bool, true, false
 #include "paging.h" // For PAGE_SIZE (though it might be better to have a common header for such constants)
+#include "klog.h"   // Deferred logging for the alloc/free hot paths
+#include "prof.h"   // Cycle counters for the alloc/free hot paths
+#include "percpu.h" // %gs-based CPU index for the per-CPU magazines
 
 // External serial printing functions from main.c (for debugging PMM)
 // These should ideally be replaced by a proper kernel logging system later.
@@ -12,6 +15,7 @@ extern void print_serial(uint16_t port, const char *s);
 extern void print_serial_hex(uint16_t port, uint64_t h);
 extern void print_serial_utoa(uint16_t port, uint64_t u);
 extern void print_serial_dec(uint16_t port, uint64_t u);
+extern void zero_page(void *page_virt); // Non-temporal page zeroing (main.c)
 #define KERNEL_COM1 SERIAL_COM1_BASE // Assuming SERIAL_COM1_BASE is defined in main.c or a common header if we include it
                                       // For now, let's hardcode it for PMM debugging if needed or pass port.
                                       // Let's use a local define for clarity in PMM if not including main.h directly.
@@ -49,6 +53,84 @@ static uint64_t pmm_stack_top = 0;       // Index into entries[] of the pmm_curr
 // static uint64_t pmm_stack_page_phys = 0; // Physical address of the page used for the PMM stack - REPLACED by pmm_first_stack_page_phys
 static uint64_t pmm_first_stack_page_phys = 0; // Physical address of the *first* page used for the PMM stack
 static uint64_t total_free_pages = 0;
+
+// --- Page Frame Database ---
+// Flat array with one page_frame_t per physical frame, indexed by PFN.
+// Lives in a usable region carved out during init_pmm and accessed via HHDM.
+// Replaces the old O(n) stack-chain walk in pmm_free_page with an O(1) lookup.
+static page_frame_t *page_frame_db = NULL; // Virtual (HHDM) address of the database
+static uint64_t page_frame_count = 0;      // Number of frames tracked (highest usable PFN + 1)
+static uint64_t page_frame_db_phys = 0;    // Physical base of the database
+static uint64_t page_frame_db_pages = 0;   // Pages occupied by the database itself
+
+// --- Global stack lock ---
+// Protects pmm_current_stack_head/pmm_stack_top/total_free_pages and the
+// frame DB state transitions. The per-CPU caches below keep this off the
+// common alloc/free path.
+static volatile int pmm_global_lock = 0;
+
+static inline void pmm_lock(void) {
+    while (__sync_lock_test_and_set(&pmm_global_lock, 1)) {
+        while (pmm_global_lock) {
+            asm volatile ("pause");
+        }
+    }
+}
+
+static inline void pmm_unlock(void) {
+    __sync_lock_release(&pmm_global_lock);
+}
+
+// Save RFLAGS and disable interrupts around a per-CPU magazine operation.
+// The magazine has a single owning CPU but is reentrant on that CPU: the
+// timer IRQ's schedule() path and an allocating #PF (vmm_handle_page_fault)
+// both call back into the PMM, so an interrupt landing between a count
+// check and the matching update would interleave two contexts mid-pop/push
+// — handing out the same frame twice or corrupting count. Same pattern as
+// the serial TX ring (serial.c); the global lock only covers the shared
+// stack, not the caches.
+static inline uint64_t pmm_irq_save(void) {
+    uint64_t flags;
+    asm volatile ("pushfq; pop %0; cli" : "=r"(flags) :: "memory");
+    return flags;
+}
+
+static inline void pmm_irq_restore(uint64_t flags) {
+    if (flags & (1ULL << 9)) { // IF was set
+        asm volatile ("sti");
+    }
+}
+
+// --- Per-CPU free-page caches (magazines) ---
+// Each CPU keeps a small stash of frames so pmm_alloc_page/pmm_free_page
+// normally never touch the shared stack. Refills and drains move
+// PMM_CPU_CACHE_BATCH frames at a time under the global lock.
+//
+// Frames sitting in a cache stay PAGE_FRAME_ALLOCATED in the frame DB;
+// PAGE_FRAME_FREE strictly means "on the global stack", which keeps
+// pmm_alloc_pages from claiming frames a CPU already owns.
+#define PMM_MAX_CPUS 16
+#define PMM_CPU_CACHE_CAPACITY 128
+#define PMM_CPU_CACHE_BATCH (PMM_CPU_CACHE_CAPACITY / 2)
+
+struct pmm_cpu_cache {
+    uint64_t frames[PMM_CPU_CACHE_CAPACITY];
+    uint64_t count;
+} __attribute__((aligned(64))); // Own cache line per CPU
+
+static struct pmm_cpu_cache pmm_cpu_caches[PMM_MAX_CPUS];
+
+// Index of the executing CPU, via the %gs-based per-CPU block once that is
+// up; the PMM runs during early boot before init_percpu, hence the fallback.
+static inline uint32_t pmm_cpu_index(void) {
+    return percpu_ready ? percpu_cpu_index() : 0;
+}
+
+// Expose this CPU's magazine to the per-CPU block (percpu.c) without making
+// the cache array itself public.
+void *pmm_percpu_cache(uint32_t cpu) {
+    return &pmm_cpu_caches[cpu % PMM_MAX_CPUS];
+}
 // static uint64_t total_usable_pages = 0; // For debugging/verification - Can be re-added if needed
 
 // HHDM offset (defined in main.c via paging.h)
@@ -58,10 +140,7 @@ extern uint64_t hhdm_offset;
 // This could be a shared function if defined elsewhere and not static.
 // For now, assume it's available or add a local static version if needed.
 static void clear_page_pmm(void *page_virt) { // Renamed to avoid conflict
-    uint64_t *p = (uint64_t *)page_virt;
-    for (size_t i = 0; i < PAGE_SIZE / sizeof(uint64_t); i++) {
-        p[i] = 0;
-    }
+    zero_page(page_virt); // Non-temporal stores; see main.c
 }
 
 // Helper to align an address up to the nearest page boundary
@@ -72,6 +151,94 @@ static uint64_t ALIGN_UP_PMM(uint64_t addr, uint64_t align) { // Renamed to avoi
 // Forward declaration for pmm_get_allocated_stack_page_count
 uint64_t pmm_get_allocated_stack_page_count(void);
 
+// Global-stack primitives (caller must hold the global lock)
+static void pmm_stack_push_page(void *p_phys);
+
+// Returns the descriptor for a physical address, or NULL if untracked.
+page_frame_t *pmm_page_frame(uint64_t phys_addr) {
+    if (page_frame_db == NULL) {
+        return NULL;
+    }
+    uint64_t pfn = phys_addr >> PAGE_SHIFT;
+    if (pfn >= page_frame_count) {
+        return NULL;
+    }
+    return &page_frame_db[pfn];
+}
+
+uint64_t pmm_get_total_frame_count(void) {
+    return page_frame_count;
+}
+
+// Carve the page frame database out of the first usable region that can hold
+// it (avoiding the first PMM stack page) and initialize every descriptor to
+// PAGE_FRAME_RESERVED. Pages later pushed by pmm_free_page become FREE.
+static void init_page_frame_db(struct limine_memmap_response *memmap) {
+    // Highest usable physical address determines how many frames we track.
+    uint64_t highest_usable_end = 0;
+    for (size_t i = 0; i < memmap->entry_count; i++) {
+        struct limine_memmap_entry *e = memmap->entries[i];
+        if (e->type == LIMINE_MEMMAP_USABLE) {
+            uint64_t end = e->base + e->length;
+            if (end > highest_usable_end) {
+                highest_usable_end = end;
+            }
+        }
+    }
+    if (highest_usable_end == 0) {
+        return;
+    }
+
+    page_frame_count = highest_usable_end >> PAGE_SHIFT;
+    uint64_t db_bytes = page_frame_count * sizeof(page_frame_t);
+    page_frame_db_pages = ALIGN_UP_PMM(db_bytes, PAGE_SIZE) / PAGE_SIZE;
+
+    // Find a usable region big enough for the database. Skip past the first
+    // PMM stack page if the candidate range would overlap it.
+    for (size_t i = 0; i < memmap->entry_count; i++) {
+        struct limine_memmap_entry *e = memmap->entries[i];
+        if (e->type != LIMINE_MEMMAP_USABLE) {
+            continue;
+        }
+        uint64_t candidate = ALIGN_UP_PMM(e->base, PAGE_SIZE);
+        uint64_t candidate_end = candidate + page_frame_db_pages * PAGE_SIZE;
+        if (candidate <= pmm_first_stack_page_phys && pmm_first_stack_page_phys < candidate_end) {
+            candidate = pmm_first_stack_page_phys + PAGE_SIZE;
+            candidate_end = candidate + page_frame_db_pages * PAGE_SIZE;
+        }
+        if (candidate_end <= e->base + e->length) {
+            page_frame_db_phys = candidate;
+            break;
+        }
+    }
+
+    if (page_frame_db_phys == 0) {
+        print_serial(SERIAL_COM1_BASE, "PMM Error: No usable region large enough for page frame DB!\n");
+        page_frame_count = 0;
+        page_frame_db_pages = 0;
+        return;
+    }
+
+    page_frame_db = (page_frame_t *)(page_frame_db_phys + hhdm_offset);
+    for (uint64_t i = 0; i < page_frame_db_pages; i++) {
+        clear_page_pmm((uint8_t *)page_frame_db + i * PAGE_SIZE);
+    }
+
+    // Mark the PMM's own metadata pages so they are never pushed or freed.
+    for (uint64_t i = 0; i < page_frame_db_pages; i++) {
+        page_frame_db[(page_frame_db_phys >> PAGE_SHIFT) + i].state = PAGE_FRAME_PMM_STACK;
+    }
+    page_frame_db[pmm_first_stack_page_phys >> PAGE_SHIFT].state = PAGE_FRAME_PMM_STACK;
+
+    print_serial(SERIAL_COM1_BASE, "PMM: Page frame DB at P:0x");
+    print_serial_hex(SERIAL_COM1_BASE, page_frame_db_phys);
+    print_serial(SERIAL_COM1_BASE, ", frames: ");
+    print_serial_dec(SERIAL_COM1_BASE, page_frame_count);
+    print_serial(SERIAL_COM1_BASE, ", DB pages: ");
+    print_serial_dec(SERIAL_COM1_BASE, page_frame_db_pages);
+    print_serial(SERIAL_COM1_BASE, "\n");
+}
+
 static bool pmm_initialized = false;
 
 void init_pmm(struct limine_memmap_response *memmap) {
@@ -124,35 +291,34 @@ void init_pmm(struct limine_memmap_response *memmap) {
     print_serial(SERIAL_COM1_BASE, " (P:0x"); print_serial_hex(SERIAL_COM1_BASE, pmm_first_stack_page_phys); print_serial(SERIAL_COM1_BASE, ")\n");
     print_serial(SERIAL_COM1_BASE, "PMM: Stack entries per page: "); print_serial_dec(SERIAL_COM1_BASE, PMM_STACK_ENTRIES_PER_PAGE); print_serial(SERIAL_COM1_BASE, "\n");
 
+    /* --- 2.5. Build the page frame database (before populating the stack) --- */
+    init_page_frame_db(memmap);
+
     /* --- 3. Populate the free page stack (it will grow as needed) --- */
     print_serial(SERIAL_COM1_BASE, "PMM: Populating free page stack...\n");
     total_free_pages = 0; // Reset before populating
     print_serial(SERIAL_COM1_BASE, "PMM_DBG: Before populating loop: total_free_pages="); print_serial_dec(SERIAL_COM1_BASE, total_free_pages); print_serial(SERIAL_COM1_BASE, "\n"); // DBG
 
-    // Iterate through memory map entries to find usable memory
+    // Bulk-ingest each usable memmap entry. pmm_free_range fills stack pages
+    // with a tight inner loop and skips PMM metadata pages via the frame DB,
+    // which keeps boot time flat even on multi-GiB guests.
     for (uint64_t i = 0; i < memmap->entry_count; i++) {
         struct limine_memmap_entry *entry = memmap->entries[i];
         if (entry->type == LIMINE_MEMMAP_USABLE) {
-            // DBG_PMM(entry->base); // Optional
-            // DBG_PMM(entry->length); // Optional
-
-            uint64_t base = ALIGN_UP_PMM(entry->base, PAGE_SIZE);
-            uint64_t top = (entry->base + entry->length); // Iterate up to, but not exceeding, top
-
-            for (uint64_t p = base; (p + PAGE_SIZE) <= top; p += PAGE_SIZE) {
-                if (p == pmm_first_stack_page_phys) { // Don't add the first stack page itself to be managed initially
-                    print_serial(SERIAL_COM1_BASE, "PMM_DBG: Skipping first PMM stack page 0x"); // DBG
-                    print_serial_hex(SERIAL_COM1_BASE, p); // DBG
-                    print_serial(SERIAL_COM1_BASE, " from free list.\n"); // DBG
-                    continue;
+            // Fallback when the frame DB could not be built: free page-by-page
+            // so the first-stack-page check in pmm_free_page still applies.
+            if (pmm_page_frame(entry->base) == NULL) {
+                uint64_t base = ALIGN_UP_PMM(entry->base, PAGE_SIZE);
+                uint64_t top = (entry->base + entry->length);
+                for (uint64_t p = base; (p + PAGE_SIZE) <= top; p += PAGE_SIZE) {
+                    if (p == pmm_first_stack_page_phys) {
+                        continue;
+                    }
+                    pmm_free_page((void *)p);
                 }
-                // print_serial(SERIAL_COM1_BASE, "PMM_DBG: Calling pmm_free_page for P:0x"); print_serial_hex(SERIAL_COM1_BASE, p); print_serial(SERIAL_COM1_BASE, "\n"); // DBG
-                pmm_free_page((void *)p);
-                // print_serial(SERIAL_COM1_BASE, "PMM_DBG: After pmm_free_page for P:0x"); print_serial_hex(SERIAL_COM1_BASE, p); // DBG
-                // print_serial(SERIAL_COM1_BASE, ", current_stack_head V:0x"); print_serial_hex(SERIAL_COM1_BASE, (uint64_t)pmm_current_stack_head); // DBG
-                // print_serial(SERIAL_COM1_BASE, ", pmm_stack_top="); print_serial_dec(SERIAL_COM1_BASE, pmm_stack_top); // DBG
-                // print_serial(SERIAL_COM1_BASE, ", total_free_pages="); print_serial_dec(SERIAL_COM1_BASE, total_free_pages); print_serial(SERIAL_COM1_BASE, "\n"); // DBG
+                continue;
             }
+            pmm_free_range(entry->base, entry->length);
         }
     }
 
@@ -175,118 +341,195 @@ void init_pmm(struct limine_memmap_response *memmap) {
     pmm_initialized = true;
 }
 
-// Allocate a physical page
-void *pmm_alloc_page(void) {
+// Reclaim a retired (emptied) stack page into the free pool.
+// Caller must hold the global lock.
+static void pmm_reclaim_retired_stack_page(uint64_t phys_addr) {
+    page_frame_t *pf = pmm_page_frame(phys_addr);
+    if (pf == NULL) {
+        // Without the frame DB we cannot prove the page is safe to reuse; it stays lost.
+        return;
+    }
+    pf->state = PAGE_FRAME_ALLOCATED; // Transition so pmm_stack_push_page accepts it
+    pmm_stack_push_page((void *)phys_addr);
+}
+
+// Pop one page off the global free stack. Caller must hold the global lock.
+static void *pmm_stack_pop_page(void) {
     if (pmm_current_stack_head == NULL) {
-        print_serial(SERIAL_COM1_BASE, "PMM_DBG_ALLOC: pmm_current_stack_head is NULL, returning NULL\n"); // DBG
+        KLOG_DEBUG("PMM: pop with NULL stack head", 0); // DBG
         return NULL;
     }
 
-    if (pmm_stack_top == 0) { // Current stack page is empty
-        print_serial(SERIAL_COM1_BASE, "PMM_DBG_ALLOC: pmm_stack_top is 0. current_stack_head V:0x"); print_serial_hex(SERIAL_COM1_BASE, (uint64_t)pmm_current_stack_head); print_serial(SERIAL_COM1_BASE, "\n"); // DBG
-        struct pmm_stack_page *old_stack_page_virt = pmm_current_stack_head;
-        if (old_stack_page_virt->next == NULL) {
-            print_serial(SERIAL_COM1_BASE, "PMM Error: Out of memory! No more stack pages and current is empty.\n");
-            print_serial(SERIAL_COM1_BASE, "PMM_DBG_ALLOC: old_stack_page_virt->next is NULL. Returning NULL.\n"); // DBG
-            return NULL;
+    uint64_t retired_stack_page_phys = 0; // Retired (emptied) stack page to reclaim below
+
+    for (;;) {
+        if (pmm_stack_top == 0) { // Current stack page is empty
+            struct pmm_stack_page *old_stack_page_virt = pmm_current_stack_head;
+            if (old_stack_page_virt->next == NULL) {
+                KLOG_ERROR("PMM: Out of memory! Free stack exhausted, free pages:", total_free_pages);
+                return NULL;
+            }
+            pmm_current_stack_head = old_stack_page_virt->next;
+            pmm_stack_top = PMM_STACK_ENTRIES_PER_PAGE; // New page is full (top is index of last valid entry + 1 for pop)
+
+            // The old stack page is no longer needed as metadata. Since the frame DB
+            // tracks its state, we can safely hand it back to the free pool (after the
+            // pop below, so pmm_free_page pushes it onto a non-full stack page).
+            retired_stack_page_phys = (uint64_t)old_stack_page_virt - hhdm_offset;
+
+            KLOG_DEBUG("PMM: Switched to next stack page at V:", (uint64_t)pmm_current_stack_head);
         }
-        pmm_current_stack_head = old_stack_page_virt->next;
-        pmm_stack_top = PMM_STACK_ENTRIES_PER_PAGE; // New page is full (top is index of last valid entry + 1 for pop)
-        print_serial(SERIAL_COM1_BASE, "PMM_DBG_ALLOC: Switched to next stack page. New pmm_current_stack_head V:0x"); print_serial_hex(SERIAL_COM1_BASE, (uint64_t)pmm_current_stack_head); // DBG
-        print_serial(SERIAL_COM1_BASE, ", new pmm_stack_top="); print_serial_dec(SERIAL_COM1_BASE, pmm_stack_top); print_serial(SERIAL_COM1_BASE, "\n"); // DBG
-
-        // Optional: Free the physical page of old_stack_page_virt IF it's not the first one.
-        // This is tricky because pmm_free_page might try to allocate a new stack page.
-        // For now, let's not free old stack pages to avoid complexity. They remain "lost" to the PMM.
-        // uint64_t old_stack_page_phys = (uint64_t)old_stack_page_virt - hhdm_offset;
-        // if (old_stack_page_phys != pmm_first_stack_page_phys) {
-        //    print_serial(SERIAL_COM1_BASE, "PMM: Attempting to free old stack page P:0x"); print_serial_hex(SERIAL_COM1_BASE, old_stack_page_phys); print_serial(SERIAL_COM1_BASE, "\n");
-        //    pmm_free_page((void*)old_stack_page_phys); // Risky due to potential recursion / re-allocation
-        // }
-
-        print_serial(SERIAL_COM1_BASE, "PMM: Switched to next stack page at V:0x");
-        print_serial_hex(SERIAL_COM1_BASE, (uint64_t)pmm_current_stack_head);
-        print_serial(SERIAL_COM1_BASE, "\n");
+
+        // Pop an address from the current stack page
+        // pmm_stack_top is the count of items, so valid indices are 0 to pmm_stack_top-1
+        uint64_t phys_addr = pmm_current_stack_head->entries[--pmm_stack_top];
+        page_frame_t *pf = pmm_page_frame(phys_addr);
+
+        // Reclaim the retired stack page now that the stack has room again.
+        if (retired_stack_page_phys != 0) {
+            pmm_reclaim_retired_stack_page(retired_stack_page_phys);
+            retired_stack_page_phys = 0;
+        }
+
+        // Stale entry: the frame was claimed elsewhere (e.g. by pmm_alloc_pages)
+        // after it was pushed. The frame DB is authoritative, so just discard it.
+        if (pf != NULL && pf->state != PAGE_FRAME_FREE) {
+            continue;
+        }
+
+        total_free_pages--;
+        if (pf != NULL) {
+            pf->state = PAGE_FRAME_ALLOCATED;
+            pf->refcount = 1;
+        }
+
+        // DBG_PMM(phys_addr); // Debug allocated page
+        // DBG_PMM(total_free_pages); // Debug free pages count
+
+        return (void *)phys_addr;
     }
+}
 
-    // Pop an address from the current stack page
-    // pmm_stack_top is the count of items, so valid indices are 0 to pmm_stack_top-1
-    uint64_t phys_addr = pmm_current_stack_head->entries[--pmm_stack_top];
-    total_free_pages--;
+// --- Contiguous multi-page allocation ---
+// Scans the page frame database for a naturally aligned run of 2^order free
+// frames, claims it, and returns its physical base. The corresponding free
+// stack entries are invalidated lazily: pmm_alloc_page discards any popped
+// entry whose descriptor is no longer PAGE_FRAME_FREE.
+//
+// The scan steps in run-sized strides (so each frame is looked at once) and
+// resumes from where the last allocation succeeded. This is intended for
+// boot-time and infrequent allocations (task stacks, DMA buffers), not for
+// the hot single-page path.
+static uint64_t pmm_alloc_pages_scan_hint = 0;
+
+void *pmm_alloc_pages(uint64_t order) {
+    if (order == 0) {
+        return pmm_alloc_page(); // A single page is trivially aligned
+    }
+    if (page_frame_db == NULL) {
+        print_serial(SERIAL_COM1_BASE, "PMM Error: pmm_alloc_pages requires the page frame DB.\n");
+        return NULL;
+    }
 
-    // DBG_PMM(phys_addr); // Debug allocated page
-    // DBG_PMM(total_free_pages); // Debug free pages count
+    uint64_t run = 1ULL << order;
+    if (run > total_free_pages || run > page_frame_count) {
+        return NULL;
+    }
 
-    return (void *)phys_addr;
+    pmm_lock();
+
+    uint64_t start = pmm_alloc_pages_scan_hint & ~(run - 1);
+    // Two passes: hint..end, then 0..hint, both in run-aligned strides.
+    for (int pass = 0; pass < 2; pass++) {
+        uint64_t begin = (pass == 0) ? start : 0;
+        uint64_t limit = (pass == 0) ? page_frame_count : start;
+        for (uint64_t pfn = begin; pfn + run <= limit; pfn += run) {
+            uint64_t i;
+            for (i = 0; i < run; i++) {
+                if (page_frame_db[pfn + i].state != PAGE_FRAME_FREE) {
+                    break;
+                }
+            }
+            if (i < run) {
+                continue;
+            }
+            for (i = 0; i < run; i++) {
+                page_frame_db[pfn + i].state = PAGE_FRAME_ALLOCATED;
+                page_frame_db[pfn + i].refcount = 1;
+            }
+            total_free_pages -= run;
+            pmm_alloc_pages_scan_hint = pfn + run;
+            pmm_unlock();
+            return (void *)(pfn << PAGE_SHIFT);
+        }
+    }
+
+    pmm_unlock();
+
+    print_serial(SERIAL_COM1_BASE, "PMM: No contiguous run of order ");
+    print_serial_dec(SERIAL_COM1_BASE, order);
+    print_serial(SERIAL_COM1_BASE, " available.\n");
+    return NULL;
 }
 
-// Free a physical page
-void pmm_free_page(void *p_phys) {
+// Free a contiguous run previously returned by pmm_alloc_pages.
+void pmm_free_pages(void *p_phys, uint64_t order) {
+    uint64_t base = (uint64_t)p_phys;
+    uint64_t run = 1ULL << order;
+    for (uint64_t i = 0; i < run; i++) {
+        pmm_free_page((void *)(base + i * PAGE_SIZE));
+    }
+}
+
+// Push one page onto the global free stack. Caller must hold the global lock.
+static void pmm_stack_push_page(void *p_phys) {
     uint64_t phys_addr = (uint64_t)p_phys;
 
     // print_serial(SERIAL_COM1_BASE, "PMM_DBG_FREE: pmm_free_page(P:0x"); print_serial_hex(SERIAL_COM1_BASE, phys_addr); print_serial(SERIAL_COM1_BASE, ")\n"); // DBG
 
     if ((phys_addr % PAGE_SIZE) != 0) {
-        print_serial(SERIAL_COM1_BASE, "PMM Error: Attempt to free non-page-aligned address: 0x");
-        print_serial_hex(SERIAL_COM1_BASE, phys_addr);
-        print_serial(SERIAL_COM1_BASE, "\n");
+        KLOG_ERROR("PMM: Attempt to free non-page-aligned address:", phys_addr);
         // panic("PMM: Attempt to free non-page-aligned address.");
         return;
     }
 
     if (pmm_current_stack_head == NULL) {
          // This should only happen if called before init_pmm completes first page setup.
-        print_serial(SERIAL_COM1_BASE, "PMM_DBG_FREE: pmm_current_stack_head is NULL! (called for P:0x"); print_serial_hex(SERIAL_COM1_BASE, phys_addr); print_serial(SERIAL_COM1_BASE, ")\n"); // DBG
+        KLOG_DEBUG("PMM: free with NULL stack head, P:", phys_addr); // DBG
         return;
     }
 
-    // Check if the page being freed is already part of the stack chain (excluding the current head if it's the first page)
-    // This is a basic check to prevent obvious corruption. A more robust check would trace the whole list.
-    if (phys_addr != pmm_first_stack_page_phys) { // The first stack page has special handling
-        struct pmm_stack_page *check_ptr = pmm_current_stack_head->next;
-        while(check_ptr) {
-            if (((uint64_t)check_ptr - hhdm_offset) == phys_addr) {
-                print_serial(SERIAL_COM1_BASE, "PMM Warning: Attempt to free a page already in use as a PMM stack page (P:0x");
-                print_serial_hex(SERIAL_COM1_BASE, phys_addr);
-                print_serial(SERIAL_COM1_BASE, "). Skipping free to prevent corruption.\n");
-                return;
-            }
-            check_ptr = check_ptr->next;
+    // O(1) state check via the page frame database. This replaces the old
+    // walk over the whole stack-page chain on every free.
+    page_frame_t *pf = pmm_page_frame(phys_addr);
+    if (pf != NULL) {
+        if (pf->state == PAGE_FRAME_PMM_STACK) {
+            KLOG_WARN("PMM: Skipped free of live PMM stack page P:", phys_addr);
+            return;
         }
-    }
-
-
-    if (pmm_stack_top >= PMM_STACK_ENTRIES_PER_PAGE) { // Current stack page is full
-        print_serial(SERIAL_COM1_BASE, "PMM_DBG_FREE: Current stack page full. pmm_current_stack_head V:0x"); print_serial_hex(SERIAL_COM1_BASE, (uint64_t)pmm_current_stack_head); // DBG
-        print_serial(SERIAL_COM1_BASE, ", pmm_stack_top="); print_serial_dec(SERIAL_COM1_BASE, pmm_stack_top); // DBG
-        print_serial(SERIAL_COM1_BASE, ". Page to be freed P:0x"); print_serial_hex(SERIAL_COM1_BASE, phys_addr); print_serial(SERIAL_COM1_BASE, " will become new stack head.\n"); // DBG
-        // The page being freed (phys_addr) will become the new stack head.
-        if (phys_addr == pmm_first_stack_page_phys && pmm_current_stack_head == (struct pmm_stack_page *)(pmm_first_stack_page_phys + hhdm_offset)) {
-             // This case should ideally not be hit if pmm_first_stack_page_phys is never added to free list to begin with.
-             // If it is, and the first page is full, we try to make it its own new head - bad.
-            print_serial(SERIAL_COM1_BASE, "PMM_DBG_FREE: Attempting to use pmm_first_stack_page_phys as new head while it is current head. Problem!\n"); // DBG
+        if (pf->state == PAGE_FRAME_FREE) {
+            KLOG_WARN("PMM: Double free of page P:", phys_addr);
             return;
         }
-        // Also, if phys_addr is *any* active stack page, this is problematic.
-        // The check above handles pmm_current_stack_head->next and further, but not pmm_current_stack_head itself if it's not the first page.
+    }
 
+    if (pmm_stack_top >= PMM_STACK_ENTRIES_PER_PAGE) { // Current stack page is full
+        // The page being freed (phys_addr) becomes the new stack head. It is now
+        // PMM metadata, not a free page, so mark it as such and stop here instead
+        // of also pushing it as a free entry (which would let pmm_alloc_page hand
+        // out a live stack page).
         struct pmm_stack_page *new_stack_page_virt = (struct pmm_stack_page *)(phys_addr + hhdm_offset);
 
-        // Log before modifying list structure
-        // print_serial(SERIAL_COM1_BASE, "PMM: Current stack page full. Using freed page P:0x");
-        // print_serial_hex(SERIAL_COM1_BASE, phys_addr);
-        // print_serial(SERIAL_COM1_BASE, " as new stack head at V:0x");
-        // print_serial_hex(SERIAL_COM1_BASE, (uint64_t)new_stack_page_virt);
-        // print_serial(SERIAL_COM1_BASE, "\n");
-
         clear_page_pmm(new_stack_page_virt);
         new_stack_page_virt->next = pmm_current_stack_head;
         pmm_current_stack_head = new_stack_page_virt;
         pmm_stack_top = 0; // New page is empty, ready for the first entry.
-        print_serial(SERIAL_COM1_BASE, "PMM_DBG_FREE: New stack page created. New pmm_current_stack_head V:0x"); print_serial_hex(SERIAL_COM1_BASE, (uint64_t)pmm_current_stack_head); // DBG
-        print_serial(SERIAL_COM1_BASE, ", pmm_stack_top="); print_serial_dec(SERIAL_COM1_BASE, pmm_stack_top); print_serial(SERIAL_COM1_BASE, "\n"); // DBG
-        // The page phys_addr is now a stack page, so it doesn't increase total_free_pages yet.
-        // total_free_pages will be incremented when phys_addr is added to entries below.
+
+        if (pf != NULL) {
+            pf->state = PAGE_FRAME_PMM_STACK;
+            pf->refcount = 0;
+        }
+        return;
     }
 
     // Push the physical address onto the current stack page's entries
@@ -296,6 +539,10 @@ void pmm_free_page(void *p_phys) {
     // print_serial(SERIAL_COM1_BASE, " at index pmm_stack_top="); print_serial_dec(SERIAL_COM1_BASE, pmm_stack_top); print_serial(SERIAL_COM1_BASE, "\n"); // DBG
     pmm_current_stack_head->entries[pmm_stack_top++] = phys_addr;
     total_free_pages++;
+    if (pf != NULL) {
+        pf->state = PAGE_FRAME_FREE;
+        pf->refcount = 0;
+    }
     // print_serial(SERIAL_COM1_BASE, "PMM_DBG_FREE: After push. pmm_stack_top="); print_serial_dec(SERIAL_COM1_BASE, pmm_stack_top); // DBG
     // print_serial(SERIAL_COM1_BASE, ", total_free_pages="); print_serial_dec(SERIAL_COM1_BASE, total_free_pages); print_serial(SERIAL_COM1_BASE, "\n"); // DBG
 
@@ -303,9 +550,157 @@ void pmm_free_page(void *p_phys) {
     // DBG_PMM(total_free_pages); // Debug free pages count
 }
 
-// Get the number of free pages
+// Allocate a physical page.
+// Fast path: pop from this CPU's cache without touching the global lock.
+// Slow path: batch-refill the cache from the global stack.
+void *pmm_alloc_page(void) {
+    uint64_t prof_start = prof_begin();
+    // Interrupts off across the whole magazine operation (including the
+    // CPU-index read, so a timer preemption cannot migrate us onto another
+    // CPU's cache between the lookup and the update).
+    uint64_t flags = pmm_irq_save();
+    struct pmm_cpu_cache *cache = &pmm_cpu_caches[pmm_cpu_index()];
+
+    if (cache->count == 0) {
+        pmm_lock();
+        while (cache->count < PMM_CPU_CACHE_BATCH) {
+            void *page = pmm_stack_pop_page();
+            if (page == NULL) {
+                break;
+            }
+            cache->frames[cache->count++] = (uint64_t)page;
+        }
+        pmm_unlock();
+        if (cache->count == 0) {
+            pmm_irq_restore(flags);
+            prof_end(PROF_EVENT_PMM_ALLOC, prof_start);
+            return NULL; // Genuinely out of memory
+        }
+    }
+
+    void *page = (void *)cache->frames[--cache->count];
+    pmm_irq_restore(flags);
+    prof_end(PROF_EVENT_PMM_ALLOC, prof_start);
+    return page;
+}
+
+// Free a physical page.
+// Fast path: push onto this CPU's cache. When the cache is full, drain a
+// batch back to the global stack under the lock.
+void pmm_free_page(void *p_phys) {
+    uint64_t prof_start = prof_begin();
+    uint64_t phys_addr = (uint64_t)p_phys;
+
+    if ((phys_addr % PAGE_SIZE) != 0) {
+        print_serial(SERIAL_COM1_BASE, "PMM Error: Attempt to free non-page-aligned address: 0x");
+        print_serial_hex(SERIAL_COM1_BASE, phys_addr);
+        print_serial(SERIAL_COM1_BASE, "\n");
+        return;
+    }
+
+    if (pmm_current_stack_head == NULL) {
+        // Called before init_pmm completed first page setup.
+        print_serial(SERIAL_COM1_BASE, "PMM_DBG_FREE: pmm_current_stack_head is NULL! (called for P:0x"); print_serial_hex(SERIAL_COM1_BASE, phys_addr); print_serial(SERIAL_COM1_BASE, ")\n"); // DBG
+        return;
+    }
+
+    // O(1) sanity checks against the frame DB before caching the frame.
+    // Cached frames stay PAGE_FRAME_ALLOCATED until drained to the stack.
+    page_frame_t *pf = pmm_page_frame(phys_addr);
+    if (pf != NULL) {
+        if (pf->state == PAGE_FRAME_PMM_STACK) {
+            KLOG_WARN("PMM: Skipped free of live PMM stack page P:", phys_addr);
+            return;
+        }
+        if (pf->state == PAGE_FRAME_FREE) {
+            KLOG_WARN("PMM: Double free of page P:", phys_addr);
+            return;
+        }
+    }
+
+    // Interrupts off across the magazine operation; see pmm_alloc_page.
+    uint64_t flags = pmm_irq_save();
+    struct pmm_cpu_cache *cache = &pmm_cpu_caches[pmm_cpu_index()];
+
+    if (cache->count >= PMM_CPU_CACHE_CAPACITY) {
+        pmm_lock();
+        while (cache->count > PMM_CPU_CACHE_CAPACITY - PMM_CPU_CACHE_BATCH) {
+            pmm_stack_push_page((void *)cache->frames[--cache->count]);
+        }
+        pmm_unlock();
+    }
+
+    cache->frames[cache->count++] = phys_addr;
+    pmm_irq_restore(flags);
+    prof_end(PROF_EVENT_PMM_FREE, prof_start);
+}
+
+// Bulk-free a physical range onto the free stack.
+//
+// This is the fast path used by init_pmm to ingest whole memmap entries:
+// instead of one pmm_free_page call per 4KiB page (alignment check, state
+// check, possible stack growth each time), stack pages are filled with a
+// tight inner loop. When the current stack page fills up, the next page of
+// the range itself becomes the new stack head, exactly as in pmm_free_page.
+void pmm_free_range(uint64_t base, uint64_t length) {
+    if (pmm_current_stack_head == NULL) {
+        return;
+    }
+
+    pmm_lock();
+
+    uint64_t p = ALIGN_UP_PMM(base, PAGE_SIZE);
+    uint64_t end = base + length;
+
+    while (p + PAGE_SIZE <= end) {
+        page_frame_t *pf = pmm_page_frame(p);
+        if (pf != NULL && (pf->state == PAGE_FRAME_PMM_STACK || pf->state == PAGE_FRAME_FREE)) {
+            // PMM metadata (stack page / frame DB) or already free — skip.
+            p += PAGE_SIZE;
+            continue;
+        }
+
+        if (pmm_stack_top >= PMM_STACK_ENTRIES_PER_PAGE) {
+            // Current stack page is full: consume this page as the new head.
+            struct pmm_stack_page *new_head = (struct pmm_stack_page *)(p + hhdm_offset);
+            clear_page_pmm(new_head);
+            new_head->next = pmm_current_stack_head;
+            pmm_current_stack_head = new_head;
+            pmm_stack_top = 0;
+            if (pf != NULL) {
+                pf->state = PAGE_FRAME_PMM_STACK;
+            }
+            p += PAGE_SIZE;
+            continue;
+        }
+
+        // Tight inner loop: push pages until the stack page fills or the range ends.
+        while (pmm_stack_top < PMM_STACK_ENTRIES_PER_PAGE && p + PAGE_SIZE <= end) {
+            pf = pmm_page_frame(p);
+            if (pf != NULL) {
+                if (pf->state == PAGE_FRAME_PMM_STACK || pf->state == PAGE_FRAME_FREE) {
+                    p += PAGE_SIZE;
+                    continue;
+                }
+                pf->state = PAGE_FRAME_FREE;
+                pf->refcount = 0;
+            }
+            pmm_current_stack_head->entries[pmm_stack_top++] = p;
+            total_free_pages++;
+            p += PAGE_SIZE;
+        }
+    }
+
+    pmm_unlock();
+}
+
+// Get the number of free pages (global stack plus per-CPU caches)
 uint64_t pmm_get_free_page_count(void) {
-    return total_free_pages;
+    uint64_t count = total_free_pages;
+    for (uint32_t cpu = 0; cpu < PMM_MAX_CPUS; cpu++) {
+        count += pmm_cpu_caches[cpu].count;
+    }
+    return count;
 }
 
 // Returns the number of entries a single stack page can hold (excluding the 'next' pointer)
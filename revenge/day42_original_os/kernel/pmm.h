@@ -24,10 +24,41 @@ typedef struct {
 
 extern pmm_state_t pmm_info;
 
+// --- Page Frame Database ---
+// One descriptor per physical frame, indexed by PFN (phys >> PAGE_SHIFT).
+// Built during init_pmm so state checks (double free, stack-page reuse)
+// are a single array lookup instead of walking the stack-page chain.
+typedef enum {
+    PAGE_FRAME_RESERVED = 0, // Not managed by the PMM (kernel image, MMIO, holes)
+    PAGE_FRAME_FREE,         // On the free stack
+    PAGE_FRAME_ALLOCATED,    // Handed out by pmm_alloc_page
+    PAGE_FRAME_PMM_STACK     // In use as a PMM stack page (metadata, not allocatable)
+} page_frame_state_t;
+
+typedef struct {
+    uint8_t  state;    // page_frame_state_t
+    uint8_t  flags;    // Reserved for future use (e.g. dirty/zeroed tracking)
+    uint16_t refcount; // Reference count (for future shared mappings / CoW)
+} page_frame_t;
+
+// Returns the descriptor for a physical address, or NULL if the address is
+// outside the tracked range (or the database is not initialized yet).
+page_frame_t *pmm_page_frame(uint64_t phys_addr);
+uint64_t pmm_get_total_frame_count(void);
+
 // Function to initialize the physical memory manager
 void init_pmm(struct limine_memmap_response *memmap);
 void *pmm_alloc_page(void); // Returns a physical address
 void pmm_free_page(void *p);  // p is a physical address
+// Allocate 2^order physically contiguous, naturally aligned pages.
+// Returns the physical base address, or NULL if no such run exists.
+void *pmm_alloc_pages(uint64_t order);
+void pmm_free_pages(void *p, uint64_t order);
+// Bulk-free a physical range (e.g. a whole memmap entry) onto the free stack.
+// Much faster than calling pmm_free_page once per page during boot.
+void pmm_free_range(uint64_t base, uint64_t length);
 uint64_t pmm_get_free_page_count(void);
+// This CPU's free-page magazine, for the per-CPU data block (percpu.c).
+void *pmm_percpu_cache(uint32_t cpu);
 
 #endif // PMM_H
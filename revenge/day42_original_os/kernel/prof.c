@@ -0,0 +1,91 @@
+#include "prof.h"
+#include "apic.h"   // For SMP_MAX_CPUS and smp_current_cpu_index
+#include "serial.h"
+#include "main.h"   // For print_serial, print_serial_dec
+
+// Per-CPU event slots. The alignment keeps two CPUs' hot counters off the
+// same cache line; recording never touches another CPU's slot, so there is
+// nothing to lock.
+typedef struct prof_cpu_slots {
+    prof_counter_t ev[PROF_EVENT_COUNT];
+} __attribute__((aligned(64))) prof_cpu_slots_t;
+
+static prof_cpu_slots_t prof_cpus[SMP_MAX_CPUS];
+
+// Expose a CPU's slots to the per-CPU data block (percpu.c) without making
+// the array itself public.
+void *prof_percpu_slots(uint32_t cpu) {
+    return &prof_cpus[cpu % SMP_MAX_CPUS];
+}
+
+uint64_t prof_event_count(enum prof_event event) {
+    uint64_t total = 0;
+    for (uint32_t cpu = 0; cpu < SMP_MAX_CPUS; cpu++) {
+        total += prof_cpus[cpu].ev[event].count;
+    }
+    return total;
+}
+
+static const char *prof_event_names[PROF_EVENT_COUNT] = {
+    "schedule    ",
+    "ctx-switch  ",
+    "pmm-alloc   ",
+    "pmm-free    ",
+    "irq-dispatch",
+    "exception   ",
+    "page-fault  ",
+};
+
+void prof_end(enum prof_event event, uint64_t start_tsc) {
+    uint64_t cycles = prof_begin() - start_tsc;
+    prof_counter_t *c = &prof_cpus[smp_current_cpu_index()].ev[event];
+
+    c->count++;
+    c->total_cycles += cycles;
+    if (c->min_cycles == 0 || cycles < c->min_cycles) {
+        c->min_cycles = cycles;
+    }
+    if (cycles > c->max_cycles) {
+        c->max_cycles = cycles;
+    }
+}
+
+void prof_hit(enum prof_event event) {
+    prof_cpus[smp_current_cpu_index()].ev[event].count++;
+}
+
+void prof_reset(void) {
+    memset(prof_cpus, 0, sizeof(prof_cpus));
+}
+
+void prof_dump(void) {
+    print_serial(SERIAL_COM1_BASE, "--- Profiling counters (cycles) ---\n");
+    print_serial(SERIAL_COM1_BASE, "event         count        min      avg      max\n");
+
+    for (int e = 0; e < PROF_EVENT_COUNT; e++) {
+        // Aggregate across CPUs; min/max over all slots.
+        uint64_t count = 0, total = 0, min = 0, max = 0;
+        for (int cpu = 0; cpu < SMP_MAX_CPUS; cpu++) {
+            prof_counter_t *c = &prof_cpus[cpu].ev[e];
+            count += c->count;
+            total += c->total_cycles;
+            if (c->min_cycles != 0 && (min == 0 || c->min_cycles < min)) {
+                min = c->min_cycles;
+            }
+            if (c->max_cycles > max) {
+                max = c->max_cycles;
+            }
+        }
+
+        print_serial(SERIAL_COM1_BASE, prof_event_names[e]);
+        print_serial(SERIAL_COM1_BASE, "  ");
+        print_serial_dec(SERIAL_COM1_BASE, count);
+        print_serial(SERIAL_COM1_BASE, "  ");
+        print_serial_dec(SERIAL_COM1_BASE, min);
+        print_serial(SERIAL_COM1_BASE, "  ");
+        print_serial_dec(SERIAL_COM1_BASE, count != 0 ? total / count : 0);
+        print_serial(SERIAL_COM1_BASE, "  ");
+        print_serial_dec(SERIAL_COM1_BASE, max);
+        print_serial(SERIAL_COM1_BASE, "\n");
+    }
+}
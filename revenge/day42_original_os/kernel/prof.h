@@ -0,0 +1,64 @@
+#ifndef KERNEL_PROF_H
+#define KERNEL_PROF_H
+
+#include <stdint.h>
+
+// --- Cycle-accurate kernel profiling ---
+// rdtsc-based counters for the paths every optimization argument is about:
+// the scheduler, the PMM, IRQ dispatch and page faults. Each event keeps
+// count / total / min / max cycles in a per-CPU, cache-line-aligned slot,
+// so recording is two rdtscs and a handful of stores with no shared-line
+// bouncing. prof_dump() aggregates across CPUs and prints to serial.
+//
+// Usage:
+//   uint64_t t = prof_begin();
+//   ... work ...
+//   prof_end(PROF_EVENT_SCHEDULE, t);
+// or, for count-only events: prof_hit(PROF_EVENT_CTX_SWITCH);
+
+enum prof_event {
+    PROF_EVENT_SCHEDULE = 0, // schedule() body
+    PROF_EVENT_CTX_SWITCH,   // Actual task switches (count only)
+    PROF_EVENT_PMM_ALLOC,    // pmm_alloc_page()
+    PROF_EVENT_PMM_FREE,     // pmm_free_page()
+    PROF_EVENT_IRQ,          // irq_handler_c dispatch (all IRQs)
+    PROF_EVENT_EXCEPTION,    // isr_handler_c dispatch (vectors < 32)
+    PROF_EVENT_PAGE_FAULT,   // Demand-paging fault handling (#PF)
+    PROF_EVENT_COUNT
+};
+
+typedef struct prof_counter {
+    uint64_t count;
+    uint64_t total_cycles;
+    uint64_t min_cycles;
+    uint64_t max_cycles;
+} prof_counter_t;
+
+static inline uint64_t prof_begin(void) {
+    uint32_t lo, hi;
+    asm volatile ("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+// Close a measurement opened with prof_begin() and fold the elapsed cycles
+// into this CPU's slot for `event`.
+void prof_end(enum prof_event event, uint64_t start_tsc);
+
+// Record an occurrence of a count-only event (no cycle measurement).
+void prof_hit(enum prof_event event);
+
+// Print every event's count and min/avg/max cycles (aggregated over all
+// CPUs) to serial.
+void prof_dump(void);
+
+// Zero all counters, e.g. before a benchmark run.
+void prof_reset(void);
+
+// A CPU's event slots, for the per-CPU data block (percpu.c).
+void *prof_percpu_slots(uint32_t cpu);
+
+// Total occurrences of `event` summed over all CPUs (e.g. for benchmarks
+// that count context switches over a time window).
+uint64_t prof_event_count(enum prof_event event);
+
+#endif // KERNEL_PROF_H
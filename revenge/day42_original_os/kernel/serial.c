@@ -1,6 +1,8 @@
 #include "serial.h"
 #include "io.h" // For SERIAL_COM1_BASE and outb/inb
 #include "main.h" // Include for uint64_to_..._str prototypes
+#include "idt.h"  // For struct registers and register_irq_handler
+#include "apic.h" // For ioapic_route_gsi (COM1 TX interrupt routing)
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stddef.h> // For NULL and size_t
@@ -29,10 +31,119 @@ int is_transmit_empty(uint16_t port) {
    return inb(port + 5) & 0x20;
 }
 
+// --- Interrupt-driven transmit (COM1 only) ---
+// Until serial_enable_tx_irq() runs, write_serial_char busy-waits on the
+// THR-empty bit (~87us per character at 115200 baud). Afterwards it just
+// drops the byte into a software ring and returns; the UART's THR-empty
+// interrupt (IER bit 1, IRQ 4 -> vector 36) pulls bytes out of the ring
+// 16 at a time to refill the hardware FIFO.
+
+#define SERIAL_TX_RING_SIZE 4096 // Power of two (index math is a mask)
+#define SERIAL_TX_FIFO_DEPTH 16  // 16550A FIFO depth per THR-empty interrupt
+
+#define UART_REG_IER 1      // Interrupt Enable Register
+#define UART_IER_THR_EMPTY 0x02
+
+static char serial_tx_ring[SERIAL_TX_RING_SIZE];
+static volatile uint32_t serial_tx_head = 0; // Next free slot (producer)
+static volatile uint32_t serial_tx_tail = 0; // Next byte to send (ISR)
+static volatile int serial_tx_lock = 0;
+static volatile bool serial_tx_irq_enabled = false;
+
+// Save RFLAGS and disable interrupts. The ring lock is taken both from
+// ordinary code and from the IRQ 4 handler, so plain spinning would
+// self-deadlock if the ISR fired on the same CPU while the lock is held.
+static inline uint64_t serial_irq_save(void) {
+    uint64_t flags;
+    asm volatile ("pushfq; pop %0; cli" : "=r"(flags) :: "memory");
+    return flags;
+}
+
+static inline void serial_irq_restore(uint64_t flags) {
+    if (flags & (1ULL << 9)) { // IF was set
+        asm volatile ("sti");
+    }
+}
+
+static inline void serial_tx_ring_lock(void) {
+    while (__sync_lock_test_and_set(&serial_tx_lock, 1) != 0) {
+        asm volatile ("pause");
+    }
+}
+
+static inline void serial_tx_ring_unlock(void) {
+    __sync_lock_release(&serial_tx_lock);
+}
+
+// Refill the hardware FIFO from the ring. Caller holds the ring lock.
+// When the ring drains completely the THR-empty interrupt is switched off
+// so an idle UART does not fire a pointless interrupt per FIFO drain;
+// write_serial_char switches it back on when new data arrives.
+static void serial_tx_feed_fifo(uint16_t port) {
+    if ((inb(port + 5) & 0x20) == 0) {
+        return; // Transmitter still busy; the next THR-empty IRQ will call us
+    }
+    for (int i = 0; i < SERIAL_TX_FIFO_DEPTH && serial_tx_tail != serial_tx_head; i++) {
+        outb(port, serial_tx_ring[serial_tx_tail & (SERIAL_TX_RING_SIZE - 1)]);
+        serial_tx_tail++;
+    }
+    if (serial_tx_tail == serial_tx_head) {
+        outb(port + UART_REG_IER, inb(port + UART_REG_IER) & ~UART_IER_THR_EMPTY);
+    }
+}
+
+// IRQ 4 handler: the UART's transmit holding register went empty.
+static void serial_tx_irq_handler(struct registers *regs) {
+    (void)regs;
+    serial_tx_ring_lock();
+    serial_tx_feed_fifo(SERIAL_COM1_BASE);
+    serial_tx_ring_unlock();
+    // EOI is sent by the common IRQ dispatch path in idt.c.
+}
+
+// Switch COM1 transmission to interrupt-driven mode. Call once the IDT and
+// the I/O APIC are up (after init_apic); everything printed before this
+// still goes out through the polled path.
+void serial_enable_tx_irq(void) {
+    ioapic_route_gsi(4, 36); // COM1 is ISA IRQ 4, gated at vector 36 in idt.c
+    register_irq_handler(4, serial_tx_irq_handler);
+    serial_tx_irq_enabled = true;
+    print_serial(SERIAL_COM1_BASE, "Serial: COM1 TX switched to interrupt-driven mode.\n");
+}
+
 // Write character to serial port
 void write_serial_char(uint16_t port, char a) {
-   while (is_transmit_empty(port) == 0);
-   outb(port, a);
+   if (!serial_tx_irq_enabled || port != SERIAL_COM1_BASE) {
+       // Polled path: early boot, or a port without a TX ring.
+       while (is_transmit_empty(port) == 0);
+       outb(port, a);
+       return;
+   }
+
+   uint64_t flags = serial_irq_save();
+   serial_tx_ring_lock();
+
+   // Ring full: push bytes to the wire ourselves until a slot opens. This
+   // also makes progress when interrupts are off on this CPU, where waiting
+   // for the ISR would hang forever.
+   while (serial_tx_head - serial_tx_tail >= SERIAL_TX_RING_SIZE) {
+       while ((inb(port + 5) & 0x20) == 0) {
+           asm volatile ("pause");
+       }
+       serial_tx_feed_fifo(port);
+   }
+
+   serial_tx_ring[serial_tx_head & (SERIAL_TX_RING_SIZE - 1)] = a;
+   serial_tx_head++;
+
+   // Arm the THR-empty interrupt and, if the transmitter is already idle,
+   // kick the first bytes out directly -- the 16550 only interrupts on the
+   // busy->empty transition, which will not happen on an idle UART.
+   outb(port + UART_REG_IER, inb(port + UART_REG_IER) | UART_IER_THR_EMPTY);
+   serial_tx_feed_fifo(port);
+
+   serial_tx_ring_unlock();
+   serial_irq_restore(flags);
 }
 
 // Write string to serial port
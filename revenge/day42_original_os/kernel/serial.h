@@ -64,7 +64,13 @@ int init_serial(uint16_t port);
 // Check if the serial port's transmit buffer is empty.
 int is_transmit_empty(uint16_t port);
 
-// Write a single character to the specified serial port (blocking).
+// Write a single character to the specified serial port. Polled (blocking)
+// before serial_enable_tx_irq(); afterwards COM1 writes are queued into a
+// software ring drained by the THR-empty interrupt.
 void write_serial_char(uint16_t port, char a);
 
+// Switch COM1 transmission to interrupt-driven mode (IRQ 4 / vector 36).
+// Requires the IDT and the I/O APIC, so call after init_apic.
+void serial_enable_tx_irq(void);
+
 #endif // KERNEL_SERIAL_H
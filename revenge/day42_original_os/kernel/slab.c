@@ -0,0 +1,94 @@
+#include "slab.h"
+#include "pmm.h"
+#include "paging.h"
+#include "serial.h"
+#include "main.h" // For print_serial etc.
+
+// Same test-and-set spinlock pattern as the PMM and the run queues.
+static inline void slab_lock(slab_cache_t *cache) {
+    while (__sync_lock_test_and_set(&cache->lock, 1)) {
+        asm volatile("pause");
+    }
+}
+
+static inline void slab_unlock(slab_cache_t *cache) {
+    __sync_lock_release(&cache->lock);
+}
+
+void slab_cache_init(slab_cache_t *cache, const char *name, uint64_t obj_size, void (*ctor)(void *obj)) {
+    if (obj_size < SLAB_MIN_ALIGN) obj_size = SLAB_MIN_ALIGN;
+    obj_size = (obj_size + SLAB_MIN_ALIGN - 1) & ~(uint64_t)(SLAB_MIN_ALIGN - 1);
+
+    if (obj_size > PAGE_SIZE) {
+        print_serial(SERIAL_COM1_BASE, "slab_cache_init: Object larger than a page! Cache: ");
+        print_serial(SERIAL_COM1_BASE, name ? name : "?");
+        write_serial_char(SERIAL_COM1_BASE, '\n');
+        obj_size = PAGE_SIZE; // Degrades to one object per frame
+    }
+
+    cache->name = name;
+    cache->obj_size = obj_size;
+    cache->objs_per_page = PAGE_SIZE / obj_size;
+    cache->free_list = NULL;
+    cache->free_count = 0;
+    cache->total_count = 0;
+    cache->pages_grown = 0;
+    cache->ctor = ctor;
+    cache->lock = 0;
+
+    print_serial(SERIAL_COM1_BASE, "slab: Cache '");
+    print_serial(SERIAL_COM1_BASE, name ? name : "?");
+    print_serial_str_hex(SERIAL_COM1_BASE, "' initialized, obj_size=0x", obj_size);
+}
+
+// Take one frame from the PMM, map it at its HHDM address (the HHDM is not
+// blanket-mapped in this kernel; see create_task's old PCB path) and carve
+// it into objects pushed onto the freelist. Lock must be held.
+static int slab_grow(slab_cache_t *cache) {
+    uint64_t page_phys = (uint64_t)pmm_alloc_page();
+    if (page_phys == 0) {
+        return -1;
+    }
+    uint64_t page_virt = page_phys + hhdm_offset;
+    map_page(NULL, page_virt, page_phys, PTE_PRESENT | PTE_WRITABLE | PTE_NO_EXECUTE, "Slab Page");
+
+    for (uint64_t i = 0; i < cache->objs_per_page; i++) {
+        void *obj = (void *)(page_virt + i * cache->obj_size);
+        if (cache->ctor != NULL) {
+            cache->ctor(obj); // One-time construction; survives free/alloc cycles
+        }
+        *(void **)obj = cache->free_list; // Embed the freelist link in the object
+        cache->free_list = obj;
+    }
+    cache->free_count += cache->objs_per_page;
+    cache->total_count += cache->objs_per_page;
+    cache->pages_grown++;
+    return 0;
+}
+
+void *slab_alloc(slab_cache_t *cache) {
+    slab_lock(cache);
+    if (cache->free_list == NULL) {
+        if (slab_grow(cache) != 0) {
+            slab_unlock(cache);
+            print_serial(SERIAL_COM1_BASE, "slab_alloc: PMM exhausted growing cache '");
+            print_serial(SERIAL_COM1_BASE, cache->name ? cache->name : "?");
+            print_serial(SERIAL_COM1_BASE, "'\n");
+            return NULL;
+        }
+    }
+    void *obj = cache->free_list;
+    cache->free_list = *(void **)obj;
+    cache->free_count--;
+    slab_unlock(cache);
+    return obj;
+}
+
+void slab_free(slab_cache_t *cache, void *obj) {
+    if (obj == NULL) return;
+    slab_lock(cache);
+    *(void **)obj = cache->free_list;
+    cache->free_list = obj;
+    cache->free_count++;
+    slab_unlock(cache);
+}
@@ -0,0 +1,44 @@
+#ifndef KERNEL_SLAB_H
+#define KERNEL_SLAB_H
+
+#include <stdint.h>
+#include <stddef.h> // For NULL
+
+// --- Slab / Object Cache Allocator ---
+// Per-type caches of small kernel objects (task_t PCBs, IPC descriptors,
+// wait-queue nodes, ...). Whole 4KiB frames from the PMM are carved into
+// equal-size objects which recycle through a freelist, so a few-hundred-byte
+// PCB no longer burns a full frame and a map_page() call per allocation.
+//
+// If a constructor is supplied it runs ONCE per object when its backing
+// page is carved; freed objects keep their constructed state (freelist
+// linkage only clobbers the first 8 bytes), so re-allocation skips most of
+// the re-initialization cost.
+
+typedef struct slab_cache {
+    const char *name;       // For diagnostics ("task_t", ...)
+    uint64_t obj_size;      // Object size, rounded up to SLAB_MIN_ALIGN
+    uint64_t objs_per_page; // How many objects fit in one 4KiB frame
+    void *free_list;        // Next free object (next pointer embedded in the object)
+    uint64_t free_count;    // Objects currently on the freelist
+    uint64_t total_count;   // Objects ever carved (free + in use)
+    uint64_t pages_grown;   // Backing frames taken from the PMM
+    void (*ctor)(void *obj);// Optional one-time constructor, may be NULL
+    volatile int lock;      // Same test-and-set spinlock as the PMM/run queues
+} slab_cache_t;
+
+#define SLAB_MIN_ALIGN 16 // Objects are at least 16 bytes and 16-byte aligned
+
+// Set up a cache. obj_size may be any size up to PAGE_SIZE.
+void slab_cache_init(slab_cache_t *cache, const char *name, uint64_t obj_size, void (*ctor)(void *obj));
+
+// Allocate one object (HHDM virtual pointer). Grows the cache by one PMM
+// frame when the freelist is empty. Returns NULL if the PMM is exhausted.
+void *slab_alloc(slab_cache_t *cache);
+
+// Return an object to its cache's freelist. The backing frame is never
+// given back to the PMM (caches only grow); constructed state is preserved
+// except for the first 8 bytes.
+void slab_free(slab_cache_t *cache, void *obj);
+
+#endif // KERNEL_SLAB_H
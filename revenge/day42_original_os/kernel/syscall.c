@@ -0,0 +1,91 @@
+#include "syscall.h"
+#include "msr.h"
+#include "gdt.h"
+#include "apic.h"    // For smp_current_cpu_index
+#include "task.h"    // For current_task (SYS_GETPID)
+#include "kmalloc.h" // For the per-CPU syscall kernel stacks
+#include "percpu.h"  // The entry stub's stack slots live in the percpu block
+#include "serial.h"
+#include "main.h"    // For print_serial etc., panic
+
+#define SYSCALL_STACK_SIZE (4 * PAGE_SIZE) // 16 KiB per CPU
+
+// --- System call implementations ---
+
+static uint64_t sys_write(const char *buf, uint64_t len) {
+    // Byte-checked copy out to serial. No user address-space validation yet
+    // beyond a null check; user paging isolation is future work.
+    if (buf == NULL) return (uint64_t)-1;
+    for (uint64_t i = 0; i < len; i++) {
+        write_serial_char(SERIAL_COM1_BASE, buf[i]);
+    }
+    return len;
+}
+
+static uint64_t sys_getpid(void) {
+    return current_task != NULL ? current_task->pid : 0;
+}
+
+static uint64_t sys_yield(void) {
+    // Just a hint: return and let the next timer tick preempt. We cannot
+    // park here — SFMASK keeps IF clear for the whole handler, so a hlt
+    // would never be woken (the first yield used to hang the core), and
+    // even sti would be wrong: this frame lives on the shared per-CPU
+    // syscall stack (gs:[72]), which a reschedule mid-handler would let
+    // the next syscall on this CPU clobber. Preemption is only safe once
+    // sysretq has put the task back on its own user stack.
+    return 0;
+}
+
+uint64_t syscall_handler_c(uint64_t nr, uint64_t a1, uint64_t a2, uint64_t a3) {
+    (void)a3;
+    switch (nr) {
+        case SYS_WRITE:  return sys_write((const char *)a1, a2);
+        case SYS_GETPID: return sys_getpid();
+        case SYS_YIELD:  return sys_yield();
+        default:
+            print_serial_str_hex(SERIAL_COM1_BASE, "syscall: Unknown number 0x", nr);
+            return (uint64_t)-1;
+    }
+}
+
+void init_syscall(void) {
+    uint32_t cpu = smp_current_cpu_index();
+    percpu_t *p = percpu_get();
+
+    // Dedicated kernel stack for the syscall entry path on this CPU.
+    void *stack = kmalloc(SYSCALL_STACK_SIZE);
+    if (stack == NULL) {
+        panic("init_syscall: Failed to allocate syscall kernel stack!");
+    }
+    p->syscall_kernel_rsp = ((uint64_t)stack + SYSCALL_STACK_SIZE) & ~0xFULL;
+    p->syscall_user_rsp = 0;
+
+    // The entry stub reaches these slots via swapgs through KERNEL_GS_BASE,
+    // which init_percpu already points at this CPU's percpu block. Writing
+    // the MSR here again (as an earlier version did, at a private area)
+    // would desynchronize it from GS_BASE and break percpu_get() and the
+    // interrupt stubs' conditional swapgs on every ring-3 entry.
+
+    // STAR: [47:32] kernel CS base (syscall loads CS=base, SS=base+8),
+    //       [63:48] sysret base with RPL 3 (sysret loads SS=base+8, CS=base+16).
+    // With user data at 0x18 and user code at 0x20, base 0x13 yields
+    // SS=0x1B, CS=0x23 — exactly the GDT layout in gdt.c.
+    uint64_t star = ((uint64_t)0x08 << 32) |
+                    ((uint64_t)((GDT_ENTRY_USER_DATA * 8 - 8) | 3) << 48);
+    wrmsr(IA32_STAR_MSR, star);
+
+    // LSTAR: 64-bit syscall entry point.
+    wrmsr(IA32_LSTAR_MSR, (uint64_t)syscall_entry);
+
+    // SFMASK: RFLAGS bits cleared on entry. Mask IF (run the short entry
+    // path with interrupts off until we are on the kernel stack), plus
+    // TF/DF/AC for a well-defined environment.
+    wrmsr(IA32_FMASK_MSR, (1ULL << 9) | (1ULL << 8) | (1ULL << 10) | (1ULL << 18));
+
+    // Finally enable the instruction pair.
+    wrmsr(IA32_EFER_MSR, rdmsr(IA32_EFER_MSR) | EFER_SCE);
+
+    print_serial_str_hex(SERIAL_COM1_BASE, "syscall: Fast path armed on CPU ", cpu);
+    print_serial_str_hex(SERIAL_COM1_BASE, "  LSTAR = 0x", (uint64_t)syscall_entry);
+}
@@ -0,0 +1,45 @@
+#ifndef KERNEL_SYSCALL_H
+#define KERNEL_SYSCALL_H
+
+#include <stdint.h>
+
+// --- syscall/sysret fast system-call path ---
+// Avoids the int-gate IDT round trip (hundreds of cycles) for user-mode
+// services: STAR/LSTAR/SFMASK route `syscall` straight to syscall_entry
+// (syscall_entry.s), which swapgs-switches to a per-CPU kernel stack and
+// calls the C dispatcher below.
+//
+// Register convention (Linux-like): RAX = number, args in RDI/RSI/RDX,
+// return value in RAX. RCX/R11 are clobbered by the instruction pair.
+
+// System-call MSRs
+#define IA32_EFER_MSR   0xC0000080
+#define IA32_STAR_MSR   0xC0000081
+#define IA32_LSTAR_MSR  0xC0000082
+#define IA32_FMASK_MSR  0xC0000084
+
+#define EFER_SCE (1ULL << 0) // SYSCALL/SYSRET enable
+
+// System call numbers
+#define SYS_WRITE  0 // (const char *buf, uint64_t len) -> bytes written
+#define SYS_GETPID 1 // () -> pid of the current task
+#define SYS_YIELD  2 // () -> 0; give up the rest of the timeslice
+
+// The entry stub reaches its per-CPU stack slots through swapgs: they live
+// in the percpu_t block (syscall_kernel_rsp / syscall_user_rsp, percpu.h),
+// which KERNEL_GS_BASE already points at — init_percpu owns that MSR, and
+// the interrupt stubs' conditional swapgs and percpu_get() depend on it.
+
+// Program EFER.SCE, STAR, LSTAR and SFMASK for the calling CPU and allocate
+// its syscall kernel stack (stored in the per-CPU block). Call after
+// init_gdt (needs the user segments) and init_percpu (needs the block) on
+// every CPU that will run user code.
+void init_syscall(void);
+
+// C dispatcher, called from syscall_entry.s on the kernel stack.
+uint64_t syscall_handler_c(uint64_t nr, uint64_t a1, uint64_t a2, uint64_t a3);
+
+// Assembly entry point (syscall_entry.s)
+extern void syscall_entry(void);
+
+#endif // KERNEL_SYSCALL_H
@@ -0,0 +1,40 @@
+.intel_syntax noprefix
+.section .text
+
+.extern syscall_handler_c
+
+// syscall fast entry point (LSTAR target).
+//
+// On entry (from `syscall` in user mode):
+//   RCX = user RIP, R11 = user RFLAGS, RSP = still the USER stack,
+//   RAX = syscall number, args in RDI/RSI/RDX.
+//   Interrupts are off (IF is in SFMASK) until we are on the kernel stack.
+//
+// KERNEL_GS_BASE points at this CPU's percpu_t block (init_percpu owns the
+// MSR; the interrupt stubs' conditional swapgs relies on the same block):
+//   gs:72 = syscall kernel stack top, gs:80 = user RSP scratch
+//   (offsets are ABI, asserted in percpu.c).
+.global syscall_entry
+syscall_entry:
+    swapgs                        # GS now = this CPU's percpu block
+    mov qword ptr gs:[80], rsp    # Stash the user stack pointer
+    mov rsp, qword ptr gs:[72]    # Switch to this CPU's kernel stack
+
+    # Save what sysret needs and what the C ABI may clobber
+    push qword ptr gs:[80]        # User RSP
+    push rcx                      # User RIP
+    push r11                      # User RFLAGS
+
+    # Shuffle syscall args (RAX=nr, RDI/RSI/RDX=a1..a3) into the
+    # C ABI slots of syscall_handler_c(nr, a1, a2, a3)
+    mov rcx, rdx                  # a3
+    mov rdx, rsi                  # a2
+    mov rsi, rdi                  # a1
+    mov rdi, rax                  # nr
+    call syscall_handler_c        # Return value stays in RAX
+
+    pop r11                       # User RFLAGS
+    pop rcx                       # User RIP
+    pop rsp                       # Back onto the user stack
+    swapgs                        # Restore user GS
+    sysretq
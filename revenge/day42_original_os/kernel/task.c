@@ -5,15 +5,32 @@
 #include <stddef.h> // For NULL
 #include "pmm.h"    // For pmm_alloc_page
 #include "paging.h" // For hhdm_offset, PAGE_SIZE
+#include "slab.h"   // For the task_t PCB object cache
+#include "klog.h"   // Deferred logging; the idle task drains the ring
+#include "prof.h"   // Cycle counters for schedule()/context switches
 
 // Global ready queue (example)
 // static task_queue_t ready_queue;
 
-task_t *current_task = NULL; // ADD THIS LINE
-task_queue_t ready_queue; // ADD THIS LINE
+// current_task is now a %gs-relative slot in the per-CPU block (percpu.h).
+task_queue_t cpu_run_queues[SMP_MAX_CPUS]; // One run queue per CPU
+task_t *idle_tasks[SMP_MAX_CPUS]; // Per-CPU idle task, never enqueued
 static uint64_t next_pid = 1; // For assigning PIDs
 
-#define KERNEL_TASK_STACK_PAGES 1 // Number of pages for a task's kernel stack
+// Same test-and-set spinlock pattern as the PMM. Held only for the few
+// instructions of a ring-buffer operation, never across a context switch.
+static inline void run_queue_lock(task_queue_t *queue) {
+    while (__sync_lock_test_and_set(&queue->lock, 1)) {
+        asm volatile("pause");
+    }
+}
+
+static inline void run_queue_unlock(task_queue_t *queue) {
+    __sync_lock_release(&queue->lock);
+}
+
+#define KERNEL_TASK_STACK_ORDER 0 // Task kernel stack is 2^order pages
+#define KERNEL_TASK_STACK_PAGES (1 << KERNEL_TASK_STACK_ORDER) // Number of pages for a task's kernel stack
 
 // Simple string copy, ensure null termination
 static void strncpy_local(char *dest, const char *src, size_t n) {
@@ -26,50 +43,135 @@ static void strncpy_local(char *dest, const char *src, size_t n) {
 
 void init_task_queue(task_queue_t *queue) {
     if (!queue) return;
-    queue->head = 0;
-    queue->tail = 0;
-    queue->count = 0;
-    for (int i = 0; i < MAX_TASKS; i++) {
-        queue->tasks[i] = NULL;
+    for (int i = 0; i < TASK_PRIORITY_LEVELS; i++) {
+        queue->level_head[i] = NULL;
+        queue->level_tail[i] = NULL;
     }
+    queue->level_bitmap = 0;
+    queue->count = 0;
+    queue->lock = 0;
     // print_serial_str("Task queue initialized.\n");
 }
 
+void init_run_queues(void) {
+    for (int i = 0; i < SMP_MAX_CPUS; i++) {
+        init_task_queue(&cpu_run_queues[i]);
+        idle_tasks[i] = NULL;
+    }
+}
+
+// Body of every idle task: park the core until the next interrupt.
+// Interrupts are enabled in the task's RFLAGS, so the timer still ticks
+// and schedule() swaps real work in as soon as any appears.
+// (mwait is a future refinement; hlt alone already stops the core from
+// burning a full host CPU in a virtualized guest.)
+static void idle_task_main(void) {
+    while (1) {
+        // Nothing better to run, so spend the slack on draining the deferred
+        // log ring to the (slow) UART before parking the core.
+        klog_flush();
+        asm volatile ("hlt");
+    }
+}
+
+void init_idle_tasks(void) {
+    uint64_t cpus = smp_online_cpu_count();
+    if (cpus > SMP_MAX_CPUS) cpus = SMP_MAX_CPUS;
+
+    for (uint64_t i = 0; i < cpus; i++) {
+        char name[8] = {'i', 'd', 'l', 'e', (char)('0' + (i % 10)), '\0'};
+        task_t *idle = create_task(name, idle_task_main, get_current_cr3());
+        if (idle == NULL) {
+            panic("init_idle_tasks: Failed to create idle task!");
+        }
+        idle->priority = TASK_PRIORITY_LOWEST;
+        idle->affinity = (int)i; // Pinned: an idle task never migrates
+        idle->last_cpu = (uint32_t)i;
+        // Deliberately NOT enqueued: schedule() falls back to it directly.
+        idle_tasks[i] = idle;
+    }
+    print_serial(SERIAL_COM1_BASE, "Per-CPU idle tasks created.\n");
+}
+
+// Unlink `task` from the head of priority level `level` (lock held).
+static task_t *run_queue_pop_head(task_queue_t *queue, int level) {
+    task_t *task = queue->level_head[level];
+    queue->level_head[level] = task->next;
+    if (task->next != NULL) {
+        task->next->prev = NULL;
+    } else {
+        queue->level_tail[level] = NULL;
+        queue->level_bitmap &= ~(1U << level);
+    }
+    task->next = NULL;
+    task->prev = NULL;
+    queue->count--;
+    return task;
+}
+
 int enqueue_task(task_queue_t *queue, task_t *task) {
     if (!queue || !task) return -1; // Error: null queue or task
 
-    if (is_task_queue_full(queue)) {
-        // print_serial_str("Error: Task queue full! Cannot enqueue PID: ");
-        // print_serial_hex(task->pid);
-        // print_serial_char('\n');
-        return -2; // Error: queue full
-    }
+    int level = task->priority;
+    if (level >= TASK_PRIORITY_LEVELS) level = TASK_PRIORITY_LOWEST;
 
-    queue->tasks[queue->tail] = task;
-    queue->tail = (queue->tail + 1) % MAX_TASKS;
+    run_queue_lock(queue);
+    task->next = NULL;
+    task->prev = queue->level_tail[level];
+    if (queue->level_tail[level] != NULL) {
+        queue->level_tail[level]->next = task;
+    } else {
+        queue->level_head[level] = task;
+        queue->level_bitmap |= 1U << level;
+    }
+    queue->level_tail[level] = task;
     queue->count++;
-    // print_serial_str("Enqueued task PID: ");
-    // print_serial_hex(task->pid);
-    // print_serial_char('\n');
-    return 0; // Success
+    run_queue_unlock(queue);
+    return 0; // Success (capacity is bounded by memory, not a slot array)
 }
 
 task_t* dequeue_task(task_queue_t *queue) {
     if (!queue) return NULL;
 
-    if (is_task_queue_empty(queue)) {
-        // print_serial_str("Task queue empty! Cannot dequeue.\n");
+    run_queue_lock(queue);
+    if (queue->level_bitmap == 0) {
+        run_queue_unlock(queue);
         return NULL; // Queue empty
     }
 
-    task_t *task = queue->tasks[queue->head];
-    queue->tasks[queue->head] = NULL; // Optional: clear the slot
-    queue->head = (queue->head + 1) % MAX_TASKS;
+    // O(1) pick: find-first-set gives the highest-priority non-empty level.
+    int level = __builtin_ctz(queue->level_bitmap);
+    task_t *task = run_queue_pop_head(queue, level);
+    run_queue_unlock(queue);
+    return task;
+}
+
+// Pop from the lowest-priority non-empty level's tail. Used by work
+// stealing: the owning CPU consumes high-priority heads, so a thief taking
+// the opposite corner (batch work, least recently queued) minimizes both
+// contention and the chance of stealing something latency-sensitive.
+task_t* dequeue_task_tail(task_queue_t *queue) {
+    if (!queue) return NULL;
+
+    run_queue_lock(queue);
+    if (queue->level_bitmap == 0) {
+        run_queue_unlock(queue);
+        return NULL;
+    }
+
+    int level = 31 - __builtin_clz(queue->level_bitmap); // Highest set bit = lowest priority
+    task_t *task = queue->level_tail[level];
+    queue->level_tail[level] = task->prev;
+    if (task->prev != NULL) {
+        task->prev->next = NULL;
+    } else {
+        queue->level_head[level] = NULL;
+        queue->level_bitmap &= ~(1U << level);
+    }
+    task->next = NULL;
+    task->prev = NULL;
     queue->count--;
-    // print_serial_str("Dequeued task PID: ");
-    // if (task) print_serial_hex(task->pid);
-    // else print_serial_str("NULL_TASK");
-    // print_serial_char('\n');
+    run_queue_unlock(queue);
     return task;
 }
 
@@ -78,60 +180,149 @@ int is_task_queue_empty(task_queue_t *queue) {
     return queue->count == 0;
 }
 
-int is_task_queue_full(task_queue_t *queue) {
-    if (!queue) return 0; // Or handle as an error
-    return queue->count == MAX_TASKS;
+// Place a READY task on a run queue. Pinned tasks go to their CPU
+// unconditionally; unpinned tasks go to the shortest queue among the CPUs
+// we know about, preferring the task's last CPU on a tie (warm caches).
+int sched_enqueue(task_t *task) {
+    if (!task) return -1;
+
+    if (task->affinity != TASK_AFFINITY_ANY) {
+        uint32_t cpu = (uint32_t)task->affinity % SMP_MAX_CPUS;
+        int rc = enqueue_task(&cpu_run_queues[cpu], task);
+        if (rc == 0) lapic_tickless_kick(cpu); // Wake that core if dormant
+        return rc;
+    }
+
+    uint64_t cpus = smp_online_cpu_count();
+    if (cpus > SMP_MAX_CPUS) cpus = SMP_MAX_CPUS;
+
+    uint32_t best = task->last_cpu < cpus ? task->last_cpu : 0;
+    for (uint32_t i = 0; i < cpus; i++) {
+        if (cpu_run_queues[i].count < cpu_run_queues[best].count) {
+            best = i;
+        }
+    }
+    int rc = enqueue_task(&cpu_run_queues[best], task);
+    if (rc == 0) lapic_tickless_kick(best); // Wake that core if dormant
+    return rc;
 }
 
-// Example of a global ready queue, could be initialized in kernel_main
-// void init_global_ready_queue() {
-//     init_task_queue(&ready_queue);
-// }
+// Next runnable task for `cpu`. Fast path: own queue's head. Slow path
+// (own queue empty): steal from the tail of the busiest other queue.
+task_t *sched_pick_next(uint32_t cpu) {
+    task_t *task = dequeue_task(&cpu_run_queues[cpu]);
+    if (task != NULL) {
+        return task;
+    }
+
+    // Work stealing: find the busiest other queue.
+    uint64_t cpus = smp_online_cpu_count();
+    if (cpus > SMP_MAX_CPUS) cpus = SMP_MAX_CPUS;
 
-// task_t* get_next_ready_task() {
-//     return dequeue_task(&ready_queue);
-// }
+    uint32_t victim = cpu;
+    int victim_count = 0;
+    for (uint32_t i = 0; i < cpus; i++) {
+        if (i != cpu && cpu_run_queues[i].count > victim_count) {
+            victim = i;
+            victim_count = cpu_run_queues[i].count;
+        }
+    }
+    if (victim == cpu) {
+        return NULL; // Everyone is idle
+    }
 
-// void add_to_ready_queue(task_t* task) {
-//     enqueue_task(&ready_queue, task);
-// }
+    task = dequeue_task_tail(&cpu_run_queues[victim]);
+    if (task != NULL && task->affinity != TASK_AFFINITY_ANY && (uint32_t)task->affinity != cpu) {
+        // Stole a pinned task by accident; put it back where it belongs
+        // and give up this round rather than violating the pin.
+        enqueue_task(&cpu_run_queues[task->affinity % SMP_MAX_CPUS], task);
+        return NULL;
+    }
+    if (task != NULL) {
+        percpu_get()->sched_steals++;
+    }
+    return task;
+}
 
 void schedule(void) {
     // Temporarily disable interrupts during critical scheduler operations
     // This is a very basic approach; a more robust solution would involve specific lock types
     asm volatile ("cli");
 
+    uint64_t prof_start = prof_begin();
+    uint32_t cpu = smp_current_cpu_index();
     task_t *prev_task = current_task;
     task_t *next_task = NULL;
 
-    // If there was a running task, set its state to READY and add it back to the queue
-    if (prev_task != NULL) {
+    // If there was a running task, set its state to READY and add it back to the queue.
+    // The idle task is the exception: it lives outside the run queues entirely.
+    if (prev_task != NULL && prev_task != idle_tasks[cpu]) {
         if (prev_task->state == TASK_STATE_RUNNING) { // Only re-queue if it was running
             prev_task->state = TASK_STATE_READY;
-            if (enqueue_task(&ready_queue, prev_task) != 0) {
+            prev_task->last_cpu = cpu;
+            if (sched_enqueue(prev_task) != 0) {
                 // Failed to enqueue, potentially because queue is full.
                 // Handle this error appropriately, e.g. log, panic, or special handling.
                 // For now, we might lose the task or it remains current_task if next_task is NULL.
-                print_serial(SERIAL_COM1_BASE, "Schedule: Failed to re-enqueue task PID: ");
-                print_serial_hex(SERIAL_COM1_BASE, prev_task->pid);
-                write_serial_char(SERIAL_COM1_BASE, '\n');
+                KLOG_ERROR("Schedule: Failed to re-enqueue task PID:", prev_task->pid);
+            }
+        } else if (prev_task->state == TASK_STATE_READY) {
+            // A waker flipped WAITING -> READY while the task was still on
+            // this CPU (see task.h). Its context is saved now, so finish the
+            // wake by re-queueing it like an ordinary preemption.
+            prev_task->last_cpu = cpu;
+            if (sched_enqueue(prev_task) != 0) {
+                KLOG_ERROR("Schedule: Failed to re-enqueue woken task PID:", prev_task->pid);
+            }
+        } else if (prev_task->state == TASK_STATE_WAITING) {
+            // Context is saved; publish that the task is safe to wake by
+            // enqueue. If the CAS loses to a waker flipping us to READY,
+            // that waker did not enqueue (we were not PARKED yet), so the
+            // wake is ours to finish.
+            prev_task->last_cpu = cpu;
+            if (!__sync_bool_compare_and_swap(&prev_task->state,
+                                              TASK_STATE_WAITING,
+                                              TASK_STATE_PARKED)) {
+                if (sched_enqueue(prev_task) != 0) {
+                    KLOG_ERROR("Schedule: Failed to re-enqueue woken task PID:", prev_task->pid);
+                }
             }
         }
-        // If prev_task was not RUNNING (e.g. WAITING, TERMINATED), it shouldn't be auto-re-queued here.
-        // It should have been moved to a different list or handled by another mechanism.
+        // TERMINATED (and PARKED, which never belongs to a running CPU)
+        // tasks are not re-queued here.
     }
 
-    // Dequeue the next task
-    next_task = dequeue_task(&ready_queue);
+    // Pick the next task: local queue first, then steal
+    next_task = sched_pick_next(cpu);
+
+    // Nothing runnable anywhere: run this CPU's idle task so the core
+    // hlt-parks instead of leaving current_task NULL for the iretq path.
+    if (next_task == NULL && idle_tasks[cpu] != NULL) {
+        if (prev_task == idle_tasks[cpu]) {
+            // Already idling; nothing to change.
+            prof_end(PROF_EVENT_SCHEDULE, prof_start);
+            asm volatile ("sti");
+            return;
+        }
+        next_task = idle_tasks[cpu];
+        percpu_get()->sched_idle_entries++;
+    }
 
     if (next_task != NULL) {
+        if (prev_task != NULL && prev_task == idle_tasks[cpu]) {
+            prev_task->state = TASK_STATE_READY; // Real work arrived; park the idle task again
+        }
         current_task = next_task;
         current_task->state = TASK_STATE_RUNNING;
 
         // Restore essential context for the new task before iretq
         // For now, only RSP0 is critical for kernel->kernel switches if stacks differ,
         // or for future user->kernel transitions.
-        tss_set_rsp0(current_task->kernel_stack_top);
+        // The TSS is still a single BSP structure (no ltr on the APs, see
+        // smp_ap_entry); an AP writing it would clobber the BSP's RSP0.
+        if (cpu == 0) {
+            tss_set_rsp0(current_task->kernel_stack_top);
+        }
 
         // Future: load_cr3 if tasks have different address spaces
         // if (current_task->pml4_phys != 0 && get_current_cr3() != current_task->pml4_phys) {
@@ -146,14 +337,17 @@ void schedule(void) {
         current_task = prev_task;
         if(current_task->state != TASK_STATE_RUNNING) current_task->state = TASK_STATE_RUNNING; // Ensure it's marked running
     } else {
-        // No task to run and no previous task to continue (or it was terminated/successfully re-queued)
-        // This is where an idle task would run.
-        // For now, current_task might become NULL or remain the prev_task if re-queue failed.
+        // No task to run and no previous task to continue. Only reachable
+        // before init_idle_tasks() has run; afterwards the idle-task
+        // fallback above always supplies a next_task.
         current_task = NULL; // Explicitly set to NULL if no task is available
-        print_serial(SERIAL_COM1_BASE, "Schedule: No task to run, current_task is NULL.\n");
-        // TODO: Implement idle task or proper halt mechanism when no tasks are ready.
-        // For now, we might just re-enable interrupts and let the system hlt in the timer handler loop,
-        // or if current_task is NULL, the context switch part will be skipped.
+        KLOG_WARN("Schedule: No task to run, current_task is NULL. cpu:", cpu);
+    }
+
+    prof_end(PROF_EVENT_SCHEDULE, prof_start);
+    if (current_task != prev_task) {
+        prof_hit(PROF_EVENT_CTX_SWITCH);
+        percpu_get()->sched_switches++;
     }
 
     // Re-enable interrupts before returning or switching context
@@ -161,28 +355,26 @@ void schedule(void) {
     asm volatile ("sti");
 }
 
+// Object cache for task_t PCBs: sizeof(task_t) is a few hundred bytes, so a
+// dedicated frame (plus a map_page walk) per task wasted ~90% of the page.
+// The cache self-initializes on the first create_task call.
+static slab_cache_t task_cache;
+static int task_cache_initialized = 0;
+
 task_t *create_task(const char *name, task_entry_point_t entry_point, uint64_t pml4_phys_addr) {
-    // 1. Allocate memory for the task_t structure itself
-    uint64_t task_struct_phys = (uint64_t)pmm_alloc_page();
-    if (!task_struct_phys) {
-        print_serial(SERIAL_COM1_BASE, "create_task: Failed to allocate physical page for PCB\n");
+    // 1. Allocate the task_t structure from the PCB slab cache
+    if (!task_cache_initialized) {
+        slab_cache_init(&task_cache, "task_t", sizeof(task_t), NULL);
+        task_cache_initialized = 1;
+    }
+
+    task_t *task = (task_t *)slab_alloc(&task_cache);
+    if (!task) {
+        print_serial(SERIAL_COM1_BASE, "create_task: Failed to allocate PCB from slab cache\n");
         return NULL;
     }
-    uint64_t task_struct_virt = task_struct_phys + hhdm_offset;
-
-    // Map the PCB page into the current address space (kernel PML4)
-    extern pml4e_t *kernel_pml4_virt; // Ensure it's known
-    print_serial(SERIAL_COM1_BASE, "create_task: Calling map_page for PCB.\n");
-    print_serial_str_hex(SERIAL_COM1_BASE, "  kernel_pml4_virt: ", (uint64_t)kernel_pml4_virt);
-    print_serial_str_hex(SERIAL_COM1_BASE, "  task_struct_virt (to map): ", task_struct_virt);
-    print_serial_str_hex(SERIAL_COM1_BASE, "  task_struct_phys (to map): ", task_struct_phys);
-    map_page(kernel_pml4_virt, task_struct_virt, task_struct_phys, PTE_PRESENT | PTE_WRITABLE | PTE_NO_EXECUTE, "Task PCB");
-
-    print_serial(SERIAL_COM1_BASE, "create_task: PCB page allocated and mapped. Phys: 0x");
-    print_serial_hex(SERIAL_COM1_BASE, task_struct_phys);
-    print_serial(SERIAL_COM1_BASE, ", Virt: 0x");
-    print_serial_hex(SERIAL_COM1_BASE, task_struct_virt);
-    write_serial_char(SERIAL_COM1_BASE, '\n');
+
+    print_serial_str_hex(SERIAL_COM1_BASE, "create_task: PCB from slab cache at virt: 0x", (uint64_t)task);
 
     // Log the size of task_t
     char size_str[21];
@@ -191,14 +383,8 @@ task_t *create_task(const char *name, task_entry_point_t entry_point, uint64_t p
     print_serial(SERIAL_COM1_BASE, size_str);
     print_serial(SERIAL_COM1_BASE, " bytes\n");
 
-    task_t *task = (task_t *)task_struct_virt;
-
     // Zero out the task_t structure
-    print_serial(SERIAL_COM1_BASE, "create_task: About to memset task_t structure at virt: 0x");
-    print_serial_hex(SERIAL_COM1_BASE, (uint64_t)task);
-    print_serial(SERIAL_COM1_BASE, " for PAGE_SIZE bytes\n");
-    memset((void*)task, 0, PAGE_SIZE); // Zero out the entire page for the task struct
-    print_serial(SERIAL_COM1_BASE, "create_task: memset task_t structure completed.\n");
+    memset(task, 0, sizeof(task_t));
 
     // Initialize the task_t structure
     print_serial(SERIAL_COM1_BASE, "create_task: About to access task->pid\n");
@@ -210,23 +396,18 @@ task_t *create_task(const char *name, task_entry_point_t entry_point, uint64_t p
     }
     task->state = TASK_STATE_READY;
     task->has_run_once = 0; // false
-
-    // 3. Allocate kernel stack
-    uint64_t stack_phys_bottom = 0;
-    for (int i = 0; i < KERNEL_TASK_STACK_PAGES; ++i) { // Allocate contiguous pages if KERNEL_TASK_STACK_PAGES > 1
-        uint64_t page = (uint64_t)pmm_alloc_page();
-        if (!page) {
-            print_serial(SERIAL_COM1_BASE, "create_task: Failed to allocate kernel stack page for PID: ");
-            print_serial_hex(SERIAL_COM1_BASE, task->pid);
-            write_serial_char(SERIAL_COM1_BASE, '\n');
-            pmm_free_page(task); // Free the PCB page
-            return NULL;
-        }
-        if (i == 0) {
-            stack_phys_bottom = page;
-        }
-        // For KERNEL_TASK_STACK_PAGES > 1, ensure pages are contiguous or handle non-contiguous.
-        // For KERNEL_TASK_STACK_PAGES = 1, this loop runs once.
+    task->affinity = TASK_AFFINITY_ANY; // Not pinned (memset above left it 0 == CPU 0)
+    task->last_cpu = 0;
+    task->priority = TASK_PRIORITY_DEFAULT;
+
+    // 3. Allocate kernel stack as one physically contiguous, naturally aligned run
+    uint64_t stack_phys_bottom = (uint64_t)pmm_alloc_pages(KERNEL_TASK_STACK_ORDER);
+    if (!stack_phys_bottom) {
+        print_serial(SERIAL_COM1_BASE, "create_task: Failed to allocate kernel stack pages for PID: ");
+        print_serial_hex(SERIAL_COM1_BASE, task->pid);
+        write_serial_char(SERIAL_COM1_BASE, '\n');
+        slab_free(&task_cache, task); // Return the PCB to its cache
+        return NULL;
     }
 
     task->kernel_stack_bottom = stack_phys_bottom + hhdm_offset; // Virtual address of the bottom
@@ -4,12 +4,25 @@
 #include <stdint.h>
 #include "idt.h"    // For struct registers (which defines the GPR layout)
 #include "paging.h" // For CR3 related definitions if any, and for get_current_cr3()
+#include "apic.h"   // For SMP_MAX_CPUS (per-CPU run queues)
+#include "percpu.h" // current_task lives in the per-CPU block
 
 // Task states
+//
+// WAITING vs PARKED: a task announces a blocking wait by setting WAITING,
+// but its registers are still live on its CPU until the next interrupt
+// saves them. schedule() moves WAITING -> PARKED (CAS) once the context is
+// actually in task->context; only a PARKED task may be woken by enqueueing
+// it on a run queue. A waker that finds the task still WAITING flips it to
+// READY instead and the task's own CPU completes the wake (either the task
+// exits its spin, or its next tick re-enqueues it) — enqueueing earlier
+// would let another CPU iretq into a stale context while the first CPU is
+// still executing the task.
 typedef enum {
     TASK_STATE_READY,      // Ready to run
     TASK_STATE_RUNNING,    // Currently running
-    TASK_STATE_WAITING,    // Waiting for an event
+    TASK_STATE_WAITING,    // Announced a wait; context not yet saved
+    TASK_STATE_PARKED,     // Context saved, off the run queues; safe to wake
     TASK_STATE_TERMINATED  // Terminated, to be cleaned up
 } task_state_t;
 
@@ -72,6 +85,11 @@ typedef struct task {
     struct task *next;            // Pointer to the next task in the ready queue
     struct task *prev;            // Pointer to the previous task in the ready queue
 
+    int affinity;                 // Pinned CPU index, or TASK_AFFINITY_ANY
+    uint32_t last_cpu;            // CPU this task last ran on (cache-warmth hint)
+    uint8_t priority;             // 0 (highest) .. TASK_PRIORITY_LOWEST (batch)
+    void *fpu_state;              // XSAVE/FXSAVE area, allocated lazily on first #NM (NULL = never used FPU)
+
     // Add more fields as needed:
     // - priority
     // - execution_time_slices
@@ -83,25 +101,60 @@ typedef struct task {
     // - exit_code
 } task_t;
 
-#define MAX_TASKS 16 // Maximum number of tasks the queue can hold
-
-// Task Queue (simple ring buffer)
+#define TASK_AFFINITY_ANY (-1) // Task may run on (and be stolen by) any CPU
+
+// Priority levels: lower number = higher priority. Latency-sensitive work
+// (serial/console consumers) goes in the low levels and always preempts
+// batch work at the next scheduling point.
+#define TASK_PRIORITY_LEVELS  8
+#define TASK_PRIORITY_HIGHEST 0
+#define TASK_PRIORITY_DEFAULT 4
+#define TASK_PRIORITY_LOWEST  (TASK_PRIORITY_LEVELS - 1)
+
+// Multi-level priority run queue (one per CPU). One intrusive doubly-linked
+// FIFO per priority level (tasks themselves are the nodes via next/prev, so
+// capacity is bounded only by how many PCBs the PMM can hand out — no fixed
+// MAX_TASKS array and no per-node allocations) plus a bitmap of non-empty
+// levels so picking the best task is a single find-first-set.
 typedef struct task_queue {
-    task_t* tasks[MAX_TASKS];
-    int head;
-    int tail;
+    task_t *level_head[TASK_PRIORITY_LEVELS];
+    task_t *level_tail[TASK_PRIORITY_LEVELS];
+    uint32_t level_bitmap; // Bit p set <=> level p has at least one task
     int count;
+    volatile int lock; // Per-queue spinlock; cores only contend when stealing
 } task_queue_t;
 
-extern task_t *current_task;
-extern task_queue_t ready_queue;
+// The running task is per-CPU state: a single shared pointer breaks (and
+// false-shares) as soon as the APs schedule. Every existing use of the
+// `current_task` name resolves to this CPU's slot via %gs.
+#define current_task (percpu_get()->current)
+// One run queue per CPU. Each core schedules out of its own queue and only
+// touches another core's queue (tail end) when its own is empty.
+extern task_queue_t cpu_run_queues[SMP_MAX_CPUS];
 
 // Task queue operations
 void init_task_queue(task_queue_t *queue);
 int enqueue_task(task_queue_t *queue, task_t *task);
-task_t* dequeue_task(task_queue_t *queue);
+task_t* dequeue_task(task_queue_t *queue); // O(1): ffs over level_bitmap, pop that head
+task_t* dequeue_task_tail(task_queue_t *queue); // Steal side: lowest-priority level's tail
 int is_task_queue_empty(task_queue_t *queue);
-int is_task_queue_full(task_queue_t *queue);
+
+// Per-CPU idle tasks: one permanent task per CPU that just hlt-loops. It is
+// never enqueued on a run queue and is selected only when every queue is
+// empty, so an idle guest parks the core instead of spinning.
+extern task_t *idle_tasks[SMP_MAX_CPUS];
+
+// Per-CPU scheduling API
+void init_run_queues(void);
+// Create the per-CPU idle tasks (call once the PMM and paging are up,
+// after init_run_queues and SMP bring-up).
+void init_idle_tasks(void);
+// Place a READY task on a run queue: its pinned CPU if affinity is set,
+// otherwise the shortest queue (preferring last_cpu on a tie).
+int sched_enqueue(task_t *task);
+// Next task for `cpu`: local queue head, else steal from the busiest
+// other queue's tail. NULL if every queue is empty.
+task_t *sched_pick_next(uint32_t cpu);
 
 // Scheduler function
 void schedule(void);
@@ -0,0 +1,150 @@
+#include "vmm.h"
+#include "pmm.h"
+#include "paging.h"
+#include "serial.h"
+#include "main.h"   // For hcf
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef ALIGN_DOWN
+#define ALIGN_DOWN(addr, align) ((addr) & ~((align) - 1))
+#endif
+
+// One lazily-backed virtual region. `flags` are the PTE flags used when a
+// page of the region is fully populated (writable private frame).
+typedef struct {
+    uint64_t start; // Inclusive, page-aligned
+    uint64_t end;   // Exclusive, page-aligned
+    uint64_t flags; // PTE flags for populated pages (PTE_PRESENT implied)
+    int      used;
+} vmm_lazy_region_t;
+
+static vmm_lazy_region_t lazy_regions[VMM_MAX_LAZY_REGIONS];
+
+// The shared pre-zeroed frame. Read faults in lazy regions map this page
+// read-only; the first write triggers a CoW fault and gets a private frame.
+static uint64_t zero_page_phys = 0;
+
+// Fault statistics, handy when eyeballing serial logs.
+static uint64_t vmm_faults_zero_mapped = 0;  // Read faults -> shared zero page
+static uint64_t vmm_faults_populated = 0;    // Write faults -> fresh private frame
+static uint64_t vmm_faults_cow = 0;          // CoW breaks of the zero page
+
+// Zero a frame through its HHDM alias.
+static void vmm_zero_frame(uint64_t phys)
+{
+    zero_page((void *)(phys + hhdm_offset));
+}
+
+static vmm_lazy_region_t *vmm_find_region(uint64_t addr)
+{
+    for (int i = 0; i < VMM_MAX_LAZY_REGIONS; i++) {
+        if (lazy_regions[i].used && addr >= lazy_regions[i].start && addr < lazy_regions[i].end) {
+            return &lazy_regions[i];
+        }
+    }
+    return NULL;
+}
+
+void init_vmm(void)
+{
+    for (int i = 0; i < VMM_MAX_LAZY_REGIONS; i++) {
+        lazy_regions[i].used = 0;
+    }
+
+    zero_page_phys = (uint64_t)pmm_alloc_page();
+    if (zero_page_phys == 0) {
+        print_serial(SERIAL_COM1_BASE, "init_vmm: Failed to allocate the shared zero page! Halting.\n");
+        hcf();
+    }
+    vmm_zero_frame(zero_page_phys);
+
+    print_serial_str_hex(SERIAL_COM1_BASE, "init_vmm: Shared zero page at phys 0x", zero_page_phys);
+
+    // Reserve the kernel lazy heap. Costs zero frames until touched.
+    if (vmm_register_lazy_region(VMM_KERNEL_LAZY_HEAP_BASE, VMM_KERNEL_LAZY_HEAP_SIZE,
+                                 PTE_WRITABLE | PTE_NO_EXECUTE) != 0) {
+        print_serial(SERIAL_COM1_BASE, "init_vmm: Failed to register kernel lazy heap region!\n");
+    } else {
+        print_serial_str_hex(SERIAL_COM1_BASE, "init_vmm: Kernel lazy heap registered at 0x", VMM_KERNEL_LAZY_HEAP_BASE);
+    }
+}
+
+int vmm_register_lazy_region(uint64_t start, uint64_t size, uint64_t flags)
+{
+    if ((start & (PAGE_SIZE - 1)) || (size & (PAGE_SIZE - 1)) || size == 0) {
+        print_serial_str_hex(SERIAL_COM1_BASE, "vmm_register_lazy_region: Unaligned region rejected, start=0x", start);
+        return -1;
+    }
+
+    for (int i = 0; i < VMM_MAX_LAZY_REGIONS; i++) {
+        if (!lazy_regions[i].used) {
+            lazy_regions[i].start = start;
+            lazy_regions[i].end = start + size;
+            lazy_regions[i].flags = flags | PTE_PRESENT;
+            lazy_regions[i].used = 1;
+            return 0;
+        }
+    }
+
+    print_serial(SERIAL_COM1_BASE, "vmm_register_lazy_region: Region table full!\n");
+    return -1;
+}
+
+int vmm_handle_page_fault(uint64_t fault_addr, uint64_t err_code)
+{
+    vmm_lazy_region_t *region = vmm_find_region(fault_addr);
+    if (region == NULL) {
+        return -1; // Not ours; the caller reports and halts.
+    }
+
+    uint64_t page_virt = ALIGN_DOWN(fault_addr, PAGE_SIZE);
+
+    if (!(err_code & PF_ERR_PRESENT)) {
+        // First touch of a lazy page.
+        if (err_code & PF_ERR_WRITE) {
+            // A write is about to happen anyway: skip the zero-page detour
+            // and hand out a private zeroed frame immediately.
+            uint64_t frame = (uint64_t)pmm_alloc_page();
+            if (frame == 0) {
+                print_serial(SERIAL_COM1_BASE, "vmm: Out of memory populating lazy page! Halting.\n");
+                hcf();
+            }
+            vmm_zero_frame(frame);
+            map_page(NULL, page_virt, frame, region->flags, "demand-zero");
+            vmm_faults_populated++;
+        } else {
+            // Read fault: share the global zero page, mapped read-only so
+            // the first write CoW-faults back into this handler.
+            map_page(NULL, page_virt, zero_page_phys,
+                     region->flags & ~(uint64_t)PTE_WRITABLE, "zero-page(ro)");
+            page_frame_t *zp = pmm_page_frame(zero_page_phys);
+            if (zp) zp->refcount++;
+            vmm_faults_zero_mapped++;
+        }
+        return 0;
+    }
+
+    // Present + write: copy-on-write break if the page is the shared zero
+    // page (mapped read-only above). Anything else is a real protection
+    // fault and must not be swallowed.
+    if (err_code & PF_ERR_WRITE) {
+        pte_t *pte = paging_find_pte(NULL, page_virt);
+        if (pte != NULL && (*pte & PTE_ADDR_MASK) == zero_page_phys) {
+            uint64_t frame = (uint64_t)pmm_alloc_page();
+            if (frame == 0) {
+                print_serial(SERIAL_COM1_BASE, "vmm: Out of memory breaking CoW! Halting.\n");
+                hcf();
+            }
+            vmm_zero_frame(frame); // Zero page contents are all zeroes, so a fresh zeroed frame IS the copy.
+            *pte = (frame & PTE_ADDR_MASK_4KB) | region->flags;
+            invlpg((void *)page_virt);
+            page_frame_t *zp = pmm_page_frame(zero_page_phys);
+            if (zp && zp->refcount > 0) zp->refcount--;
+            vmm_faults_cow++;
+            return 0;
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,46 @@
+#ifndef KERNEL_VMM_H
+#define KERNEL_VMM_H
+
+#include <stdint.h>
+#include <stddef.h> // For NULL
+
+// --- Demand Paging (Virtual Memory Manager) ---
+// Regions registered here are backed lazily: no frames are allocated up
+// front. The first access page-faults, and page_fault_c_handler routes the
+// fault to vmm_handle_page_fault() which allocates/zeros a frame, maps it
+// and resumes the faulting instruction.
+//
+// Reads are satisfied by one shared pre-zeroed page mapped read-only; the
+// first write then copy-on-write faults and gets a private zeroed frame.
+
+// Page fault error code bits (pushed by the CPU for vector 14)
+#define PF_ERR_PRESENT (1ULL << 0) // 0 = not-present fault, 1 = protection fault
+#define PF_ERR_WRITE   (1ULL << 1) // 1 = faulting access was a write
+#define PF_ERR_USER    (1ULL << 2) // 1 = fault originated in user mode
+#define PF_ERR_RSVD    (1ULL << 3) // Reserved bit set in a paging entry
+#define PF_ERR_IFETCH  (1ULL << 4) // Instruction fetch
+
+#define VMM_MAX_LAZY_REGIONS 16
+
+// Kernel lazy heap: reserved virtual range with demand-paged zero backing.
+// Nothing is allocated until something touches it (kmalloc will carve from
+// this range later).
+#define VMM_KERNEL_LAZY_HEAP_BASE 0xFFFFA00000000000ULL
+#define VMM_KERNEL_LAZY_HEAP_SIZE (16ULL * 1024 * 1024) // 16 MiB
+
+// Initialize the VMM: allocates the shared zero page and registers the
+// kernel lazy heap region. Call after init_pmm and init_paging.
+void init_vmm(void);
+
+// Register [start, start + size) as a lazily-backed region. `flags` are the
+// PTE flags a fully-populated page in the region gets (PTE_PRESENT is
+// implied; pass PTE_WRITABLE etc.). Returns 0 on success, -1 if the region
+// table is full or the range is not page-aligned.
+int vmm_register_lazy_region(uint64_t start, uint64_t size, uint64_t flags);
+
+// Try to service a page fault at fault_addr (CR2) with error code err_code.
+// Returns 0 if the fault was handled and the instruction can be resumed,
+// -1 if the address is not in any lazy region (a real fault).
+int vmm_handle_page_fault(uint64_t fault_addr, uint64_t err_code);
+
+#endif // KERNEL_VMM_H
@@ -0,0 +1,41 @@
+#!/bin/sh
+# Boot a BENCH_BUILD image headless in QEMU and capture the in-kernel
+# microbenchmark results (kernel/bench.c) from the serial port.
+#
+# Usage: run_bench.sh <os.iso> <results-file>
+#
+# The kernel prints one BENCH|name|iters=N|cycles=N|cyc_per_op=N line per
+# benchmark, then BENCH|done, then exits QEMU via isa-debug-exit. The full
+# serial log is kept next to the results file for debugging; the results
+# file itself holds only the BENCH| lines, ready for diffing across kernel
+# drops.
+
+set -eu
+
+ISO="${1:?usage: run_bench.sh <os.iso> <results-file>}"
+RESULTS="${2:?usage: run_bench.sh <os.iso> <results-file>}"
+SERIAL_LOG="${RESULTS}.serial.log"
+TIMEOUT_SECS=120
+
+# isa-debug-exit makes QEMU exit with a nonzero status ((v << 1) | 1) by
+# design, so the exit code alone cannot signal failure; presence of the
+# BENCH|done marker is the success criterion.
+timeout "${TIMEOUT_SECS}" qemu-system-x86_64 \
+    -machine pc -m 256M -cpu SandyBridge,+x2apic \
+    -display none -no-reboot \
+    -device isa-debug-exit,iobase=0xf4,iosize=0x04 \
+    -serial "file:${SERIAL_LOG}" \
+    -cdrom "${ISO}" || true
+
+grep '^BENCH|' "${SERIAL_LOG}" > "${RESULTS}" || {
+    echo "run_bench.sh: no BENCH lines captured (see ${SERIAL_LOG})" >&2
+    exit 1
+}
+
+if ! grep -q '^BENCH|done' "${RESULTS}"; then
+    echo "run_bench.sh: benchmark run incomplete (no BENCH|done marker, see ${SERIAL_LOG})" >&2
+    exit 1
+fi
+
+echo "run_bench.sh: results written to ${RESULTS}:"
+cat "${RESULTS}"